@@ -0,0 +1,146 @@
+#ifndef TOTR_ARM7TDMI_DECODER_H
+#define TOTR_ARM7TDMI_DECODER_H
+
+/*
+C interface to the decoder library, built as the shared library arm7tdmi_decoder
+(libarm7tdmi_decoder.so / .dylib, arm7tdmi_decoder.dll). Everything crosses the boundary as
+opaque handles, plain integers and caller-provided buffers: a batch call fills an array of
+totr_instruction records and, optionally, a text buffer with fixed-size rows, so a binding pays
+one call per batch instead of one per instruction and never frees memory it did not allocate.
+
+No function throws or aborts on bad input; failures return NULL or 0. Handles may be used from
+several threads at once as long as nothing calls totr_image_set_override / _clear_override on the
+same image concurrently.
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#  if defined(TOTR_BUILDING_C_API)
+#    define TOTR_API __declspec(dllexport)
+#  else
+#    define TOTR_API __declspec(dllimport)
+#  endif
+#else
+#  define TOTR_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Bumped whenever a struct layout or a function signature changes. */
+#define TOTR_API_VERSION 1
+
+/* Rows of a text buffer of at least this many bytes are never truncated. */
+#define TOTR_TEXT_SIZE 80
+
+/* Options for totr_decoder_create / totr_image_open. */
+#define TOTR_OPTION_DECIMAL    (1u << 0) /* Immediates in decimal instead of hex */
+#define TOTR_OPTION_BIG_ENDIAN (1u << 1) /* Image bytes are big-endian */
+#define TOTR_OPTION_NO_TRACK   (1u << 2) /* Images: resolve BX mode switches with the probe only */
+
+#define TOTR_MODE_ARM   0
+#define TOTR_MODE_THUMB 1
+
+/* totr_instruction.flags, as DecodeFlag in DecodedFields.hpp. */
+#define TOTR_FLAG_VALID            (1u << 0)
+#define TOTR_FLAG_SET_FLAGS        (1u << 1)
+#define TOTR_FLAG_IMMEDIATE        (1u << 2)
+#define TOTR_FLAG_LOAD             (1u << 3)
+#define TOTR_FLAG_PRE_INDEX        (1u << 4)
+#define TOTR_FLAG_ADD_OFFSET       (1u << 5)
+#define TOTR_FLAG_WRITE_BACK       (1u << 6)
+#define TOTR_FLAG_BYTE             (1u << 7)
+#define TOTR_FLAG_LINK             (1u << 8)
+#define TOTR_FLAG_BRANCH_EXCHANGE  (1u << 9)
+#define TOTR_FLAG_EXCEPTION_RETURN (1u << 10)
+#define TOTR_FLAG_HAS_TARGET       (1u << 11)
+#define TOTR_FLAG_WIDE             (1u << 12)
+
+/* totr_instruction.format, in the order of InstrFormat in Common.hpp. */
+enum totr_format {
+	TOTR_FORMAT_INVALID,
+	TOTR_FORMAT_ARM_BRANCH_EXCHANGE, TOTR_FORMAT_ARM_BRANCH, TOTR_FORMAT_ARM_DATA_PROC, TOTR_FORMAT_ARM_PSR_MRS,
+	TOTR_FORMAT_ARM_PSR_MSR_REG, TOTR_FORMAT_ARM_PSR_MSR_IMM, TOTR_FORMAT_ARM_MUL, TOTR_FORMAT_ARM_MUL_LONG,
+	TOTR_FORMAT_ARM_SINGLE_DATA_TRANS, TOTR_FORMAT_ARM_HALFWORD_TRANS_REG, TOTR_FORMAT_ARM_HALFWORD_TRANS_IMM,
+	TOTR_FORMAT_ARM_BLOCK_DATA_TRANS, TOTR_FORMAT_ARM_SINGLE_DATA_SWAP, TOTR_FORMAT_ARM_SWI, TOTR_FORMAT_ARM_UNDEFINED,
+	TOTR_FORMAT_ARM_COPROC_DATA_TRANS, TOTR_FORMAT_ARM_COPROC_DATA_OP, TOTR_FORMAT_ARM_COPROC_REG_TRANS,
+	TOTR_FORMAT_THUMB_MOVE_SHIFTED_REG, TOTR_FORMAT_THUMB_ADD_SUB, TOTR_FORMAT_THUMB_MOV_CMP_ADD_SUB_IMM,
+	TOTR_FORMAT_THUMB_ALU_OPS, TOTR_FORMAT_THUMB_HI_REG_OPS_BX, TOTR_FORMAT_THUMB_PC_REL_LOAD,
+	TOTR_FORMAT_THUMB_LOAD_STORE_REG_OFF, TOTR_FORMAT_THUMB_LOAD_STORE_SIGN_EXT, TOTR_FORMAT_THUMB_LOAD_STORE_IMM_OFF,
+	TOTR_FORMAT_THUMB_LOAD_STORE_HALFWORD, TOTR_FORMAT_THUMB_SP_REL_LOAD_STORE, TOTR_FORMAT_THUMB_LOAD_ADDRESS,
+	TOTR_FORMAT_THUMB_ADD_OFF_TO_SP, TOTR_FORMAT_THUMB_PUSH_POP_REG, TOTR_FORMAT_THUMB_MULTI_LOAD_STORE,
+	TOTR_FORMAT_THUMB_COND_BRANCH, TOTR_FORMAT_THUMB_SWI, TOTR_FORMAT_THUMB_UNCOND_BRANCH,
+	TOTR_FORMAT_THUMB_LONG_BRANCH_LINK,
+	TOTR_FORMAT_COUNT
+};
+
+/*
+One decoded instruction; the operand columns are DecodedFields (see DecodedFields.hpp), unused
+registers hold 0xFF. `encoding` is the ARM word, the THUMB halfword, or for a BL pair the prefix
+in bits 15-0 and the suffix in bits 31-16.
+*/
+typedef struct totr_instruction {
+	uint32_t address;
+	uint32_t encoding;
+	uint32_t imm;
+	uint16_t flags;
+	uint8_t size;   /* 2 or 4 */
+	uint8_t mode;   /* TOTR_MODE_ARM or TOTR_MODE_THUMB */
+	uint8_t format; /* enum totr_format */
+	uint8_t cond;
+	uint8_t opcode;
+	uint8_t rd;
+	uint8_t rn;
+	uint8_t rs;
+	uint8_t rm;
+	uint8_t reserved;
+} totr_instruction;
+
+typedef struct totr_decoder totr_decoder;
+typedef struct totr_image totr_image;
+
+TOTR_API uint32_t totr_api_version(void);
+
+/* A decoder renders text the same way for every call; NULL only when out of memory. */
+TOTR_API totr_decoder* totr_decoder_create(uint32_t options);
+TOTR_API void totr_decoder_destroy(totr_decoder* decoder);
+
+/*
+Decodes `bytes` in one mode from the start, as instructions at `address`, `address + size`, ...
+until `capacity` instructions are written or the bytes run out. Row i of `out` receives the
+i-th instruction; when `text` is not NULL its mnemonic is written NUL-terminated at
+text + i * text_stride, truncated to text_stride - 1 characters. Returns the number of rows.
+*/
+TOTR_API size_t totr_decode(const totr_decoder* decoder, const uint8_t* bytes, size_t size, uint32_t address, int mode,
+	totr_instruction* out, char* text, size_t text_stride, size_t capacity);
+
+/*
+An image handle copies the bytes and runs the CLI's linear sweep over them once, including
+register tracking and mode switching, so later calls only read the result.
+*/
+TOTR_API totr_image* totr_image_open(const uint8_t* bytes, size_t size, uint32_t base_address, uint32_t options);
+TOTR_API void totr_image_close(totr_image* image);
+
+/* Number of instructions the sweep found. */
+TOTR_API size_t totr_image_instruction_count(const totr_image* image);
+
+/*
+Like totr_decode, but follows the sweep from the instruction containing bus address `address`,
+each row in the mode the sweep chose for it. Returns 0 when `address` is outside the image.
+*/
+TOTR_API size_t totr_image_decode(const totr_image* image, uint32_t address,
+	totr_instruction* out, char* text, size_t text_stride, size_t capacity);
+
+/* Forces `mode` from bus address `address` on and re-sweeps what changes; returns the number of
+   instructions decoded, 0 when `address` is not an instruction boundary. */
+TOTR_API size_t totr_image_set_override(totr_image* image, uint32_t address, int mode);
+TOTR_API size_t totr_image_clear_override(totr_image* image, uint32_t address);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TOTR_ARM7TDMI_DECODER_H */
@@ -1,33 +1,75 @@
 #pragma once
 
 #include <cstdint>
+#include <span>
 #include <string>
 
 #include "Common.hpp"
+#include "DecodedFields.hpp"
 
 namespace totr::Disassembler {
-	class ArmDisasm {
+	// Raw fields shared by the three coprocessor formats. Which members are meaningful depends on
+	// the format: LDC/STC use the addressing flags and offset, CDP and MCR/MRC use the opcodes.
+	struct CoprocOperands {
+		std::uint8_t cond;     // Bit 31-28
+		std::uint8_t opcode1;  // CDP: Bit 23-20, MCR/MRC: Bit 23-21
+		std::uint8_t crn;      // Bit 19-16, base register Rn for LDC/STC
+		std::uint8_t crd;      // Bit 15-12, ARM register Rd for MCR/MRC
+		std::uint8_t cp_num;   // Bit 11-8
+		std::uint8_t opcode2;  // Bit 7-5
+		std::uint8_t crm;      // Bit 3-0
+		std::uint8_t offset;   // Bit 7-0, LDC/STC word offset
+		bool pre_index;        // Bit 24
+		bool add_offset;       // Bit 23
+		bool long_transfer;    // Bit 22
+		bool write_back;       // Bit 21
+		bool is_load;          // Bit 20, also MRC vs MCR
+	};
+
+	// Text-free decoding shared by every ArmDisasm variant.
+	class ArmFieldDecoder {
 	public:
-		explicit ArmDisasm(bool print_literals_hex = true) : m_print_literals_hex(print_literals_hex) {}
+		// classify picks the format exactly as decode does; decode_fields and decode_batch
+		// additionally fill the operand columns described in DecodedFields.hpp.
+		static InstrFormat classify(const std::uint32_t instr);
+
+		static DecodedFields decode_fields(std::uint32_t pc, const std::uint32_t instr);
 
+		// Decodes instrs[i] as the word at base_pc + 4 * i into row i of out.
+		static void decode_batch(std::span<const std::uint32_t> instrs, std::uint32_t base_pc, const DecodedBatch& out);
+
+		static CoprocOperands extract_coproc_operands(const std::uint32_t instr);
+	protected:
+		static std::uint32_t rotr32(std::uint32_t value, std::uint32_t rot);
+
+		static void extract_fields(const std::uint32_t instr, DecodedFields& fields);
+
+		static void complete_fields(std::uint32_t pc, const std::uint32_t instr, DecodedFields& fields);
+	};
+
+	/*
+	ARM text decoder with its output options fixed at compile time by a format policy (see
+	HexFormat), so rendering an instruction tests no option flags. Instantiated for HexFormat and
+	DecimalFormat; callers that pick the format at run time use ArmDisasm.
+	*/
+	template <typename Format>
+	class BasicArmDisasm : public ArmFieldDecoder {
+	public:
 		InstructionData decode(std::uint32_t pc, const std::uint32_t instr) const;
-		
-		void toggle_print_literals_hex() { m_print_literals_hex = !m_print_literals_hex; }
-	private:
-		bool m_print_literals_hex;
 
+		// Decodes into a caller-owned record so a sweep can reuse one InstructionData throughout.
+		void decode(std::uint32_t pc, const std::uint32_t instr, InstructionData& out) const;
+	private:
 		// Utility Methods
-		std::string print_literal(uint32_t v, bool prefix_hash = true) const;
+		static void print_literal(Mnemonic& mnemonic, std::uint32_t v, bool prefix_hash = true) {
+			append_literal(mnemonic, v, Format::hex_literals, prefix_hash);
+		}
 		
-		std::uint32_t rotr32(std::uint32_t value, std::uint32_t rot) const;
-		
-		std::string build_shift_op(const std::uint32_t instr) const;
+		void build_shift_op(Mnemonic& mnemonic, const std::uint32_t instr) const;
 
 		// Format Dispatchers
 		InstructionData dispatch_arm(std::uint32_t pc, const std::uint32_t instr) const;
 
-		InstructionData dispatch_data_proc_psr(std::uint32_t pc, const std::uint32_t instr) const;
-
 		// Format Decoders
 		InstructionData dis_branch_exchange(std::uint32_t pc, const std::uint32_t instr) const;
 		
@@ -56,5 +98,23 @@ namespace totr::Disassembler {
 		InstructionData dis_single_data_swap(std::uint32_t pc, const std::uint32_t instr) const;
 		
 		InstructionData dis_swi(std::uint32_t pc, const std::uint32_t instr) const;
+
+		InstructionData dis_coproc(std::uint32_t pc, const std::uint32_t instr) const;
+	};
+
+	// Runtime-configured ARM decoder: one branch per instruction selects the BasicArmDisasm variant.
+	class ArmDisasm : public ArmFieldDecoder {
+	public:
+		explicit ArmDisasm(bool print_literals_hex = true) : m_print_literals_hex(print_literals_hex) {}
+
+		InstructionData decode(std::uint32_t pc, const std::uint32_t instr) const;
+
+		// Decodes into a caller-owned record so a sweep can reuse one InstructionData throughout.
+		void decode(std::uint32_t pc, const std::uint32_t instr, InstructionData& out) const;
+
+		bool print_literals_hex() const { return m_print_literals_hex; }
+		void toggle_print_literals_hex() { m_print_literals_hex = !m_print_literals_hex; }
+	private:
+		bool m_print_literals_hex;
 	};
 } // totr::Disassembler
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <ostream>
+
+#include "ArmDisasm.hpp"
+#include "ThumbDisasm.hpp"
+#include "MemoryReader.hpp"
+#include "ModeSweep.hpp"
+#include "SymbolTable.hpp"
+
+namespace totr::Disassembler {
+	/*
+	Writes a swept image as GNU as source (divided syntax, the assembler's default for ARMv4T) that
+	reassembles to the same bytes: `.arm` / `.thumb` at mode switches, labels at branch and BX
+	destinations and symbols, `.word` for literal pool words read by PC-relative loads, and the
+	rows of split_data for data regions the sweep skipped. Instructions are written from the
+	DecodedFields the sweep keeps per entry; listing text is only produced for the fallback comments.
+	Words the assembler would encode differently (invalid or undefined encodings, non-canonical
+	immediates, nonzero should-be-zero fields, branches leaving the image) are kept as
+	`.word` / `.hword` with the decoded text as a comment. Big-endian images need `as -EB`.
+	Instantiated for both byte orders.
+	*/
+	template <std::endian Order>
+	void write_gnu_as(std::ostream& out, const ModeSweep<Order>& sweep, const MemoryReader<Order>& memory,
+		const ArmDisasm& arm, const ThumbDisasm& thumb, const SymbolTable& symbols, std::uint32_t base_address);
+} // totr::Disassembler
@@ -1,25 +1,117 @@
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
+#include <optional>
+#include <ostream>
 #include <span>
 #include <string>
+#include <string_view>
+#include <utility>
 
 namespace totr::Disassembler {
 	enum class ArmMode { ARM, THUMB };
 	enum class ModeEvent { None, BX, ExceptionReturn };
+
+	// Identifies the format decoder that produced an instruction; Invalid when no format matched.
+	enum class InstrFormat : std::uint8_t {
+		Invalid,
+		// ARM
+		ArmBranchExchange, ArmBranch, ArmDataProc, ArmPsrMrs, ArmPsrMsrReg, ArmPsrMsrImm,
+		ArmMul, ArmMulLong, ArmSingleDataTrans, ArmHalfwordTransReg, ArmHalfwordTransImm,
+		ArmBlockDataTrans, ArmSingleDataSwap, ArmSwi, ArmUndefined,
+		ArmCoprocDataTrans, ArmCoprocDataOp, ArmCoprocRegTrans,
+		// THUMB
+		ThumbMoveShiftedReg, ThumbAddSub, ThumbMovCmpAddSubImm, ThumbAluOps, ThumbHiRegOpsBx,
+		ThumbPcRelLoad, ThumbLoadStoreRegOff, ThumbLoadStoreSignExt, ThumbLoadStoreImmOff,
+		ThumbLoadStoreHalfword, ThumbSpRelLoadStore, ThumbLoadAddress, ThumbAddOffToSp,
+		ThumbPushPopReg, ThumbMultiLoadStore, ThumbCondBranch, ThumbSwi, ThumbUncondBranch,
+		ThumbLongBranchLink,
+		Count
+	};
 	
+	// Fixed-capacity inline text buffer for a rendered instruction. ARMv4T mnemonics are bounded
+	// (the longest, an LDM/STM with a sparse register list, stays well under 80 characters), so
+	// decoding never touches the heap and an InstructionData is trivially copyable.
+	// Text beyond the capacity is truncated.
+	class Mnemonic {
+	public:
+		static constexpr std::size_t capacity = 79;
+
+		Mnemonic() = default;
+		Mnemonic(const char* text) { append(std::string_view(text)); }
+		Mnemonic(std::string_view text) { append(text); }
+
+		Mnemonic& operator+=(std::string_view text) { append(text); return *this; }
+		Mnemonic& operator+=(char letter) { push_back(letter); return *this; }
+
+		void append(std::string_view text) {
+			const std::size_t length = std::min(text.size(), capacity - m_size);
+			std::copy_n(text.data(), length, m_data + m_size);
+			m_size = static_cast<std::uint8_t>(m_size + length);
+		}
+
+		template <typename... Parts>
+		void append(std::string_view first, std::string_view second, Parts&&... rest) {
+			append(first);
+			append(second, std::forward<Parts>(rest)...);
+		}
+
+		void push_back(char letter) {
+			if (m_size < capacity) m_data[m_size++] = letter;
+		}
+
+		// Direct write access for formatters that render in place: write up to remaining() bytes
+		// at tail(), then commit() the number actually written.
+		char* tail() { return m_data + m_size; }
+		std::size_t remaining() const { return capacity - m_size; }
+		void commit(std::size_t length) { m_size = static_cast<std::uint8_t>(m_size + std::min(length, remaining())); }
+
+		void clear() { m_size = 0; }
+		bool empty() const { return m_size == 0; }
+		std::size_t size() const { return m_size; }
+		const char* data() const { return m_data; }
+		std::string_view view() const { return { m_data, m_size }; }
+		operator std::string_view() const { return view(); }
+
+		friend bool operator==(const Mnemonic& lhs, std::string_view rhs) { return lhs.view() == rhs; }
+		friend std::ostream& operator<<(std::ostream& out, const Mnemonic& text) { return out.write(text.m_data, text.m_size); }
+	private:
+		char m_data[capacity];
+		std::uint8_t m_size = 0;
+	};
+
 	struct InstructionData {
 		std::uint32_t pc;
 		std::uint32_t instruction;
-		std::string mnemonic;
+		Mnemonic mnemonic;
 		bool is_thumb;
 		uint8_t size;
 		bool is_valid;
 		ModeEvent mode_event;
+		InstrFormat format;
+		std::optional<std::uint32_t> target_address = std::nullopt; // Branch, BL and ADR destination
+	};
+
+	// Compile-time output options for BasicArmDisasm / BasicThumbDisasm. Each policy is its own
+	// instantiation, so a new option adds a variant rather than a branch in every decode.
+	struct HexFormat {
+		static constexpr bool hex_literals = true;
+	};
+
+	struct DecimalFormat {
+		static constexpr bool hex_literals = false;
 	};
 
-	std::string get_register_name(std::uint8_t reg, bool use_alias = true);
-	std::string get_cond_suffix(std::uint8_t cond);
-	std::string print_register_list(std::uint32_t register_list, int length);
+	// Table-driven integer rendering shared by both decoders and the listing. Each writes into
+	// `out`, which must have room for 12 characters, and returns the number written.
+	std::size_t format_literal(char* out, std::uint32_t value, bool hex, bool prefix_hash = true);
+	std::size_t format_hex_fixed(char* out, std::uint32_t value, int digits); // "0x" + zero-padded digits
+	void append_literal(Mnemonic& mnemonic, std::uint32_t value, bool hex, bool prefix_hash = true);
+
+	const char* get_format_name(InstrFormat format);
+	std::string_view get_register_name(std::uint8_t reg, bool use_alias = true);
+	std::string_view get_cond_suffix(std::uint8_t cond);
+	void print_register_list(Mnemonic& out, std::uint32_t register_list, int length);
 	std::uint32_t read_word32_at(std::span<const std::uint8_t> rom, std::uint32_t pc);
 } // totr::Disassembler
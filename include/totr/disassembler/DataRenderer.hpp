@@ -0,0 +1,45 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "MemoryReader.hpp"
+
+namespace totr::Disassembler {
+	// Bytes known not to be code, e.g. from a `DATA` line of an override file; [start, end) are bus addresses.
+	struct DataRegion {
+		std::uint32_t start;
+		std::uint32_t end;
+	};
+
+	enum class DataKind : std::uint8_t {
+		Bytes,     // .byte
+		Halfwords, // .hword, aligning a run to a word boundary
+		Words,     // .word
+		Pointers,  // .word values inside the ROM bus range (0x08000000-0x09FFFFFF)
+		Ascii      // .ascii, or .asciz when the row ends in the NUL terminator
+	};
+
+	// One directive line; [offset, offset + size) are image offsets.
+	struct DataRow {
+		std::uint32_t offset;
+		std::uint32_t size;
+		DataKind kind;
+	};
+
+	/*
+	Splits the image bytes [first, last) into directive rows: tables of two or more aligned ROM
+	pointers, runs of at least four printable characters (with their NUL terminator, if any) and
+	everything else packed four words to a row, so a data region lists in a fraction of the lines
+	an instruction per word would take. The pointer and character classes are computed in one
+	branch-free pass over the region before it is split. Instantiated for both byte orders.
+	*/
+	template <std::endian Order>
+	std::vector<DataRow> split_data(const MemoryReader<Order>& memory, std::uint32_t first, std::uint32_t last);
+
+	// Appends the directive for `row`, e.g. `.word 0x08000F1C, 0x08000F60`, without a newline.
+	template <std::endian Order>
+	void append_data_row(std::string& line, const MemoryReader<Order>& memory, const DataRow& row);
+} // totr::Disassembler
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+#include "Common.hpp"
+
+namespace totr::Disassembler {
+	// Bits of DecodedFields::flags / DecodedBatch::flags.
+	namespace DecodeFlag {
+		constexpr std::uint16_t Valid           = 1 << 0;
+		constexpr std::uint16_t SetFlags        = 1 << 1;  // S bit; PSR/user-bank bit for LDM/STM
+		constexpr std::uint16_t Immediate       = 1 << 2;  // `imm` holds an immediate operand or offset
+		constexpr std::uint16_t Load            = 1 << 3;  // L bit; MRC for register transfers
+		constexpr std::uint16_t PreIndex        = 1 << 4;
+		constexpr std::uint16_t AddOffset       = 1 << 5;
+		constexpr std::uint16_t WriteBack       = 1 << 6;
+		constexpr std::uint16_t Byte            = 1 << 7;
+		constexpr std::uint16_t Link            = 1 << 8;
+		constexpr std::uint16_t BranchExchange  = 1 << 9;  // ModeEvent::BX
+		constexpr std::uint16_t ExceptionReturn = 1 << 10; // ModeEvent::ExceptionReturn
+		constexpr std::uint16_t HasTarget       = 1 << 11; // `imm` is an absolute branch destination
+		constexpr std::uint16_t Wide            = 1 << 12; // THUMB BL pair; the instruction is 4 bytes
+	}
+
+	/*
+	Text-free decode of one instruction. Register columns hold 0xFF when unused.
+	  opcode: format specific sub-operation (ALU op, shift type, SH bits, PSR select, ...)
+	  rd/rn:  destination and first operand / base register
+	  rs/rm:  shift or multiply register and second operand / offset register
+	  imm:    immediate operand, offset, SWI comment, register list or branch destination
+	Coprocessor formats reuse the columns: rd = CRd/Rd, rn = CRn/Rn, rm = CRm, rs = CP#,
+	opcode = CP opcode 1 and imm = CP opcode 2 or the scaled LDC/STC offset.
+	*/
+	struct DecodedFields {
+		InstrFormat format;
+		std::uint8_t cond;
+		std::uint8_t opcode;
+		std::uint8_t rd;
+		std::uint8_t rn;
+		std::uint8_t rs;
+		std::uint8_t rm;
+		std::uint16_t flags;
+		std::uint32_t imm;
+
+		bool is_valid() const { return flags & DecodeFlag::Valid; }
+	};
+
+	// Structure-of-arrays destination for ArmDisasm::decode_batch / ThumbDisasm::decode_batch.
+	// Every column must hold at least as many elements as the input span.
+	struct DecodedBatch {
+		std::span<InstrFormat> format;
+		std::span<std::uint8_t> cond;
+		std::span<std::uint8_t> opcode;
+		std::span<std::uint8_t> rd;
+		std::span<std::uint8_t> rn;
+		std::span<std::uint8_t> rs;
+		std::span<std::uint8_t> rm;
+		std::span<std::uint16_t> flags;
+		std::span<std::uint32_t> imm;
+
+		DecodedFields at(std::size_t index) const {
+			return { format[index], cond[index], opcode[index], rd[index], rn[index], rs[index], rm[index], flags[index], imm[index] };
+		}
+
+		void store(std::size_t index, const DecodedFields& fields) const {
+			format[index] = fields.format;
+			cond[index] = fields.cond;
+			opcode[index] = fields.opcode;
+			rd[index] = fields.rd;
+			rn[index] = fields.rn;
+			rs[index] = fields.rs;
+			rm[index] = fields.rm;
+			flags[index] = fields.flags;
+			imm[index] = fields.imm;
+		}
+	};
+} // totr::Disassembler
@@ -0,0 +1,105 @@
+#pragma once
+
+// POSIX only: the server listens on a Unix domain socket. CMake defines TOTR_HAVE_UNIX_SOCKETS
+// where they are available.
+#ifdef TOTR_HAVE_UNIX_SOCKETS
+
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "ArmDisasm.hpp"
+#include "Common.hpp"
+#include "MemoryReader.hpp"
+#include "ModeSweep.hpp"
+#include "SymbolTable.hpp"
+#include "ThumbDisasm.hpp"
+
+namespace totr::Disassembler {
+	// A loaded image as handed to the server; `name` is what `roms` reports.
+	struct ServerImage {
+		std::string name;
+		std::vector<std::uint8_t> bytes;
+	};
+
+	struct ServerOptions {
+		std::uint32_t base_address = 0;
+		bool hex_literals = true;
+		bool track_registers = true;
+		unsigned thread_count = 0; // 0 uses std::thread::hardware_concurrency()
+	};
+
+	/*
+	Keeps images, their ModeSweep and a cross-reference index resident and answers queries over a
+	Unix domain socket, so a tool pays for loading and sweeping once instead of once per query.
+
+	Every frame in either direction is a 32-bit little-endian byte count followed by that many
+	bytes of text. A request is one command with whitespace-separated arguments; the reply starts
+	with `ok` or `error <message>` on its own line, followed by the result lines:
+
+	    roms                                   index, size and name of every image
+	    decode <rom> <address> [count]         listing lines from the instruction containing <address>
+	    mode <rom> <address>                   ARM or THUMB for the instruction containing <address>
+	    xrefs <rom> <address>                  branches, calls, tracked BX and literal loads to <address>
+	    override <rom> <address> arm|thumb|clear
+	                                           changes one override, re-sweeps and reindexes
+
+	A connection may carry any number of requests. Connections are read without blocking in one
+	poll loop and only complete requests reach a fixed pool of workers, so open or slow clients
+	never pin a thread; a client that stops reading its replies is dropped after a few seconds.
+	Queries share an image's lock; `override` takes it exclusively.
+	Instantiated for both byte orders.
+	*/
+	template <std::endian Order>
+	class DisassemblyServer {
+	public:
+		DisassemblyServer(std::vector<ServerImage> images, SymbolTable symbols,
+			const std::unordered_map<std::uint32_t, ArmMode>& overrides, ServerOptions options);
+		~DisassemblyServer();
+
+		// Answers one request body; safe to call from any thread.
+		std::string handle(std::string_view request);
+
+		// Binds `socket_path`, replacing a stale socket file, and serves until stop(). Throws
+		// std::runtime_error when the socket cannot be set up.
+		void serve(const std::string& socket_path);
+
+		// Makes serve() return within a poll interval; only sets a flag, so a signal handler may call it.
+		void stop() { m_stopping.store(true); }
+	private:
+		struct Xref {
+			std::uint32_t target; // Bus address
+			std::uint32_t source; // Bus address of the referencing instruction
+			const char* kind;
+		};
+
+		struct Image {
+			std::string name;
+			std::vector<std::uint8_t> bytes;
+			MemoryReader<Order> memory;
+			ModeSweep<Order> sweep;
+			std::vector<Xref> xrefs; // Sorted by target, then source
+			mutable std::shared_mutex mutex;
+
+			Image(ServerImage image, const SymbolTable& symbols, const std::unordered_map<std::uint32_t, ArmMode>& overrides, const ServerOptions& options);
+		};
+
+		SymbolTable m_symbols;
+		ServerOptions m_options;
+		ArmDisasm m_arm;
+		ThumbDisasm m_thumb;
+		std::vector<std::unique_ptr<Image>> m_images;
+		std::atomic<bool> m_stopping{ false };
+
+		void index_xrefs(Image& image) const;
+		std::size_t find_entry(const Image& image, std::uint32_t address) const;
+	};
+} // totr::Disassembler
+
+#endif // TOTR_HAVE_UNIX_SOCKETS
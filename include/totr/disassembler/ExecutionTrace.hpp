@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <unordered_map>
+#include <vector>
+
+#include "Common.hpp"
+
+namespace totr::Disassembler {
+	/*
+	The set of (address, mode) pairs an emulator trace executed. A trace is a stream of 32-bit
+	little-endian records, one per executed instruction: the PC with the CPSR T bit in bit 0.
+	Records are kept in the same form (ARM addresses word aligned, THUMB halfword aligned plus
+	the T bit), sorted and deduplicated, so an address executed in both modes appears twice.
+	*/
+	class ExecutionTrace {
+	public:
+		ExecutionTrace() = default;
+
+		/*
+		Streams a trace of any length in fixed-size chunks. The next chunk is read while the
+		current one is sorted and deduplicated in shares on `thread_count` threads (0 uses
+		std::thread::hardware_concurrency()); the shares are merged pairwise in parallel and the
+		result folded into the set. Loops make traces highly repetitive, so memory follows the
+		number of distinct addresses rather than the trace length. Throws std::runtime_error on a
+		read error or a trailing partial record.
+		*/
+		static ExecutionTrace read(std::istream& in, unsigned thread_count = 0);
+
+		bool empty() const { return m_records.empty(); }
+		std::size_t size() const { return m_records.size(); }
+		std::uint64_t steps() const { return m_steps; } // Records read, duplicates included
+
+		const std::vector<std::uint32_t>& records() const { return m_records; }
+
+		bool executed(std::uint32_t address, ArmMode mode) const;
+
+		/*
+		Overrides that replay the trace's modes: one at the start of every run of consecutively
+		executed instructions in one mode, so the sweep enters each traced stretch in the mode the
+		CPU used even when its own guess drifted in the untraced code before it. Addresses the
+		trace executed in both modes get none.
+		*/
+		std::unordered_map<std::uint32_t, ArmMode> mode_overrides() const;
+	private:
+		std::vector<std::uint32_t> m_records;
+		std::uint64_t m_steps = 0;
+	};
+
+	// Record for one executed instruction, normalised the way ExecutionTrace stores it.
+	inline std::uint32_t trace_record(std::uint32_t address, ArmMode mode) {
+		return (mode == ArmMode::ARM) ? (address & ~3u) : ((address & ~1u) | 1);
+	}
+} // totr::Disassembler
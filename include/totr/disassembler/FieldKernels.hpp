@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+#include "DecodedFields.hpp"
+
+namespace totr::Disassembler {
+	enum class FieldKernel { Scalar, SSE41, AVX2 };
+
+	/*
+	Bulk first pass of ArmDisasm::decode_batch: fills the format, cond, rn, rd, rs and rm columns of
+	out for every word, with the register nibbles at their fixed encoding positions (Bit 19-16,
+	15-12, 11-8 and 3-0). Formats match ArmDisasm::classify exactly.
+	The widest kernel the CPU supports is chosen on first use.
+	*/
+	void extract_arm_fields(std::span<const std::uint32_t> instrs, const DecodedBatch& out);
+
+	FieldKernel active_field_kernel();
+
+	// Forces a kernel, e.g. to compare throughput. Requests the CPU cannot run fall back to the
+	// best supported kernel; the kernel actually selected is returned.
+	FieldKernel select_field_kernel(FieldKernel kernel);
+
+	const char* get_field_kernel_name(FieldKernel kernel);
+} // totr::Disassembler
@@ -6,8 +6,21 @@
 #include <string>
 
 #include "Common.hpp"
+#include "DataRenderer.hpp"
+#include "ExecutionTrace.hpp"
+#include "SignatureMatcher.hpp"
+#include "SymbolTable.hpp"
 
 namespace totr::Disassembler {
-    std::unordered_map<std::uint32_t, ArmMode> load_overrides(const std::string& filepath);
+    struct OverrideFile {
+        std::unordered_map<std::uint32_t, ArmMode> modes;
+        // `DATA` lines; each region ends at the next address the file lists.
+        std::vector<DataRegion> data_regions;
+    };
+
+    OverrideFile load_overrides(const std::string& filepath);
     std::vector<uint8_t> load_rom(const std::string& path);
+    SymbolTable load_symbols(const std::string& filepath);
+    std::vector<Signature> load_signatures(const std::string& filepath);
+    ExecutionTrace load_trace(const std::string& path);
 } // totr::Disassembler
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+#include "Common.hpp"
+#include "DecodedFields.hpp"
+#include "MemoryReader.hpp"
+
+namespace totr::Disassembler {
+	// Control-flow and plausibility traits of one decode; bits of InstructionMap::traits.
+	namespace InstrTrait {
+		constexpr std::uint8_t Valid = 1 << 0;
+		constexpr std::uint8_t Rare = 1 << 1;          // Undefined (ARM) or unconditional B (THUMB): rare in real code of the mode
+		constexpr std::uint8_t Conditional = 1 << 2;   // ARM condition other than AL
+		constexpr std::uint8_t SetsCondition = 1 << 3; // ARM compare, S suffix or conditional; a conditional may follow
+		constexpr std::uint8_t EndsBlock = 1 << 4;     // Execution cannot fall through (B, BX, POP {PC}, MOV PC, ...)
+		constexpr std::uint8_t Padding = 1 << 5;       // THUMB MOV Rd, Rd / LSL Rd, Rd, #0 used as alignment
+		constexpr std::uint8_t Wide = 1 << 6;          // THUMB BL pair; the instruction is 4 bytes
+	}
+
+	// InstrTrait bits of `fields`, decoded in `mode`.
+	std::uint8_t instruction_traits(const DecodedFields& fields, ArmMode mode);
+
+	/*
+	Precomputed answer to "is the code at this offset a valid ARM / THUMB instruction, which
+	format is it and how does it affect control flow?" for a whole image: one validity bit, one
+	format byte and one InstrTrait byte per word-aligned offset (ARM) and per halfword-aligned
+	offset (THUMB). Building decodes every slot once, split across threads; queries afterwards are
+	O(1) and never touch the decoders. ModeSweep builds one per image for its BX probe and for
+	the invalid-rate detector's other-mode readings.
+	Offsets outside the image, misaligned ARM offsets and the trailing odd byte read as invalid.
+	*/
+	class InstructionMap {
+	public:
+		InstructionMap() = default;
+
+		// thread_count 0 uses std::thread::hardware_concurrency(). Instantiated for both byte orders.
+		template <std::endian Order>
+		static InstructionMap build(const MemoryReader<Order>& memory, unsigned thread_count = 0);
+
+		std::size_t size() const { return m_size; }
+
+		bool arm_valid(std::uint32_t offset) const {
+			return (offset & 3) == 0 && offset < m_size && test(m_arm_valid, offset >> 2);
+		}
+
+		bool thumb_valid(std::uint32_t offset) const {
+			return (offset & 1) == 0 && offset + 1 < m_size && test(m_thumb_valid, offset >> 1);
+		}
+
+		InstrFormat arm_format(std::uint32_t offset) const {
+			return ((offset & 3) == 0 && offset < m_size) ? m_arm_format[offset >> 2] : InstrFormat::Invalid;
+		}
+
+		InstrFormat thumb_format(std::uint32_t offset) const {
+			return ((offset & 1) == 0 && offset + 1 < m_size) ? m_thumb_format[offset >> 1] : InstrFormat::Invalid;
+		}
+
+		std::uint8_t traits(std::uint32_t offset, ArmMode mode) const {
+			if (mode == ArmMode::ARM) return ((offset & 3) == 0 && offset < m_size) ? m_arm_traits[offset >> 2] : 0;
+			return ((offset & 1) == 0 && offset + 1 < m_size) ? m_thumb_traits[offset >> 1] : 0;
+		}
+	private:
+		std::size_t m_size = 0;
+		std::vector<std::uint64_t> m_arm_valid;   // bit i = word at offset 4 * i
+		std::vector<std::uint64_t> m_thumb_valid; // bit i = halfword at offset 2 * i
+		std::vector<InstrFormat> m_arm_format;
+		std::vector<InstrFormat> m_thumb_format;
+		std::vector<std::uint8_t> m_arm_traits;
+		std::vector<std::uint8_t> m_thumb_traits;
+
+		static bool test(const std::vector<std::uint64_t>& bits, std::size_t index) {
+			return (bits[index >> 6] >> (index & 63)) & 1;
+		}
+	};
+} // totr::Disassembler
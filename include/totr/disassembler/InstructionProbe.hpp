@@ -6,9 +6,24 @@
 #include "Common.hpp"
 #include "ArmDisasm.hpp"
 #include "ThumbDisasm.hpp"
+#include "InstructionMap.hpp"
+#include "MemoryReader.hpp"
 
 namespace totr::Disassembler {
     enum class ModeGuess { ARM, THUMB, BOTH, NEITHER };
 
+    // Instantiated for std::endian::little and std::endian::big.
+    template <std::endian Order>
+    ModeGuess probe_mode(const MemoryReader<Order>& memory, std::uint32_t pc, const ArmDisasm& arm, const ThumbDisasm& thumb);
+
+    // Same answer from the structured decode alone; no text is rendered. Instantiated for both byte orders.
+    template <std::endian Order>
+    ModeGuess probe_mode(const MemoryReader<Order>& memory, std::uint32_t pc);
+
+    // Little-endian convenience overload.
     ModeGuess probe_mode(std::span<const std::uint8_t> rom, std::uint32_t pc, const ArmDisasm& arm, const ThumbDisasm& thumb);
+
+    // O(1) probe against a prebuilt map. ARM code is word aligned, so unlike the decoding probes a
+    // misaligned pc never reports ARM.
+    ModeGuess probe_mode(const InstructionMap& map, std::uint32_t pc);
 } // totr::Disassembler
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <span>
+
+namespace totr::Disassembler {
+	// Byte-order aware view over a ROM image. The byte order is a template parameter so the sweep
+	// and probes are compiled once per order and the fetch paths contain no runtime endian checks.
+	// Reads that run past the end of the image are zero-filled.
+	template <std::endian Order>
+	class MemoryReader {
+	public:
+		static constexpr std::endian byte_order = Order;
+
+		explicit MemoryReader(std::span<const std::uint8_t> rom) : m_rom(rom) {}
+
+		std::span<const std::uint8_t> bytes() const { return m_rom; }
+		std::size_t size() const { return m_rom.size(); }
+
+		std::uint16_t read_halfword(std::uint32_t offset) const {
+			const std::uint16_t first = byte_at(offset);
+			const std::uint16_t second = byte_at(offset + 1);
+			if constexpr (Order == std::endian::little) return static_cast<std::uint16_t>(first | (second << 8));
+			else return static_cast<std::uint16_t>((first << 8) | second);
+		}
+
+		std::uint32_t read_word(std::uint32_t offset) const {
+			const std::uint32_t first = read_halfword(offset);
+			const std::uint32_t second = read_halfword(offset + 2);
+			if constexpr (Order == std::endian::little) return first | (second << 16);
+			else return (first << 16) | second;
+		}
+
+		// ARM instruction fetch; a full word in the image's byte order.
+		std::uint32_t fetch_arm(std::uint32_t offset) const { return read_word(offset); }
+
+		// THUMB instruction fetch as ThumbDisasm expects it: the halfword at `offset` in bits 15-0
+		// and the following halfword (the BL suffix, if any) in bits 31-16.
+		std::uint32_t fetch_thumb(std::uint32_t offset) const {
+			return std::uint32_t(read_halfword(offset)) | (std::uint32_t(read_halfword(offset + 2)) << 16);
+		}
+	private:
+		std::span<const std::uint8_t> m_rom;
+
+		std::uint8_t byte_at(std::uint32_t offset) const { return offset < m_rom.size() ? m_rom[offset] : 0; }
+	};
+
+	using LittleEndianReader = MemoryReader<std::endian::little>;
+	using BigEndianReader = MemoryReader<std::endian::big>;
+} // totr::Disassembler
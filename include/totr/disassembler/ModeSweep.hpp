@@ -0,0 +1,127 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Common.hpp"
+#include "DataRenderer.hpp"
+#include "DecodedFields.hpp"
+#include "InstructionMap.hpp"
+#include "InstructionProbe.hpp"
+#include "MemoryReader.hpp"
+#include "RegisterTracker.hpp"
+#include "SymbolTable.hpp"
+
+namespace totr::Disassembler {
+	// Why the sweep continued in a given mode after an instruction.
+	enum class ModeReason : std::uint8_t {
+		None,            // Mode carried over
+		Initial,         // Start of the image
+		Heuristic,       // probe_mode after a BX
+		BranchExchange,  // BX to a destination known from register tracking
+		ExceptionReturn, // MOVS PC / LDM ^ with PC
+		Override,        // Manual override
+		InvalidRate      // Implausible run in one mode that reads cleanly in the other
+	};
+
+	namespace SweepFlag {
+		constexpr std::uint8_t Thumb = 1 << 0;        // Decoded in THUMB mode
+		constexpr std::uint8_t NextThumb = 1 << 1;    // Sweep continues in THUMB mode
+		constexpr std::uint8_t Ambiguous = 1 << 2;    // BX whose destination mode could not be decided
+		constexpr std::uint8_t ModeSwitched = 1 << 3; // BX, tracked destination or invalid-rate detector decided the next mode
+		constexpr std::uint8_t Override = 1 << 4;     // A manual override decided the next mode
+		constexpr std::uint8_t TrackerClear = 1 << 5; // No register was known and the code around it reads plausibly; a re-sweep may start here
+		constexpr std::uint8_t Implausible = 1 << 6;  // Rare in real code of this mode; counted by the invalid-rate detector
+	}
+
+	// One instruction of the linear sweep and the mode decision taken after it.
+	struct SweepEntry {
+		std::uint32_t offset;   // Offset into the image
+		std::uint8_t size;      // 2 or 4
+		std::uint8_t flags;     // SweepFlag
+		ModeReason reason;      // Reason for next_mode()
+		DecodedFields fields{}; // Structured decode in mode(), kept from the sweep
+
+		ArmMode mode() const { return (flags & SweepFlag::Thumb) ? ArmMode::THUMB : ArmMode::ARM; }
+		ArmMode next_mode() const { return (flags & SweepFlag::NextThumb) ? ArmMode::THUMB : ArmMode::ARM; }
+	};
+
+	// Maximal run of instructions decoded in one mode; [start, end) are image offsets.
+	struct ModeSegment {
+		std::uint32_t start;
+		std::uint32_t end;
+		ArmMode mode;
+		ModeReason reason; // Why the run starts in `mode`
+	};
+
+	/*
+	The CLI's linear sweep as persistent state. Every instruction boundary, its mode and the mode
+	decision after it are kept, so changing one override re-decodes only from the nearest point
+	where register tracking was clear up to the first boundary where the new mode stream meets the
+	old one again (same offset, same mode, nothing tracked on either side). BX destinations found
+	by tracking that change as a result are re-swept the same way.
+	Data regions hold no instructions: the sweep skips them, so entries() leaves a gap, and resumes
+	after each one with nothing tracked, in the mode of an override at its end or the mode it had.
+	Code reached without a BX (function pointers, veneers, jump tables) is caught by the invalid-rate
+	detector: it keeps one bit per instruction of the last 16 (invalid or undefined, conditional ARM
+	with nothing setting the flags before it, unconditional THUMB B), and once 6 are set it looks
+	back up to 64 instructions for a block end (B, BX, POP {PC}, ..., optionally followed by one
+	padding MOV) behind which a third of the run is implausible. The first such run that decodes
+	cleanly in the other mode is re-swept in it. Decisions made by overrides or tracked BX
+	destinations are never reversed, and re-sweeps restart only where the detector's state is known.
+	Overrides, data regions and symbols use bus addresses (`base_address` + offset), like the listing.
+	Instantiated for both byte orders.
+	*/
+	template <std::endian Order>
+	class ModeSweep {
+	public:
+		ModeSweep(MemoryReader<Order> memory, const SymbolTable& symbols, std::uint32_t base_address,
+			std::unordered_map<std::uint32_t, ArmMode> overrides = {}, bool track_registers = true, std::vector<DataRegion> data = {});
+
+		// Sweeps the whole image; returns the number of instructions decoded.
+		std::size_t run();
+
+		// Inserts, replaces or removes one override and re-sweeps what it changes. Returns the
+		// number of instructions decoded, 0 when the override does not fall on an instruction boundary.
+		std::size_t set_override(std::uint32_t address, ArmMode mode);
+		std::size_t remove_override(std::uint32_t address);
+
+		const std::vector<SweepEntry>& entries() const { return m_entries; }
+		std::vector<ModeSegment> segments() const;
+
+		// Destination of the BX at `offset` when tracking knew its register.
+		std::optional<BranchTarget> tracked_target(std::uint32_t offset) const;
+
+		// Structured decode of an element of entries(), kept from the sweep; other entries are decoded.
+		DecodedFields fields(const SweepEntry& entry) const;
+	private:
+		MemoryReader<Order> m_memory;
+		const SymbolTable& m_symbols;
+		std::uint32_t m_base_address;
+		std::unordered_map<std::uint32_t, ArmMode> m_overrides;
+		bool m_track_registers;
+		std::vector<DataRegion> m_data; // Image offsets, sorted and disjoint
+
+		std::vector<SweepEntry> m_entries;
+		std::map<std::uint32_t, BranchTarget> m_targets;                         // by source offset
+		std::map<std::pair<std::uint32_t, std::uint32_t>, ArmMode> m_target_modes; // by (bus address, source offset)
+		InstructionMap m_map; // Both readings of every offset, for the BX probe and the invalid-rate detector
+
+		std::size_t resweep(std::uint32_t offset);
+		DecodedFields decode(std::uint32_t offset, ArmMode mode) const;
+		std::size_t sweep_from(std::size_t first, std::uint32_t dirty, std::set<std::uint32_t>& pending);
+
+		// Index into `run`, swept from m_entries[first], the sweep should restart at in the other mode;
+		// run.size() when no block back to `barrier` reads better that way
+		std::size_t find_mode_change(std::size_t first, const std::vector<SweepEntry>& run, std::size_t barrier) const;
+
+		// Mode recorded for bus address `address` by the last BX before offset `before`
+		std::optional<ArmMode> target_mode(std::uint32_t address, std::uint32_t before) const;
+	};
+} // totr::Disassembler
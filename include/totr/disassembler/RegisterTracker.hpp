@@ -0,0 +1,62 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <optional>
+
+#include "Common.hpp"
+#include "DecodedFields.hpp"
+#include "MemoryReader.hpp"
+
+namespace totr::Disassembler {
+	struct BranchTarget {
+		std::uint32_t address; // Bit 0 (THUMB) / Bit 1-0 (ARM) cleared
+		ArmMode mode;
+	};
+
+	/*
+	Forward constant propagation over a linear sweep. Registers become known through ADR, MOV/MVN
+	and ALU immediates, PC-relative literal loads and BL's link value, and are forgotten on any
+	other write, on conditional writes that may disagree, and wherever control flow means the next
+	instruction in address order is not the fall-through path. Only needs the structured decode.
+	*/
+	class RegisterTracker {
+	public:
+		// Forget every register, e.g. at a function label where unknown callers join.
+		void reset() { m_known = 0; }
+		bool empty() const { return m_known == 0; }
+
+		std::optional<std::uint32_t> value(std::uint8_t reg) const {
+			if (reg < 16 && ((m_known >> reg) & 1)) return m_values[reg];
+			return std::nullopt;
+		}
+
+		// Destination of a BX whose register value is known. Call before step().
+		std::optional<BranchTarget> branch_exchange_target(const DecodedFields& fields) const;
+
+		// Applies one instruction. `pc` is the bus address the instruction was decoded at and
+		// `base_address` maps bus addresses back into `memory` for literal pool reads.
+		// Instantiated for both byte orders.
+		template <std::endian Order>
+		void step(const DecodedFields& fields, ArmMode mode, std::uint32_t pc, const MemoryReader<Order>& memory, std::uint32_t base_address);
+	private:
+		std::array<std::uint32_t, 16> m_values{};
+		std::uint16_t m_known = 0;
+
+		void assign(std::uint8_t reg, std::optional<std::uint32_t> value, bool conditional);
+		void forget(std::uint8_t reg) { if (reg < 16) m_known &= ~(1u << reg); }
+		void forget_list(std::uint32_t list) { m_known &= ~list; }
+
+		// Registers the callee may change across BL and SWI: R0-R3, R12 (AAPCS caller-saved)
+		void clobber_call() { forget_list(0x100F); }
+
+		std::optional<std::uint32_t> operand(std::uint8_t reg, std::uint32_t pc_value) const {
+			if (reg == 15) return pc_value;
+			return value(reg);
+		}
+
+		void step_arm(const DecodedFields& fields, std::uint32_t pc, std::optional<std::uint32_t> literal);
+		void step_thumb(const DecodedFields& fields, std::uint32_t pc, std::optional<std::uint32_t> literal);
+	};
+} // totr::Disassembler
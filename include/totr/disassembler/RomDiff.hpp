@@ -0,0 +1,43 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "Common.hpp"
+#include "MemoryReader.hpp"
+
+namespace totr::Disassembler {
+	// Half-open range of image offsets.
+	struct ByteRange {
+		std::uint32_t start;
+		std::uint32_t end;
+	};
+
+	// Changed bytes widened to instruction boundaries, decoded in `mode` from `start`.
+	struct DiffWindow {
+		std::uint32_t start;
+		std::uint32_t end;
+		ArmMode mode;
+	};
+
+	/*
+	Ranges where two images differ, in offset order. Equal stretches are skipped a 64 KB memcmp
+	block at a time and a differing block is narrowed with 8-byte compares, so an unchanged image
+	costs little more than reading it. Changes separated by fewer than `merge_gap` equal bytes are
+	reported as one range; bytes past the end of the shorter image count as changed.
+	*/
+	std::vector<ByteRange> find_changes(std::span<const std::uint8_t> old_rom, std::span<const std::uint8_t> new_rom, std::uint32_t merge_gap = 16);
+
+	/*
+	Widens each change by `context` bytes on both sides, word aligns it, steps back over a THUMB
+	BL prefix it would split and merges windows that meet. Each window's mode is a local guess
+	from both images: ARM code is overwhelmingly unconditional, while THUMB code read as words
+	puts an arbitrary halfword's top nibble in the condition field, so the window is ARM when at
+	least half its words decode as valid AL instructions. Instantiated for both byte orders.
+	*/
+	template <std::endian Order>
+	std::vector<DiffWindow> diff_windows(const MemoryReader<Order>& old_memory, const MemoryReader<Order>& new_memory,
+		std::span<const ByteRange> changes, std::uint32_t context = 16);
+} // totr::Disassembler
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Common.hpp"
+#include "MemoryReader.hpp"
+
+namespace totr::Disassembler {
+	// One instruction of a signature; an encoding matches when (encoding & mask) == value.
+	struct SignatureUnit {
+		std::uint32_t mask;
+		std::uint32_t value;
+	};
+
+	// A routine to find: consecutive ARM words or THUMB halfwords (a BL pair is two units).
+	struct Signature {
+		std::string name;
+		ArmMode mode;
+		std::vector<SignatureUnit> units;
+	};
+
+	struct SignatureHit {
+		std::uint32_t offset;    // Image offset of the first unit
+		std::uint32_t signature; // Index into SignatureMatcher::signatures()
+	};
+
+	/*
+	Parses one unit of a signature: hex digits with `?` as a wildcard nibble (`E92D4??0`), or `0b`
+	followed by binary digits with `x` as a wildcard bit. Opcode, register and immediate wildcards
+	are wildcards over the fields' bits. Units are full width (32 bits ARM, 16 THUMB) in either
+	notation; nothing is padded. Throws std::invalid_argument.
+	*/
+	SignatureUnit parse_signature_unit(std::string_view token, ArmMode mode);
+
+	/*
+	Mask/value signature search over raw instruction words. Each signature is anchored on the unit
+	with the most fixed bits, and signatures whose anchors share a mask are grouped behind a 64 Kbit
+	hash filter. A scan reads every aligned word once, rejects almost every position with one bit
+	test per group and only then looks up and verifies candidates, so it runs close to memory speed
+	and the cost grows with the number of distinct anchor masks rather than signatures.
+	*/
+	class SignatureMatcher {
+	public:
+		explicit SignatureMatcher(std::vector<Signature> signatures);
+
+		const std::vector<Signature>& signatures() const { return m_signatures; }
+
+		// Every hit in offset order, scanning on `thread_count` threads (0 uses
+		// std::thread::hardware_concurrency()). Instantiated for both byte orders.
+		template <std::endian Order>
+		std::vector<SignatureHit> scan(const MemoryReader<Order>& memory, unsigned thread_count = 0) const;
+	private:
+		struct Anchor {
+			std::uint32_t value;
+			std::uint32_t signature;
+			std::uint32_t unit; // Index of the anchor within the signature
+		};
+
+		struct AnchorGroup {
+			ArmMode mode;
+			std::uint32_t mask;
+			std::vector<std::uint64_t> filter; // 65536 bits, indexed by filter_slot(value)
+			std::vector<Anchor> anchors;       // Sorted by value
+		};
+
+		std::vector<Signature> m_signatures;
+		std::vector<AnchorGroup> m_groups;
+
+		static std::uint32_t filter_slot(std::uint32_t value) { return (value * 0x9E3779B1u) >> 16; }
+
+		template <std::endian Order>
+		bool matches(const MemoryReader<Order>& memory, const Signature& signature, std::uint32_t offset) const;
+	};
+} // totr::Disassembler
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+#include "Common.hpp"
+
+// Hot-path instrumentation. Everything below compiles to nothing unless the build defines
+// TOTR_ENABLE_STATS (CMake option of the same name), so release builds pay no cost.
+#ifdef TOTR_ENABLE_STATS
+#define TOTR_STATS_CONCAT_IMPL(a, b) a##b
+#define TOTR_STATS_CONCAT(a, b) TOTR_STATS_CONCAT_IMPL(a, b)
+#define TOTR_STATS_SCOPE(phase) \
+	::totr::Disassembler::ScopedPhaseTimer TOTR_STATS_CONCAT(totr_phase_timer_, __LINE__){ ::totr::Disassembler::Phase::phase }
+#define TOTR_STATS_COUNT(counter) (++::totr::Disassembler::run_stats().counter)
+#define TOTR_STATS_FORMAT(format) (++::totr::Disassembler::run_stats().formats[static_cast<std::size_t>(format)])
+#else
+#define TOTR_STATS_SCOPE(phase) ((void)0)
+#define TOTR_STATS_COUNT(counter) ((void)0)
+#define TOTR_STATS_FORMAT(format) ((void)0)
+#endif
+
+namespace totr::Disassembler {
+	enum class Phase { LoadRom, LoadOverrides, Decode, ProbeMode, OverrideLookup, Print, Count };
+
+	struct PhaseStats {
+		std::uint64_t calls = 0;
+		std::uint64_t nanoseconds = 0;
+	};
+
+	struct RunStats {
+		std::array<PhaseStats, static_cast<std::size_t>(Phase::Count)> phases{};
+		std::array<std::uint64_t, static_cast<std::size_t>(InstrFormat::Count)> formats{};
+
+		std::uint64_t instructions = 0;
+		std::uint64_t invalid = 0;
+		std::uint64_t bx_events = 0;
+		std::uint64_t bx_resolved = 0;  // probe_mode picked exactly one mode, or the tracked target is the next instruction
+		std::uint64_t bx_ambiguous = 0; // probe_mode returned BOTH or NEITHER
+		std::uint64_t bx_tracked = 0;   // RegisterTracker knew the BX target
+		std::uint64_t exception_returns = 0;
+		std::uint64_t override_hits = 0;
+		std::uint64_t mode_resyncs = 0; // Mode switches made by the invalid-rate detector
+	};
+
+	// The calling thread's counters. Each thread writes only its own, so the hot path needs no
+	// synchronisation even when the server re-sweeps several images at once.
+	RunStats& run_stats();
+
+	// Sum of every thread's counters, including threads that have exited. Call it once the
+	// threads doing the work have finished or are idle, e.g. after joining them.
+	RunStats collect_stats();
+
+	constexpr bool stats_enabled() {
+#ifdef TOTR_ENABLE_STATS
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	const char* get_phase_name(Phase phase);
+
+	void write_stats_text(std::ostream& out, const RunStats& stats);
+	void write_stats_json(std::ostream& out, const RunStats& stats);
+
+	class ScopedPhaseTimer {
+	public:
+		explicit ScopedPhaseTimer(Phase phase) : m_phase(phase), m_start(std::chrono::steady_clock::now()) {}
+		ScopedPhaseTimer(const ScopedPhaseTimer&) = delete;
+		ScopedPhaseTimer& operator=(const ScopedPhaseTimer&) = delete;
+
+		~ScopedPhaseTimer() {
+			auto elapsed = std::chrono::steady_clock::now() - m_start;
+			PhaseStats& phase = run_stats().phases[static_cast<std::size_t>(m_phase)];
+			phase.calls++;
+			phase.nanoseconds += static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+		}
+	private:
+		Phase m_phase;
+		std::chrono::steady_clock::time_point m_start;
+	};
+} // totr::Disassembler
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace totr::Disassembler {
+	struct SymbolMatch {
+		std::string_view name;
+		std::uint32_t offset; // Distance from the symbol's address; 0 for an exact hit
+	};
+
+	// Flat, address-sorted symbol table. Addresses live in their own contiguous array so a
+	// binary search only touches 4 bytes per probe; names are packed into a single pool.
+	class SymbolTable {
+	public:
+		void add(std::uint32_t address, std::string_view name);
+
+		// Sorts by address and drops duplicate addresses (first definition wins). Must be called
+		// after the last add() and before any lookup.
+		void finalize();
+
+		bool empty() const { return m_addresses.empty(); }
+		std::size_t size() const { return m_addresses.size(); }
+
+		std::uint32_t address(std::size_t index) const { return m_addresses[index]; }
+		std::string_view name(std::size_t index) const;
+
+		// Index of the first symbol at or after `address`; size() if there is none.
+		std::size_t lower_bound(std::uint32_t address) const;
+
+		std::optional<std::string_view> find(std::uint32_t address) const;
+		std::optional<SymbolMatch> find_containing(std::uint32_t address) const;
+	private:
+		struct NameRef { std::uint32_t offset, length; };
+
+		std::vector<std::uint32_t> m_addresses;
+		std::vector<NameRef> m_names;
+		std::string m_name_pool;
+	};
+} // totr::Disassembler
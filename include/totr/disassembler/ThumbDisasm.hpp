@@ -1,23 +1,43 @@
 #pragma once
 
 #include <cstdint>
+#include <span>
 #include <string>
 
 #include "Common.hpp"
+#include "DecodedFields.hpp"
 
 namespace totr::Disassembler {
-	class ThumbDisasm {
+	// Text-free decoding shared by every ThumbDisasm variant.
+	class ThumbFieldDecoder {
 	public:
-		explicit ThumbDisasm(bool print_literals_hex = true) : m_print_literals_hex(print_literals_hex) {}
+		// See ArmFieldDecoder. decode_fields takes the same 32-bit fetch as decode so BL pairs
+		// resolve; decode_batch pairs each halfword with the next one in the span.
+		static InstrFormat classify(const std::uint16_t instr);
+
+		static DecodedFields decode_fields(std::uint32_t pc, const std::uint32_t instr);
+
+		// Decodes instrs[i] as the halfword at base_pc + 2 * i into row i of out.
+		static void decode_batch(std::span<const std::uint16_t> instrs, std::uint32_t base_pc, const DecodedBatch& out);
+	protected:
+		static void extract_fields(const std::uint16_t instr, DecodedFields& fields);
 
+		static void complete_fields(std::uint32_t pc, const std::uint32_t instr, DecodedFields& fields);
+	};
+
+	// THUMB counterpart of BasicArmDisasm; instantiated for HexFormat and DecimalFormat.
+	template <typename Format>
+	class BasicThumbDisasm : public ThumbFieldDecoder {
+	public:
 		InstructionData decode(std::uint32_t pc, const std::uint32_t instr) const;
-		
-		void toggle_print_literals_hex() { m_print_literals_hex = !m_print_literals_hex; }
-	private:
-		bool m_print_literals_hex;
 
+		// Decodes into a caller-owned record so a sweep can reuse one InstructionData throughout.
+		void decode(std::uint32_t pc, const std::uint32_t instr, InstructionData& out) const;
+	private:
 		// Utility Methods
-		std::string print_literal(std::uint32_t v, bool prefix_hash = true) const;
+		static void print_literal(Mnemonic& mnemonic, std::uint32_t v, bool prefix_hash = true) {
+			append_literal(mnemonic, v, Format::hex_literals, prefix_hash);
+		}
 
 		// Format Dispatchers
 		InstructionData thumb_dispatcher(std::uint32_t pc, std::uint32_t instr) const;
@@ -61,4 +81,20 @@ namespace totr::Disassembler {
 		
 		InstructionData dis_long_branch_link(std::uint32_t pc, const std::uint32_t instr) const;
 	};
+
+	// Runtime-configured THUMB decoder: one branch per instruction selects the BasicThumbDisasm variant.
+	class ThumbDisasm : public ThumbFieldDecoder {
+	public:
+		explicit ThumbDisasm(bool print_literals_hex = true) : m_print_literals_hex(print_literals_hex) {}
+
+		InstructionData decode(std::uint32_t pc, const std::uint32_t instr) const;
+
+		// Decodes into a caller-owned record so a sweep can reuse one InstructionData throughout.
+		void decode(std::uint32_t pc, const std::uint32_t instr, InstructionData& out) const;
+
+		bool print_literals_hex() const { return m_print_literals_hex; }
+		void toggle_print_literals_hex() { m_print_literals_hex = !m_print_literals_hex; }
+	private:
+		bool m_print_literals_hex;
+	};
 } // totr::Disassembler
@@ -0,0 +1,78 @@
+#!/usr/bin/env bash
+# Builds the release, LTO, -march=native and PGO flavours from CMakePresets.json and compares
+# their decode throughput on a ROM corpus.
+#
+# Usage: scripts/compare_builds.sh [rom...]
+#   Without ROMs, a 4 MB random image is generated once and shared by every build.
+# Environment:
+#   GENERATOR  CMake generator overriding the presets' Ninja, e.g. GENERATOR="Unix Makefiles"
+#   PASSES     Decode passes format_bench makes over each image (default 3)
+#   BUILDS     Flavours to compare (default "linux-release linux-lto linux-native linux-pgo")
+set -euo pipefail
+
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+OUT="$ROOT/out/build"
+PASSES=${PASSES:-3}
+BUILDS=${BUILDS:-"linux-release linux-lto linux-native linux-pgo"}
+JOBS=$(nproc 2>/dev/null || echo 4)
+
+mkdir -p "$OUT"
+corpus=("$@")
+if [ ${#corpus[@]} -eq 0 ]; then
+    corpus=("$OUT/random.rom")
+    [ -f "${corpus[0]}" ] || head -c $((4 << 20)) /dev/urandom > "${corpus[0]}"
+fi
+
+build() { # <preset> <build dir>
+    local args=(--preset "$1")
+    [ -n "${GENERATOR:-}" ] && args+=(-G "$GENERATOR")
+    (cd "$ROOT" && cmake "${args[@]}" > "$2.configure.log")
+    cmake --build "$2" -j"$JOBS" > "$2.build.log"
+}
+
+# Runs the listing and the GNU as output over the corpus, discarding the text
+run_corpus() { # <build dir>
+    for rom in "${corpus[@]}"; do
+        "$1/Disassembler" "$rom" -b 0x08000000 -o /dev/null > /dev/null
+        "$1/Disassembler" "$rom" -b 0x08000000 --asm -o /dev/null > /dev/null
+    done
+}
+
+# ns/instr for the runtime-configured decoders, averaged over the corpus
+decode_ns() { # <build dir> <ArmDisasm|ThumbDisasm>
+    for rom in "${corpus[@]}"; do
+        "$1/format_bench" "$rom" "$PASSES"
+    done | awk -v name="$2 (runtime, hex)" 'index($0, name) == 1 { sum += $(NF - 1); n++ } END { printf "%.2f", sum / n }'
+}
+
+listing_seconds() { # <build dir>
+    local start end
+    start=$(date +%s.%N)
+    for rom in "${corpus[@]}"; do "$1/Disassembler" "$rom" -b 0x08000000 -o /dev/null > /dev/null; done
+    end=$(date +%s.%N)
+    awk -v a="$start" -v b="$end" 'BEGIN { printf "%.3f", b - a }'
+}
+
+results=()
+for flavour in $BUILDS; do
+    dir="$OUT/$flavour"
+    echo "== $flavour" >&2
+    if [ "$flavour" = linux-pgo ]; then
+        # Both phases share one build directory, so the profiles match the objects that use them
+        rm -rf "$dir/profiles"
+        build linux-pgo-generate "$dir"
+        echo "   training on ${#corpus[@]} image(s)" >&2
+        run_corpus "$dir"
+        for rom in "${corpus[@]}"; do "$dir/format_bench" "$rom" 1 > /dev/null; done
+        if compgen -G "$dir/profiles/*.profraw" > /dev/null; then
+            llvm-profdata merge -output="$dir/profiles/default.profdata" "$dir"/profiles/*.profraw
+        fi
+        build linux-pgo-use "$dir"
+    else
+        build "$flavour" "$dir"
+    fi
+    results+=("$(printf '%-16s %10s %12s %10s' "$flavour" "$(decode_ns "$dir" ArmDisasm)" "$(decode_ns "$dir" ThumbDisasm)" "$(listing_seconds "$dir")")")
+done
+
+printf '%-16s %10s %12s %10s\n' build "ARM ns" "THUMB ns" "listing s"
+printf '%s\n' "${results[@]}"
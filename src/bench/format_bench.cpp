@@ -0,0 +1,69 @@
+// Decode throughput of the runtime-configured decoders against the compile-time format variants.
+// Usage: format_bench [rom] [passes]; without a ROM, a fixed pseudo-random image is decoded.
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <totr/disassembler/ArmDisasm.hpp>
+#include <totr/disassembler/FileUtil.hpp>
+#include <totr/disassembler/MemoryReader.hpp>
+#include <totr/disassembler/ThumbDisasm.hpp>
+
+namespace td = totr::Disassembler;
+
+namespace {
+	std::size_t g_sink = 0; // Keeps the decoded text observable
+
+	template <typename Decoder>
+	double ns_per_instruction(const Decoder& decoder, const std::vector<std::uint32_t>& words, unsigned passes) {
+		using Clock = std::chrono::steady_clock;
+		td::InstructionData data;
+		const auto start = Clock::now();
+		for (unsigned pass = 0; pass < passes; ++pass) {
+			for (std::size_t i = 0; i < words.size(); ++i) {
+				decoder.decode(static_cast<std::uint32_t>(i * 4), words[i], data);
+				g_sink += data.mnemonic.size();
+			}
+		}
+		const std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+		return elapsed.count() / (static_cast<double>(words.size()) * passes);
+	}
+
+	void report(const char* name, double ns) {
+		std::printf("%-34s %7.2f ns/instr\n", name, ns);
+	}
+}
+
+int main(int argc, char** argv) {
+	std::vector<std::uint8_t> rom;
+	if (argc > 1) {
+		rom = td::load_rom(argv[1]);
+	}
+	else {
+		std::mt19937 random(1);
+		rom.resize(4 << 20);
+		for (std::uint8_t& byte : rom) byte = static_cast<std::uint8_t>(random());
+	}
+	const unsigned passes = (argc > 2) ? static_cast<unsigned>(std::strtoul(argv[2], nullptr, 10)) : 3;
+
+	const td::LittleEndianReader memory{ std::span<const std::uint8_t>(rom) };
+	std::vector<std::uint32_t> arm_words(rom.size() / 4);
+	std::vector<std::uint32_t> thumb_fetches(rom.size() / 2);
+	for (std::size_t i = 0; i < arm_words.size(); ++i) arm_words[i] = memory.fetch_arm(static_cast<std::uint32_t>(i * 4));
+	for (std::size_t i = 0; i < thumb_fetches.size(); ++i) thumb_fetches[i] = memory.fetch_thumb(static_cast<std::uint32_t>(i * 2));
+
+	std::printf("%zu ARM words, %zu THUMB halfwords, %u passes\n", arm_words.size(), thumb_fetches.size(), passes);
+	report("ArmDisasm (runtime, hex)", ns_per_instruction(td::ArmDisasm{ true }, arm_words, passes));
+	report("BasicArmDisasm<HexFormat>", ns_per_instruction(td::BasicArmDisasm<td::HexFormat>{}, arm_words, passes));
+	report("ArmDisasm (runtime, decimal)", ns_per_instruction(td::ArmDisasm{ false }, arm_words, passes));
+	report("BasicArmDisasm<DecimalFormat>", ns_per_instruction(td::BasicArmDisasm<td::DecimalFormat>{}, arm_words, passes));
+	report("ThumbDisasm (runtime, hex)", ns_per_instruction(td::ThumbDisasm{ true }, thumb_fetches, passes));
+	report("BasicThumbDisasm<HexFormat>", ns_per_instruction(td::BasicThumbDisasm<td::HexFormat>{}, thumb_fetches, passes));
+	report("ThumbDisasm (runtime, decimal)", ns_per_instruction(td::ThumbDisasm{ false }, thumb_fetches, passes));
+	report("BasicThumbDisasm<DecimalFormat>", ns_per_instruction(td::BasicThumbDisasm<td::DecimalFormat>{}, thumb_fetches, passes));
+	return g_sink == 0;
+}
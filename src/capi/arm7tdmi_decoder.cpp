@@ -0,0 +1,213 @@
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <span>
+#include <variant>
+#include <vector>
+
+#include <totr/arm7tdmi_decoder.h>
+#include <totr/disassembler/ArmDisasm.hpp>
+#include <totr/disassembler/DecodedFields.hpp>
+#include <totr/disassembler/MemoryReader.hpp>
+#include <totr/disassembler/ModeSweep.hpp>
+#include <totr/disassembler/SymbolTable.hpp>
+#include <totr/disassembler/ThumbDisasm.hpp>
+
+namespace td = totr::Disassembler;
+
+// The C header mirrors the C++ enums by value
+static_assert(TOTR_FORMAT_COUNT == static_cast<int>(td::InstrFormat::Count));
+static_assert(TOTR_FORMAT_THUMB_MOVE_SHIFTED_REG == static_cast<int>(td::InstrFormat::ThumbMoveShiftedReg));
+static_assert(TOTR_FLAG_WIDE == td::DecodeFlag::Wide);
+static_assert(sizeof(totr_instruction) == 24);
+
+struct totr_decoder {
+	td::ArmDisasm arm;
+	td::ThumbDisasm thumb;
+	bool big_endian;
+};
+
+namespace {
+	// Decoded state of one image for one byte order
+	template <std::endian Order>
+	struct ImageState {
+		std::vector<std::uint8_t> bytes;
+		td::MemoryReader<Order> memory;
+		td::SymbolTable symbols;
+		td::ModeSweep<Order> sweep;
+
+		ImageState(const std::uint8_t* data, std::size_t size, std::uint32_t base_address, bool track_registers)
+			: bytes(data, data + size), memory(std::span<const std::uint8_t>{ bytes }),
+			  sweep(memory, symbols, base_address, {}, track_registers) {
+			sweep.run();
+		}
+	};
+
+	void store(totr_instruction& row, std::uint32_t fetched, std::uint32_t address, td::ArmMode mode, const td::DecodedFields& fields) {
+		const bool arm = mode == td::ArmMode::ARM;
+		const bool wide = fields.flags & td::DecodeFlag::Wide;
+
+		row.address = address;
+		row.encoding = (arm || wide) ? fetched : (fetched & 0xFFFF);
+		row.imm = fields.imm;
+		row.flags = fields.flags;
+		row.size = static_cast<std::uint8_t>((arm || wide) ? 4 : 2);
+		row.mode = static_cast<std::uint8_t>(arm ? TOTR_MODE_ARM : TOTR_MODE_THUMB);
+		row.format = static_cast<std::uint8_t>(fields.format);
+		row.cond = fields.cond;
+		row.opcode = fields.opcode;
+		row.rd = fields.rd;
+		row.rn = fields.rn;
+		row.rs = fields.rs;
+		row.rm = fields.rm;
+		row.reserved = 0;
+	}
+
+	void store_text(char* row, std::size_t stride, const td::InstructionData& data) {
+		const std::string_view mnemonic = data.mnemonic.view();
+		const std::size_t length = std::min(mnemonic.size(), stride - 1);
+		std::memcpy(row, mnemonic.data(), length);
+		row[length] = '\0';
+	}
+
+	template <std::endian Order>
+	void render(const totr_decoder& decoder, const td::MemoryReader<Order>& memory, const totr_instruction& row, std::uint32_t offset, char* text, std::size_t stride) {
+		if (!text || stride == 0) return;
+		td::InstructionData data;
+		if (row.mode == TOTR_MODE_ARM) decoder.arm.decode(row.address, memory.fetch_arm(offset), data);
+		else decoder.thumb.decode(row.address, memory.fetch_thumb(offset), data);
+		store_text(text, stride, data);
+	}
+
+	template <std::endian Order>
+	std::size_t decode_linear(const totr_decoder& decoder, std::span<const std::uint8_t> bytes, std::uint32_t address, td::ArmMode mode,
+		totr_instruction* out, char* text, std::size_t stride, std::size_t capacity) {
+		const td::MemoryReader<Order> memory{ bytes };
+		const std::size_t unit = (mode == td::ArmMode::ARM) ? 4 : 2;
+
+		std::size_t count = 0;
+		for (std::uint32_t offset = 0; count < capacity && offset + unit <= bytes.size(); ++count) {
+			totr_instruction& row = out[count];
+			const std::uint32_t fetched = (mode == td::ArmMode::ARM) ? memory.fetch_arm(offset) : memory.fetch_thumb(offset);
+			const td::DecodedFields fields = (mode == td::ArmMode::ARM)
+				? td::ArmDisasm::decode_fields(address + offset, fetched) : td::ThumbDisasm::decode_fields(address + offset, fetched);
+			store(row, fetched, address + offset, mode, fields);
+			render(decoder, memory, row, offset, text ? text + count * stride : nullptr, stride);
+			offset += row.size;
+		}
+		return count;
+	}
+
+	template <std::endian Order>
+	std::size_t decode_sweep(const totr_decoder& decoder, const ImageState<Order>& image, std::uint32_t base_address, std::uint32_t address,
+		totr_instruction* out, char* text, std::size_t stride, std::size_t capacity) {
+		const std::vector<td::SweepEntry>& entries = image.sweep.entries();
+		const std::uint32_t offset = address - base_address;
+		if (address < base_address || offset >= image.bytes.size()) return 0;
+
+		auto it = std::upper_bound(entries.begin(), entries.end(), offset,
+			[](std::uint32_t value, const td::SweepEntry& entry) { return value < entry.offset; });
+		if (it == entries.begin()) return 0;
+		--it;
+
+		std::size_t count = 0;
+		for (; count < capacity && it != entries.end(); ++count, ++it) {
+			// The sweep already holds each entry's decode; only the text is rendered again
+			totr_instruction& row = out[count];
+			const std::uint32_t fetched = (it->mode() == td::ArmMode::ARM) ? image.memory.fetch_arm(it->offset) : image.memory.fetch_thumb(it->offset);
+			store(row, fetched, base_address + it->offset, it->mode(), image.sweep.fields(*it));
+			render(decoder, image.memory, row, it->offset, text ? text + count * stride : nullptr, stride);
+		}
+		return count;
+	}
+}
+
+struct totr_image {
+	totr_decoder decoder;
+	std::uint32_t base_address;
+	std::variant<std::unique_ptr<ImageState<std::endian::little>>, std::unique_ptr<ImageState<std::endian::big>>> state;
+};
+
+extern "C" {
+
+uint32_t totr_api_version(void) {
+	return TOTR_API_VERSION;
+}
+
+totr_decoder* totr_decoder_create(uint32_t options) {
+	const bool hex = !(options & TOTR_OPTION_DECIMAL);
+	return new (std::nothrow) totr_decoder{ td::ArmDisasm{ hex }, td::ThumbDisasm{ hex }, (options & TOTR_OPTION_BIG_ENDIAN) != 0 };
+}
+
+void totr_decoder_destroy(totr_decoder* decoder) {
+	delete decoder;
+}
+
+size_t totr_decode(const totr_decoder* decoder, const uint8_t* bytes, size_t size, uint32_t address, int mode,
+	totr_instruction* out, char* text, size_t text_stride, size_t capacity) {
+	if (!decoder || (!bytes && size != 0) || !out || (mode != TOTR_MODE_ARM && mode != TOTR_MODE_THUMB)) return 0;
+
+	const std::span<const std::uint8_t> span{ bytes, size };
+	const td::ArmMode arm_mode = (mode == TOTR_MODE_ARM) ? td::ArmMode::ARM : td::ArmMode::THUMB;
+	if (decoder->big_endian) return decode_linear<std::endian::big>(*decoder, span, address, arm_mode, out, text, text_stride, capacity);
+	return decode_linear<std::endian::little>(*decoder, span, address, arm_mode, out, text, text_stride, capacity);
+}
+
+totr_image* totr_image_open(const uint8_t* bytes, size_t size, uint32_t base_address, uint32_t options) {
+	if (!bytes && size != 0) return nullptr;
+	try {
+		const bool hex = !(options & TOTR_OPTION_DECIMAL);
+		const bool big_endian = options & TOTR_OPTION_BIG_ENDIAN;
+		const bool track_registers = !(options & TOTR_OPTION_NO_TRACK);
+
+		auto image = std::make_unique<totr_image>(totr_image{ { td::ArmDisasm{ hex }, td::ThumbDisasm{ hex }, big_endian }, base_address, {} });
+		if (big_endian) image->state = std::make_unique<ImageState<std::endian::big>>(bytes, size, base_address, track_registers);
+		else image->state = std::make_unique<ImageState<std::endian::little>>(bytes, size, base_address, track_registers);
+		return image.release();
+	}
+	catch (...) {
+		return nullptr;
+	}
+}
+
+void totr_image_close(totr_image* image) {
+	delete image;
+}
+
+size_t totr_image_instruction_count(const totr_image* image) {
+	if (!image) return 0;
+	return std::visit([](const auto& state) { return state->sweep.entries().size(); }, image->state);
+}
+
+size_t totr_image_decode(const totr_image* image, uint32_t address, totr_instruction* out, char* text, size_t text_stride, size_t capacity) {
+	if (!image || !out) return 0;
+	return std::visit([&](const auto& state) {
+		return decode_sweep(image->decoder, *state, image->base_address, address, out, text, text_stride, capacity);
+	}, image->state);
+}
+
+size_t totr_image_set_override(totr_image* image, uint32_t address, int mode) {
+	if (!image || (mode != TOTR_MODE_ARM && mode != TOTR_MODE_THUMB)) return 0;
+	try {
+		const td::ArmMode arm_mode = (mode == TOTR_MODE_ARM) ? td::ArmMode::ARM : td::ArmMode::THUMB;
+		return std::visit([&](auto& state) { return state->sweep.set_override(address, arm_mode); }, image->state);
+	}
+	catch (...) {
+		return 0;
+	}
+}
+
+size_t totr_image_clear_override(totr_image* image, uint32_t address) {
+	if (!image) return 0;
+	try {
+		return std::visit([&](auto& state) { return state->sweep.remove_override(address); }, image->state);
+	}
+	catch (...) {
+		return 0;
+	}
+}
+
+} // extern "C"
@@ -1,32 +1,67 @@
-#include <format>
 #include <string>
 #include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
 
 #include <totr/disassembler/ArmDisasm.hpp>
 #include <totr/disassembler/Common.hpp>
+#include <totr/disassembler/FieldKernels.hpp>
 
 namespace td = totr::Disassembler;
 
 td::InstructionData td::ArmDisasm::decode(std::uint32_t pc, const std::uint32_t instr) const {
+	InstructionData data;
+	decode(pc, instr, data);
+	return data;
+}
+
+void td::ArmDisasm::decode(std::uint32_t pc, const std::uint32_t instr, InstructionData& out) const {
+	// One branch per instruction; the renderers themselves test nothing
+	static const BasicArmDisasm<HexFormat> hex;
+	static const BasicArmDisasm<DecimalFormat> decimal;
+	if (m_print_literals_hex) hex.decode(pc, instr, out);
+	else decimal.decode(pc, instr, out);
+}
+
+template <typename Format>
+td::InstructionData td::BasicArmDisasm<Format>::decode(std::uint32_t pc, const std::uint32_t instr) const {
 	return dispatch_arm(pc, instr);
 }
 
+template <typename Format>
+void td::BasicArmDisasm<Format>::decode(std::uint32_t pc, const std::uint32_t instr, InstructionData& out) const {
+	out = dispatch_arm(pc, instr);
+}
+
 /* --- Utility Methods --- */
-std::string td::ArmDisasm::print_literal(uint32_t v, bool prefix_hash) const {
-	if (m_print_literals_hex) {
-		if (prefix_hash) return std::format("#0x{:X}", v);
-		return std::format("0x{:X}", v);
-	}
-	if (prefix_hash) return std::format("#{}", v);
-	return std::format("{}", v);
+td::CoprocOperands td::ArmFieldDecoder::extract_coproc_operands(const std::uint32_t instr) {
+	const bool is_data_op = (instr & 0x0F000010) == 0x0E000000;
+
+	CoprocOperands operands{};
+	operands.cond = (instr >> 28) & 0xF;
+	operands.opcode1 = is_data_op ? (instr >> 20) & 0xF : (instr >> 21) & 0x7;
+	operands.crn = (instr >> 16) & 0xF;
+	operands.crd = (instr >> 12) & 0xF;
+	operands.cp_num = (instr >> 8) & 0xF;
+	operands.opcode2 = (instr >> 5) & 0x7;
+	operands.crm = instr & 0xF;
+	operands.offset = instr & 0xFF;
+	operands.pre_index = (instr >> 24) & 0x1;
+	operands.add_offset = (instr >> 23) & 0x1;
+	operands.long_transfer = (instr >> 22) & 0x1;
+	operands.write_back = (instr >> 21) & 0x1;
+	operands.is_load = (instr >> 20) & 0x1;
+	return operands;
 }
 
-std::uint32_t td::ArmDisasm::rotr32(std::uint32_t value, std::uint32_t rot) const {
+std::uint32_t td::ArmFieldDecoder::rotr32(std::uint32_t value, std::uint32_t rot) {
 	rot &= 31;
 	return (value >> rot) | (value << ((32 - rot) & 31));
 }
 
-std::string td::ArmDisasm::build_shift_op(const std::uint32_t instr) const {
+template <typename Format>
+void td::BasicArmDisasm<Format>::build_shift_op(Mnemonic& mnemonic, const std::uint32_t instr) const {
 	/*
 	|...1 .................0|
 	|1_0_9_8_7_6_5_4_3_2_1_0|
@@ -37,7 +72,6 @@ std::string td::ArmDisasm::build_shift_op(const std::uint32_t instr) const {
 	const std::uint8_t shift_type = (shift & 0x6) >> 1; // Bit 6-5
 	const bool shift_by_reg = shift & 0x1;              // Bit 4
 
-	std::string mnemonic;
 	if (shift_by_reg) {
 		/*
 		|...1 .........0|
@@ -46,7 +80,7 @@ std::string td::ArmDisasm::build_shift_op(const std::uint32_t instr) const {
 		*/
 		const std::uint8_t shift_register = (shift & 0xF0) >> 4; // Bit 7-4
 
-		mnemonic += get_register_name(op2_register) + ", ";
+		mnemonic.append(get_register_name(op2_register), ", ");
 
 		switch (shift_type) {
 			case (0): mnemonic += "LSL "; break; // Logical Shift Left
@@ -69,10 +103,10 @@ std::string td::ArmDisasm::build_shift_op(const std::uint32_t instr) const {
 			mnemonic += get_register_name(op2_register);
 		}
 		else if (shift_type == 3 && immediate == 0) {
-			mnemonic += get_register_name(op2_register) + ", RRX";
+			mnemonic.append(get_register_name(op2_register), ", RRX");
 		}
 		else {
-			mnemonic += get_register_name(op2_register) + ", ";
+			mnemonic.append(get_register_name(op2_register), ", ");
 			switch (shift_type) {
 				case 0: mnemonic += "LSL "; break; // Logical Shift Left
 				case 1: mnemonic += "LSR "; break; // Logical Shift Right
@@ -80,16 +114,15 @@ std::string td::ArmDisasm::build_shift_op(const std::uint32_t instr) const {
 				case 3: mnemonic += "ROR "; break; // Rotate Right
 			}
 			std::uint8_t shown = (immediate == 0) ? 32 : immediate;
-			mnemonic += print_literal(shown);
+			print_literal(mnemonic, shown);
 		}
 	}
 
-	return mnemonic;
 }
 
 /* ---  Format Dispatchers --- */
 
-td::InstructionData td::ArmDisasm::dispatch_arm(std::uint32_t pc, const std::uint32_t instr) const {
+td::InstrFormat td::ArmFieldDecoder::classify(const std::uint32_t instr) {
 	/*
 	|..3 ..................2 ..................1 ..................0|
 	|1_0_9_8_7_6_5_4_3_2_1_0_9_8_7_6_5_4_3_2_1_0_9_8_7_6_5_4_3_2_1_0|
@@ -109,63 +142,87 @@ td::InstructionData td::ArmDisasm::dispatch_arm(std::uint32_t pc, const std::uin
 	|__Cond_|1 1 1 0|Cp Op|L|__CRn__|__CRd__|__CP#__|__CP_|1|__CRm__| - Coprocessor Reguster Transfer
 	|__Cond_|1 1 1 1|_________________Comment Field_________________| - Software Interupt
 	*/
-	if ((instr & 0x0FFFFFF0) == 0x012FFF10) return dis_branch_exchange(pc, instr);
+	if ((instr & 0x0FFFFFF0) == 0x012FFF10) return InstrFormat::ArmBranchExchange;
 
 	uint8_t primary_type = (instr & 0x0E000000) >> 25;
 	switch (primary_type) {
 		case 0b000:
 			if ((instr & 0x000000F0) == 0x90) {
 				uint8_t op24 = (instr >> 23) & 0x3;
-				if (op24 == 0) return dis_mul_mla(pc, instr);
-				else if (op24 == 0b01) return dis_mul_mla_long(pc, instr);
-				else if (op24 == 0b10) return dis_single_data_swap(pc, instr);
-				break;
+				if (op24 == 0) return InstrFormat::ArmMul;
+				else if (op24 == 0b01) return InstrFormat::ArmMulLong;
+				else if (op24 == 0b10) return InstrFormat::ArmSingleDataSwap;
+				return InstrFormat::Invalid;
 			}
 			else if ((instr & 0x00000090) == 0x90) {
-				if ((instr & 0x00400000) != 0) return dis_halfword_data_trans_imm(pc, instr);
-				return dis_halfword_data_trans_reg(pc, instr);
+				if ((instr & 0x00400000) != 0) return InstrFormat::ArmHalfwordTransImm;
+				return InstrFormat::ArmHalfwordTransReg;
 			}
 			[[fallthrough]];
-		case 0b001:
-			return dispatch_data_proc_psr(pc, instr);
+		case 0b001: {
+			/*
+			|..3 ..................2 ..................1 ..................0|
+			|1_0_9_8_7_6_5_4_3_2_1_0_9_8_7_6_5_4_3_2_1_0_9_8_7_6_5_4_3_2_1_0|
+			|__Cond_|0 0 0 1 0|P|0 0 1 1 1 1|___Rd__|0 0 0 0 0 0 0 0 0 0 0 0| - MRS
+			|__Cond_|0 0 0 1 0|P|1 0 1 0 0 1 1 1 1 1 0 0 0 0 0 0 0 0|___Rm__| - MSR Register
+			|__Cond_|0 0|I|1 0|P|1 0 1 0 0 0 1 1 1 1|_____Source Operand____| - MSR Immediate
+			|__Cond_|0 0|I|___op__|s|___Rn__|___Rd__|_______Operand 2_______| - Datta Processing
+			*/
+			const std::uint32_t MRS_MASK = 0x0FBF0FFF, MRS_TEST = 0x010F0000;
+			const std::uint32_t MSR_R_MASK = 0x0FBFFFF0, MSR_R_TEST = 0x0129F000;
+			const std::uint32_t MSR_I_MASK = 0x0DBFF000, MSR_I_TEST = 0x0128F000;
+
+			if ((instr & MRS_MASK) == MRS_TEST) return InstrFormat::ArmPsrMrs;
+			if ((instr & MSR_R_MASK) == MSR_R_TEST) return InstrFormat::ArmPsrMsrReg;
+			if ((instr & MSR_I_MASK) == MSR_I_TEST) return InstrFormat::ArmPsrMsrImm;
+			return InstrFormat::ArmDataProc;
+		}
 		case 0b010:
 		case 0b011:
-			if (primary_type == 0b011 && (instr & 0x00000010) != 0) return { pc, instr, "Undefined.", false, 4, true, ModeEvent::None };
-			return dis_single_data_trans(pc, instr);
-		case 0b100: return dis_block_data_trans(pc, instr);
-		case 0b101: return dis_branch(pc, instr);
-		case 0b110: return { pc, instr, "Coprocessor Data Transfer unimplemented", false, 4, true, ModeEvent::None };
+			if (primary_type == 0b011 && (instr & 0x00000010) != 0) return InstrFormat::ArmUndefined;
+			return InstrFormat::ArmSingleDataTrans;
+		case 0b100: return InstrFormat::ArmBlockDataTrans;
+		case 0b101: return InstrFormat::ArmBranch;
+		case 0b110: return InstrFormat::ArmCoprocDataTrans;
 		case 0b111:
-			if ((instr & 0x01000000) != 0) return dis_swi(pc, instr);
-			if ((instr & 0x00000010) != 0) return { pc, instr, "Coprocessor Register Transfer unimplemented", false, 4, true, ModeEvent::None };
-			return { pc, instr, "Coprocessor Data Operation unimplemented", false, 4, true, ModeEvent::None };
+			if ((instr & 0x01000000) != 0) return InstrFormat::ArmSwi;
+			return (instr & 0x00000010) ? InstrFormat::ArmCoprocRegTrans : InstrFormat::ArmCoprocDataOp;
 	}
 
-	return { pc, instr, "Invalid instruction.", false, 4, false, ModeEvent::None };
+	return InstrFormat::Invalid;
 }
 
-td::InstructionData td::ArmDisasm::dispatch_data_proc_psr(std::uint32_t pc, const std::uint32_t instr) const {
-	/*
-	|..3 ..................2 ..................1 ..................0|
-	|1_0_9_8_7_6_5_4_3_2_1_0_9_8_7_6_5_4_3_2_1_0_9_8_7_6_5_4_3_2_1_0|
-	|__Cond_|0 0 0 1 0|P|0 0 1 1 1 1|___Rd__|0 0 0 0 0 0 0 0 0 0 0 0| - MRS
-	|__Cond_|0 0 0 1 0|P|1 0 1 0 0 1 1 1 1 1 0 0 0 0 0 0 0 0|___Rm__| - MSR Register
-	|__Cond_|0 0|I|___op__|s|___Rn__|___Rd__|_______Operand 2_______| - MSR Immediate
-	|__Cond_|0 0|I|1 0|P|1 0 1 0 0 0 1 1 1 1|_____Source Operand____| - Datta Processing
-	*/
-	const std::uint32_t MRS_MASK = 0x0FBF0FFF, MRS_TEST = 0x010F0000;
-	const std::uint32_t MSR_R_MASK = 0x0FBFFFF0, MSR_R_TEST = 0x0129F000;
-	const std::uint32_t MSR_I_MASK = 0x0DBFF000, MSR_I_TEST = 0x0128F000;
-
-	if ((instr & MRS_MASK) == MRS_TEST) return dis_psr_trans_MRS(pc, instr);
-	if ((instr & MSR_R_MASK) == MSR_R_TEST) return dis_psr_trans_MSR_reg(pc, instr);
-	if ((instr & MSR_I_MASK) == MSR_I_TEST) return dis_psr_trans_MSR_imm(pc, instr);
-	return dis_data_proc(pc, instr);
+template <typename Format>
+td::InstructionData td::BasicArmDisasm<Format>::dispatch_arm(std::uint32_t pc, const std::uint32_t instr) const {
+	switch (classify(instr)) {
+		case InstrFormat::ArmBranchExchange: return dis_branch_exchange(pc, instr);
+		case InstrFormat::ArmBranch: return dis_branch(pc, instr);
+		case InstrFormat::ArmDataProc: return dis_data_proc(pc, instr);
+		case InstrFormat::ArmPsrMrs: return dis_psr_trans_MRS(pc, instr);
+		case InstrFormat::ArmPsrMsrReg: return dis_psr_trans_MSR_reg(pc, instr);
+		case InstrFormat::ArmPsrMsrImm: return dis_psr_trans_MSR_imm(pc, instr);
+		case InstrFormat::ArmMul: return dis_mul_mla(pc, instr);
+		case InstrFormat::ArmMulLong: return dis_mul_mla_long(pc, instr);
+		case InstrFormat::ArmSingleDataTrans: return dis_single_data_trans(pc, instr);
+		case InstrFormat::ArmHalfwordTransReg: return dis_halfword_data_trans_reg(pc, instr);
+		case InstrFormat::ArmHalfwordTransImm: return dis_halfword_data_trans_imm(pc, instr);
+		case InstrFormat::ArmBlockDataTrans: return dis_block_data_trans(pc, instr);
+		case InstrFormat::ArmSingleDataSwap: return dis_single_data_swap(pc, instr);
+		case InstrFormat::ArmSwi: return dis_swi(pc, instr);
+		case InstrFormat::ArmUndefined: return { pc, instr, "Undefined.", false, 4, true, ModeEvent::None, InstrFormat::ArmUndefined };
+		case InstrFormat::ArmCoprocDataTrans:
+		case InstrFormat::ArmCoprocDataOp:
+		case InstrFormat::ArmCoprocRegTrans: return dis_coproc(pc, instr);
+		default: break;
+	}
+
+	return { pc, instr, "Invalid instruction.", false, 4, false, ModeEvent::None, InstrFormat::Invalid };
 }
 
 /* --- Format Decoders --- */
 
-td::InstructionData td::ArmDisasm::dis_branch_exchange(std::uint32_t pc, const std::uint32_t instr) const {
+template <typename Format>
+td::InstructionData td::BasicArmDisasm<Format>::dis_branch_exchange(std::uint32_t pc, const std::uint32_t instr) const {
 	/*
 	|..3 ..................2 ..................1 ..................0|
 	|1_0_9_8_7_6_5_4_3_2_1_0_9_8_7_6_5_4_3_2_1_0_9_8_7_6_5_4_3_2_1_0|
@@ -174,14 +231,15 @@ td::InstructionData td::ArmDisasm::dis_branch_exchange(std::uint32_t pc, const s
 	const uint8_t cond = (instr >> 28) & 0xF; // Bit 31-28
 	const uint8_t op_register = instr & 0xF;  // Bit 3-0
 
-	std::string mnemonic = "BX";
-	mnemonic += get_cond_suffix(cond) + " ";
+	Mnemonic mnemonic = "BX";
+	mnemonic.append(get_cond_suffix(cond), " ");
 	mnemonic += get_register_name(op_register);
 
-	return { pc, instr, mnemonic, false, 4, true, ModeEvent::BX };
+	return { pc, instr, mnemonic, false, 4, true, ModeEvent::BX, InstrFormat::ArmBranchExchange };
 }
 
-td::InstructionData td::ArmDisasm::dis_branch(std::uint32_t pc, const std::uint32_t instr) const {
+template <typename Format>
+td::InstructionData td::BasicArmDisasm<Format>::dis_branch(std::uint32_t pc, const std::uint32_t instr) const {
 	/*
 	|..3 ..................2 ..................1 ..................0|
 	|1_0_9_8_7_6_5_4_3_2_1_0_9_8_7_6_5_4_3_2_1_0_9_8_7_6_5_4_3_2_1_0|
@@ -191,17 +249,19 @@ td::InstructionData td::ArmDisasm::dis_branch(std::uint32_t pc, const std::uint3
 	bool link = (instr >> 24) & 0x1;                 // Bit 24
 	const std::uint32_t offset = instr & 0x00FFFFFF; // Bit 32-0
 
-	std::string mnemonic = "B";
+	Mnemonic mnemonic = "B";
 	if (link) mnemonic += "L";
-	mnemonic += get_cond_suffix(cond) + " ";
+	mnemonic.append(get_cond_suffix(cond), " ");
 
 	std::int32_t address = static_cast<std::int32_t>(offset << 8) >> 6; // Sign extend and shift left 2
-	mnemonic += print_literal(address + pc + 8);
+	const std::uint32_t target = address + pc + 8;
+	print_literal(mnemonic, target);
 
-	return { pc, instr, mnemonic, false, 4, true, ModeEvent::None };
+	return { pc, instr, mnemonic, false, 4, true, ModeEvent::None, InstrFormat::ArmBranch, target };
 }
 
-td::InstructionData td::ArmDisasm::dis_data_proc(std::uint32_t pc, const std::uint32_t instr) const {
+template <typename Format>
+td::InstructionData td::BasicArmDisasm<Format>::dis_data_proc(std::uint32_t pc, const std::uint32_t instr) const {
 	/*
 	|..3 ..................2 ..................1 ..................0|
 	|1_0_9_8_7_6_5_4_3_2_1_0_9_8_7_6_5_4_3_2_1_0_9_8_7_6_5_4_3_2_1_0|
@@ -220,7 +280,7 @@ td::InstructionData td::ArmDisasm::dis_data_proc(std::uint32_t pc, const std::ui
 		&& !set_con                      // S-bit clear
 		&& dest_register != 15;          // Rd is not PC
 
-	std::string mnemonic;
+	Mnemonic mnemonic;
 
 	if (is_adr) {
 		mnemonic += "ADR";
@@ -256,12 +316,13 @@ td::InstructionData td::ArmDisasm::dis_data_proc(std::uint32_t pc, const std::ui
 	}
 
 	if (opcode < 8 || opcode > 11)
-		mnemonic += get_register_name(dest_register) + ", ";
+		mnemonic.append(get_register_name(dest_register), ", ");
 
 	if ((opcode != 13 && opcode != 15) && !is_adr)
-		mnemonic += get_register_name(op1_register) + ", ";
+		mnemonic.append(get_register_name(op1_register), ", ");
 
 	// Operand 2
+	std::optional<std::uint32_t> target;
 	if (is_immediate) {
 		/*
 		|...1 .................0|
@@ -275,22 +336,24 @@ td::InstructionData td::ArmDisasm::dis_data_proc(std::uint32_t pc, const std::ui
 		if (is_adr) {
 			if (opcode == 4) literal = (pc + 8 + literal);
 			else literal = (pc + 8 - literal);
+			target = literal;
 		}
 
-		mnemonic += print_literal(literal);
+		print_literal(mnemonic, literal);
 	}
 	else {
-		mnemonic += build_shift_op(instr);
+		build_shift_op(mnemonic, instr);
 	}
 
 	ModeEvent event;
 	if (set_con && dest_register == 15)  event = ModeEvent::ExceptionReturn;
 	else event = ModeEvent::None;
 
-	return { pc, instr, mnemonic, false, 4, true, event };
+	return { pc, instr, mnemonic, false, 4, true, event, InstrFormat::ArmDataProc, target };
 }
 
-td::InstructionData td::ArmDisasm::dis_psr_trans_MRS(std::uint32_t pc, const std::uint32_t instr) const {
+template <typename Format>
+td::InstructionData td::BasicArmDisasm<Format>::dis_psr_trans_MRS(std::uint32_t pc, const std::uint32_t instr) const {
 	/*
 	|..3 ..................2 ..................1 ..................0|
 	|1_0_9_8_7_6_5_4_3_2_1_0_9_8_7_6_5_4_3_2_1_0_9_8_7_6_5_4_3_2_1_0|
@@ -300,15 +363,16 @@ td::InstructionData td::ArmDisasm::dis_psr_trans_MRS(std::uint32_t pc, const std
 	const bool source_psr = (instr >> 22) & 0x1;            // Bit 22
 	const std::uint8_t dest_register = (instr >> 12) & 0xF; // Bit 15-12
 
-	std::string mnemonic = "MRS";
-	mnemonic += get_cond_suffix(cond) + " ";
-	mnemonic += get_register_name(dest_register) + ", ";
+	Mnemonic mnemonic = "MRS";
+	mnemonic.append(get_cond_suffix(cond), " ");
+	mnemonic.append(get_register_name(dest_register), ", ");
 	mnemonic += (source_psr ? "SPSR" : "CPSR");
 
-	return { pc, instr, mnemonic, false, 4, true, ModeEvent::None };
+	return { pc, instr, mnemonic, false, 4, true, ModeEvent::None, InstrFormat::ArmPsrMrs };
 }
 
-td::InstructionData td::ArmDisasm::dis_psr_trans_MSR_reg(std::uint32_t pc, const std::uint32_t instr) const {
+template <typename Format>
+td::InstructionData td::BasicArmDisasm<Format>::dis_psr_trans_MSR_reg(std::uint32_t pc, const std::uint32_t instr) const {
 	/*
 	|..3 ..................2 ..................1 ..................0|
 	|1_0_9_8_7_6_5_4_3_2_1_0_9_8_7_6_5_4_3_2_1_0_9_8_7_6_5_4_3_2_1_0|
@@ -318,15 +382,16 @@ td::InstructionData td::ArmDisasm::dis_psr_trans_MSR_reg(std::uint32_t pc, const
 	const bool dest_psr = (instr >> 22) & 0x1;     // Bit 22
 	const std::uint8_t src_register = instr & 0xF; // Bit 3-0
 
-	std::string mnemonic = "MSR";
-	mnemonic += get_cond_suffix(cond) + " ";
-	mnemonic += std::string(dest_psr ? "SPSR" : "CPSR") + ", ";
+	Mnemonic mnemonic = "MSR";
+	mnemonic.append(get_cond_suffix(cond), " ");
+	mnemonic.append((dest_psr ? "SPSR" : "CPSR"), ", ");
 	mnemonic += get_register_name(src_register);
 
-	return { pc, instr, mnemonic, false, 4, true, ModeEvent::None };
+	return { pc, instr, mnemonic, false, 4, true, ModeEvent::None, InstrFormat::ArmPsrMsrReg };
 }
 
-td::InstructionData td::ArmDisasm::dis_psr_trans_MSR_imm(std::uint32_t pc, const std::uint32_t instr) const {
+template <typename Format>
+td::InstructionData td::BasicArmDisasm<Format>::dis_psr_trans_MSR_imm(std::uint32_t pc, const std::uint32_t instr) const {
 	/*
 	|..3 ..................2 ..................1 ..................0|
 	|1_0_9_8_7_6_5_4_3_2_1_0_9_8_7_6_5_4_3_2_1_0_9_8_7_6_5_4_3_2_1_0|
@@ -336,9 +401,9 @@ td::InstructionData td::ArmDisasm::dis_psr_trans_MSR_imm(std::uint32_t pc, const
 	const bool is_immediate = (instr >> 25) & 0x1; // Bit 25
 	const bool dest_psr = (instr >> 22) & 0x1;     // Bit 22
 
-	std::string mnemonic = "MSR";
-	mnemonic += get_cond_suffix(cond) + " ";
-	mnemonic += (dest_psr ? "SPSR_flg " : "CPSR_flg ");
+	Mnemonic mnemonic = "MSR";
+	mnemonic.append(get_cond_suffix(cond), " ");
+	mnemonic += (dest_psr ? "SPSR_flg, " : "CPSR_flg, ");
 
 	// Source Operand
 	if (is_immediate) {
@@ -351,7 +416,7 @@ td::InstructionData td::ArmDisasm::dis_psr_trans_MSR_imm(std::uint32_t pc, const
 		const std::uint8_t immediate = instr & 0xFF;    // Bit 7-0
 
 		std::uint32_t literal = rotr32(immediate, rotate * 2);
-		mnemonic += print_literal(literal);
+		print_literal(mnemonic, literal);
 	}
 	else {
 		const std::uint8_t src_register = instr & 0xF; // Bit 3-0
@@ -359,10 +424,11 @@ td::InstructionData td::ArmDisasm::dis_psr_trans_MSR_imm(std::uint32_t pc, const
 		mnemonic += get_register_name(src_register);
 	}
 
-	return {pc, instr, mnemonic, false, 4, true, ModeEvent::None };
+	return {pc, instr, mnemonic, false, 4, true, ModeEvent::None, InstrFormat::ArmPsrMsrImm };
 }
 
-td::InstructionData td::ArmDisasm::dis_mul_mla(std::uint32_t pc, const std::uint32_t instr) const {
+template <typename Format>
+td::InstructionData td::BasicArmDisasm<Format>::dis_mul_mla(std::uint32_t pc, const std::uint32_t instr) const {
 	/*
 	|..3 ..................2 ..................1 ..................0|
 	|1_0_9_8_7_6_5_4_3_2_1_0_9_8_7_6_5_4_3_2_1_0_9_8_7_6_5_4_3_2_1_0|
@@ -376,18 +442,19 @@ td::InstructionData td::ArmDisasm::dis_mul_mla(std::uint32_t pc, const std::uint
 	const std::uint8_t op2_register = (instr >> 8) & 0xF;   // Bit 11-8
 	const std::uint8_t op3_register = instr & 0xF;          // Bit 3-0
 
-	std::string mnemonic = (accumulate ? "MLA" : "MUL");
+	Mnemonic mnemonic = (accumulate ? "MLA" : "MUL");
 	mnemonic += get_cond_suffix(cond);
 	mnemonic += (set_con ? "S " : " ");
-	mnemonic += get_register_name(dest_register) + ", ";
-	mnemonic += get_register_name(op3_register) + ", ";
+	mnemonic.append(get_register_name(dest_register), ", ");
+	mnemonic.append(get_register_name(op3_register), ", ");
 	mnemonic += get_register_name(op2_register);
-	if (accumulate) mnemonic += ", " + get_register_name(op1_register);
+	if (accumulate) mnemonic.append(", ", get_register_name(op1_register));
 
-	return { pc, instr, mnemonic, false, 4, true, ModeEvent::None };
+	return { pc, instr, mnemonic, false, 4, true, ModeEvent::None, InstrFormat::ArmMul };
 }
 
-td::InstructionData td::ArmDisasm::dis_mul_mla_long (std::uint32_t pc, const std::uint32_t instr) const {
+template <typename Format>
+td::InstructionData td::BasicArmDisasm<Format>::dis_mul_mla_long(std::uint32_t pc, const std::uint32_t instr) const {
 	/*
 	|..3 ..................2 ..................1 ..................0|
 	|1_0_9_8_7_6_5_4_3_2_1_0_9_8_7_6_5_4_3_2_1_0_9_8_7_6_5_4_3_2_1_0|
@@ -402,19 +469,20 @@ td::InstructionData td::ArmDisasm::dis_mul_mla_long (std::uint32_t pc, const std
 	const std::uint8_t op1_register = (instr >> 8) & 0xF;        // Bit 11-8
 	const std::uint8_t op2_register = instr & 0xF;               // Bit 3-0
 
-	std::string mnemonic = (is_unsigned ? "S" : "U");
+	Mnemonic mnemonic = (is_unsigned ? "S" : "U");
 	mnemonic += (accumulate ? "MLAL" : "MULL");
 	mnemonic += get_cond_suffix(cond);
 	mnemonic += (set_flags ? "S " : " ");
-	mnemonic += get_register_name(dest_register_low) + ", ";
-	mnemonic += get_register_name(dest_register_high) + ", ";
-	mnemonic += get_register_name(op2_register) + ", ";
+	mnemonic.append(get_register_name(dest_register_low), ", ");
+	mnemonic.append(get_register_name(dest_register_high), ", ");
+	mnemonic.append(get_register_name(op2_register), ", ");
 	mnemonic += get_register_name(op1_register);
 
-	return { pc, instr, mnemonic, false, 4, true, ModeEvent::None };
+	return { pc, instr, mnemonic, false, 4, true, ModeEvent::None, InstrFormat::ArmMulLong };
 }
 
-td::InstructionData td::ArmDisasm::dis_single_data_trans(std::uint32_t pc, const std::uint32_t instr) const {
+template <typename Format>
+td::InstructionData td::BasicArmDisasm<Format>::dis_single_data_trans(std::uint32_t pc, const std::uint32_t instr) const {
 	/*
 	|..3 ..................2 ..................1 ..................0|
 	|1_0_9_8_7_6_5_4_3_2_1_0_9_8_7_6_5_4_3_2_1_0_9_8_7_6_5_4_3_2_1_0|
@@ -430,74 +498,57 @@ td::InstructionData td::ArmDisasm::dis_single_data_trans(std::uint32_t pc, const
 	const std::uint8_t base_register = (instr >> 16) & 0xF;   // Bit 19-16
 	const std::uint8_t target_register = (instr >> 12) & 0xF; // Bit 15-12
 
-	std::string mnemonic = (is_load ? "LDR" : "STR");
+	Mnemonic mnemonic = (is_load ? "LDR" : "STR");
 	mnemonic += get_cond_suffix(cond);
 	if (transfer_byte) mnemonic += "B";
-	if (transfer_byte && !pre_index)  mnemonic += 'T';
-	mnemonic += " " + get_register_name(target_register) + ", ";
+	if (!pre_index && write_back) mnemonic += 'T'; // Post-indexed W forces a user mode access
+	mnemonic.append(" ", get_register_name(target_register), ", ");
 
-	std::string address;
 	if (is_register) {
 		/*
 		|...1 .................0|
 		|1_0_9_8_7_6_5_4_3_2_1_0|
 		|__shift__|_ST|0|___Rm__|
 		*/
-		const uint8_t shift_type = (instr >> 5) & 0x3;    // Bit 6-5
-		const uint8_t shift_amount = (instr >> 7) & 0x1F; // Bit 4
-		const uint8_t offset_register = instr & 0xF;      // Bit 3-0
-
-		const bool offset_zero = (shift_type == 0) &&
-						     	 (shift_amount == 0) &&
-							     (offset_register == 0) &&
-								 (add_offset == 1);
-		std::string offset = build_shift_op(instr);
-
 		if (pre_index) {
-			address = "[" + get_register_name(base_register);
-			if (!offset_zero) {
-				address += ", ";
-				if (!add_offset) address += "-";
-				address += offset;
-			}
-			address += "]";
-			if (write_back) address += "!";
+			mnemonic.append("[", get_register_name(base_register), ", ");
+			if (!add_offset) mnemonic += "-";
+			build_shift_op(mnemonic, instr);
+			mnemonic += "]";
+			if (write_back) mnemonic += "!";
 		}
 		else {
-			address = "[" + get_register_name(base_register) + "]";
-			if (!offset_zero) {
-				address += ", ";
-				if (!add_offset) address += "-";
-				address += offset;
-			}
+			mnemonic.append("[", get_register_name(base_register), "], ");
+			if (!add_offset) mnemonic += "-";
+			build_shift_op(mnemonic, instr);
 		}
 	}else {
 		const std::uint16_t immediate = instr & 0xFFF; // Bit 11-0
 
 		if (pre_index) {
-			address = "[" + get_register_name(base_register);
+			mnemonic.append("[", get_register_name(base_register));
 			if (immediate != 0) {
-				address += ", #";
-				if (!add_offset) address += "-";
-				address += print_literal(immediate, false);
+				mnemonic += ", #";
+				if (!add_offset) mnemonic += "-";
+				print_literal(mnemonic, immediate, false);
 			}
-			address += "]";
-			if (write_back) address += "!";
+			mnemonic += "]";
+			if (write_back) mnemonic += "!";
 		} else {
-			address = "[" + get_register_name(base_register) + "]";
+			mnemonic.append("[", get_register_name(base_register), "]");
 			if (immediate != 0) {
-				address += ", #";
-				if (!add_offset) address += "-";
-				address += print_literal(immediate, false);
+				mnemonic += ", #";
+				if (!add_offset) mnemonic += "-";
+				print_literal(mnemonic, immediate, false);
 			}
 		}
 	}
-	mnemonic += address;
 
-	return { pc, instr, mnemonic, false, 4, true, ModeEvent::None };
+	return { pc, instr, mnemonic, false, 4, true, ModeEvent::None, InstrFormat::ArmSingleDataTrans };
 }
 
-td::InstructionData td::ArmDisasm::dis_halfword_data_trans_reg(std::uint32_t pc, const std::uint32_t instr) const {
+template <typename Format>
+td::InstructionData td::BasicArmDisasm<Format>::dis_halfword_data_trans_reg(std::uint32_t pc, const std::uint32_t instr) const {
 	/*
 	|..3 ..................2 ..................1 ..................0|
 	|1_0_9_8_7_6_5_4_3_2_1_0_9_8_7_6_5_4_3_2_1_0_9_8_7_6_5_4_3_2_1_0|
@@ -514,43 +565,34 @@ td::InstructionData td::ArmDisasm::dis_halfword_data_trans_reg(std::uint32_t pc,
 	const std::uint8_t offset_register = instr & 0xF;         // Bit 3-0
 
 	// SH=0b10 and SH=0b11 is only valid during load operations
-	if (!is_load && (sh == 2 || sh == 3)) return { pc, instr, "Invalid instruction", false, 4, false, ModeEvent::None };
+	if (!is_load && (sh == 2 || sh == 3)) return { pc, instr, "Invalid instruction", false, 4, false, ModeEvent::None, InstrFormat::ArmHalfwordTransReg };
 
-	std::string mnemonic = (is_load ? "LDR" : "STR");
+	Mnemonic mnemonic = (is_load ? "LDR" : "STR");
 	switch (sh) {
 		case 1: mnemonic += "H"; break;               // Transfer halfword
 		case 2: if (is_load) mnemonic += "SB"; break; // Load sign extended byte
 		case 3: if (is_load) mnemonic += "SH"; break; // Load sign extended halfword
 	}
-	mnemonic += get_cond_suffix(cond) + " ";
+	mnemonic.append(get_cond_suffix(cond), " ");
 
-	mnemonic += get_register_name(target_register) + ", ";
+	mnemonic.append(get_register_name(target_register), ", ");
 
-	bool omit_offset = (offset_register == 0) && add_offset;
-	std::string address;
 	if (pre_index) {
-		address = "[" + get_register_name(base_register);
-		if (!omit_offset) {
-			address += ", ";
-			if (!add_offset) address += "-";
-			address += get_register_name(offset_register);
-		}
-		address += "]";
-		if (write_back) address += "!";
+		mnemonic.append("[", get_register_name(base_register), ", ");
+		if (!add_offset) mnemonic += "-";
+		mnemonic.append(get_register_name(offset_register), "]");
+		if (write_back) mnemonic += "!";
 	} else {
-		address = "[" + get_register_name(base_register) + "]";
-		if (!omit_offset) {
-			address += ", ";
-			if (!add_offset) address += "-";
-			address += get_register_name(offset_register);
-		}
+		mnemonic.append("[", get_register_name(base_register), "], ");
+		if (!add_offset) mnemonic += "-";
+		mnemonic += get_register_name(offset_register);
 	}
-	mnemonic += address;
 
-	return { pc, instr, mnemonic, false, 4, true, ModeEvent::None };
+	return { pc, instr, mnemonic, false, 4, true, ModeEvent::None, InstrFormat::ArmHalfwordTransReg };
 }
 
-td::InstructionData td::ArmDisasm::dis_halfword_data_trans_imm(std::uint32_t pc, const std::uint32_t instr) const {
+template <typename Format>
+td::InstructionData td::BasicArmDisasm<Format>::dis_halfword_data_trans_imm(std::uint32_t pc, const std::uint32_t instr) const {
 	/*
 	|..3 ..................2 ..................1 ..................0|
 	|1_0_9_8_7_6_5_4_3_2_1_0_9_8_7_6_5_4_3_2_1_0_9_8_7_6_5_4_3_2_1_0|
@@ -569,44 +611,43 @@ td::InstructionData td::ArmDisasm::dis_halfword_data_trans_imm(std::uint32_t pc,
 	const std::uint8_t offset = (offset_high << 4) | offset_low;
 
 	// SH=0b10 and SH=0b11 is only valid during load operations
-	if (!is_load && (sh == 2 || sh == 3)) return { pc, instr, "Invalid instruction.", false, 4, false, ModeEvent::None };
+	if (!is_load && (sh == 2 || sh == 3)) return { pc, instr, "Invalid instruction.", false, 4, false, ModeEvent::None, InstrFormat::ArmHalfwordTransImm };
 
-	std::string mnemonic = (is_load ? "LDR" : "STR");
+	Mnemonic mnemonic = (is_load ? "LDR" : "STR");
 	switch (sh) {
 		case 1: mnemonic += "H"; break;               // Transfer halfword
 		case 2: if (is_load) mnemonic += "SB"; break; // Load sign extended byte
 		case 3: if (is_load) mnemonic += "SH"; break; // Load sign extended halfword
 	}
-	mnemonic += get_cond_suffix(cond) + " ";
+	mnemonic.append(get_cond_suffix(cond), " ");
 
-	mnemonic += get_register_name(target_register) + ", ";
+	mnemonic.append(get_register_name(target_register), ", ");
 
 	bool omitOffset = (offset == 0) && add_offset;
-	std::string address;
 	if (pre_index) {
-		address = "[" + get_register_name(base_register);
+		mnemonic.append("[", get_register_name(base_register));
 		if (!omitOffset) {
-			address += ", #";
-			if (!add_offset) address += "-";
-			address += print_literal(offset, false);
+			mnemonic += ", #";
+			if (!add_offset) mnemonic += "-";
+			print_literal(mnemonic, offset, false);
 		}
-		address += "]";
-		if (write_back) address += "!";
+		mnemonic += "]";
+		if (write_back) mnemonic += "!";
 	}
 	else {
-		address = "[" + get_register_name(base_register) + "]";
+		mnemonic.append("[", get_register_name(base_register), "]");
 		if (!omitOffset) {
-			address += ", #";
-			if (!add_offset) address += "-";
-			address += print_literal(offset, false);
+			mnemonic += ", #";
+			if (!add_offset) mnemonic += "-";
+			print_literal(mnemonic, offset, false);
 		}
 	}
-	mnemonic += address;
 
-	return { pc, instr, mnemonic, false, 4, true, ModeEvent::None };
+	return { pc, instr, mnemonic, false, 4, true, ModeEvent::None, InstrFormat::ArmHalfwordTransImm };
 }
 
-td::InstructionData td::ArmDisasm::dis_block_data_trans(std::uint32_t pc, const std::uint32_t instr) const {
+template <typename Format>
+td::InstructionData td::BasicArmDisasm<Format>::dis_block_data_trans(std::uint32_t pc, const std::uint32_t instr) const {
 	/*
 	|..3 ..................2 ..................1 ..................0|
 	|1_0_9_8_7_6_5_4_3_2_1_0_9_8_7_6_5_4_3_2_1_0_9_8_7_6_5_4_3_2_1_0|
@@ -621,7 +662,7 @@ td::InstructionData td::ArmDisasm::dis_block_data_trans(std::uint32_t pc, const
 	const std::uint8_t base_register = (instr >> 16) & 0xF; // Bit 19-16
 	const std::uint16_t register_list = instr & 0xFFFF;     // Bit 15-0
 
-	std::string mnemonic = (is_load ? "LDM" : "STM");
+	Mnemonic mnemonic = (is_load ? "LDM" : "STM");
 	
 	std::uint8_t mode = (static_cast<std::uint8_t>(pre_index) << 1) | static_cast<std::uint8_t>(add_offset);
 	switch (mode) {
@@ -631,11 +672,13 @@ td::InstructionData td::ArmDisasm::dis_block_data_trans(std::uint32_t pc, const
 		case 0b11: mnemonic += "IB"; break; // // Pre-Increment
 	}
 
-	mnemonic += get_cond_suffix(cond) + " ";
+	mnemonic.append(get_cond_suffix(cond), " ");
 	mnemonic += get_register_name(base_register);
 	if (write_back) mnemonic += "!";
 
-	mnemonic += ", {" + print_register_list(register_list, 16) + "}";
+	mnemonic += ", {";
+	print_register_list(mnemonic, register_list, 16);
+	mnemonic += "}";
 	if (load_psr) mnemonic += "^";
 
 	ModeEvent event;
@@ -643,10 +686,11 @@ td::InstructionData td::ArmDisasm::dis_block_data_trans(std::uint32_t pc, const
 	if (is_load && load_psr && restore_cpsr)  event = ModeEvent::ExceptionReturn;
 	else event = ModeEvent::None;
 
-	return { pc, instr, mnemonic, false, 4, true, event };
+	return { pc, instr, mnemonic, false, 4, true, event, InstrFormat::ArmBlockDataTrans };
 }
 
-td::InstructionData td::ArmDisasm::dis_single_data_swap(std::uint32_t pc, const std::uint32_t instr) const {
+template <typename Format>
+td::InstructionData td::BasicArmDisasm<Format>::dis_single_data_swap(std::uint32_t pc, const std::uint32_t instr) const {
 	/*
 	|..3 ..................2 ..................1 ..................0|
 	|1_0_9_8_7_6_5_4_3_2_1_0_9_8_7_6_5_4_3_2_1_0_9_8_7_6_5_4_3_2_1_0|
@@ -658,17 +702,18 @@ td::InstructionData td::ArmDisasm::dis_single_data_swap(std::uint32_t pc, const
 	const std::uint8_t dest_register = (instr >> 12) & 0xF; // Bit 15-12
 	const std::uint8_t source_register = instr & 0xF;       // Bit 3-0
 
-	std::string mnemonic = "SWP";
+	Mnemonic mnemonic = "SWP";
 	mnemonic += get_cond_suffix(cond);
 	mnemonic += (is_byte ? "B " : " ");
-	mnemonic += get_register_name(dest_register) + ", ";
-	mnemonic += get_register_name(source_register) + ", ";
-	mnemonic += "[" + get_register_name(base_register) + "]";
+	mnemonic.append(get_register_name(dest_register), ", ");
+	mnemonic.append(get_register_name(source_register), ", ");
+	mnemonic.append("[", get_register_name(base_register), "]");
 
-	return { pc, instr, mnemonic, false, 4, true, ModeEvent::None };
+	return { pc, instr, mnemonic, false, 4, true, ModeEvent::None, InstrFormat::ArmSingleDataSwap };
 }
 
-td::InstructionData td::ArmDisasm::dis_swi(std::uint32_t pc, const std::uint32_t instr) const {
+template <typename Format>
+td::InstructionData td::BasicArmDisasm<Format>::dis_swi(std::uint32_t pc, const std::uint32_t instr) const {
 	/*
 	|..3 ..................2 ..................1 ..................0|
 	|1_0_9_8_7_6_5_4_3_2_1_0_9_8_7_6_5_4_3_2_1_0_9_8_7_6_5_4_3_2_1_0|
@@ -677,9 +722,291 @@ td::InstructionData td::ArmDisasm::dis_swi(std::uint32_t pc, const std::uint32_t
 	const std::uint8_t cond = (instr >> 28) & 0xF;    // Bit 31-28
 	const std::uint32_t comment = instr & 0x00FFFFFF; // Bit 23-0
 
-	std::string mnemonic = "SWI";
-	mnemonic += get_cond_suffix(cond) + " ";
-	mnemonic += print_literal(comment);
+	Mnemonic mnemonic = "SWI";
+	mnemonic.append(get_cond_suffix(cond), " ");
+	print_literal(mnemonic, comment);
+
+	return { pc, instr, mnemonic, false, 4, true, ModeEvent::None, InstrFormat::ArmSwi };
+}
+
+namespace {
+	/*
+	Operands of the coprocessor formats in the order they are written, separated by ", ":
+	  Cp coprocessor number     Op1/Op2 coprocessor opcodes (Op2 omitted when zero)
+	  Crd/Crn/Crm coprocessor registers    Rd ARM register    Addr LDC/STC address
+	*/
+	enum class CoprocField : std::uint8_t { Cp, Op1, Op2, Crd, Crn, Crm, Rd, Addr };
+
+	struct CoprocSyntax {
+		std::uint32_t mask;
+		std::uint32_t test;
+		td::InstrFormat format;
+		const char* store_name; // L = 0
+		const char* load_name;  // L = 1
+		std::uint8_t field_count;
+		CoprocField fields[6];
+	};
+
+	constexpr std::string_view DECIMAL[16] = {
+		"0", "1", "2", "3", "4", "5", "6", "7", "8", "9", "10", "11", "12", "13", "14", "15"
+	};
+
+	constexpr CoprocSyntax COPROC_SYNTAX[] = {
+		{ 0x0E000000, 0x0C000000, td::InstrFormat::ArmCoprocDataTrans, "STC", "LDC", 3, { CoprocField::Cp, CoprocField::Crd, CoprocField::Addr } },
+		{ 0x0F000010, 0x0E000000, td::InstrFormat::ArmCoprocDataOp,    "CDP", "CDP", 6, { CoprocField::Cp, CoprocField::Op1, CoprocField::Crd, CoprocField::Crn, CoprocField::Crm, CoprocField::Op2 } },
+		{ 0x0F000010, 0x0E000010, td::InstrFormat::ArmCoprocRegTrans,  "MCR", "MRC", 6, { CoprocField::Cp, CoprocField::Op1, CoprocField::Rd, CoprocField::Crn, CoprocField::Crm, CoprocField::Op2 } },
+	};
+}
+
+template <typename Format>
+td::InstructionData td::BasicArmDisasm<Format>::dis_coproc(std::uint32_t pc, const std::uint32_t instr) const {
+	/*
+	|..3 ..................2 ..................1 ..................0|
+	|1_0_9_8_7_6_5_4_3_2_1_0_9_8_7_6_5_4_3_2_1_0_9_8_7_6_5_4_3_2_1_0|
+	|__Cond_|1 1 0|P|U|N|W|L|___Rn__|__CRd__|__CP#__|_____Offset____| - Coprocessor Data Transfer
+	|__Cond_|1 1 1 0|_Cp Op_|__CRn__|__CRd__|__CP#__|__CP_|0|__CRm__| - Coprocessor Data Operation
+	|__Cond_|1 1 1 0|CoprocField::Cp Op|L|__CRn__|__CRd__|__CP#__|__CP_|1|__CRm__| - Coprocessor Register Transfer
+	*/
+	const CoprocSyntax* syntax = nullptr;
+	for (const CoprocSyntax& candidate : COPROC_SYNTAX) {
+		if ((instr & candidate.mask) == candidate.test) { syntax = &candidate; break; }
+	}
+	if (!syntax) return { pc, instr, "Invalid instruction.", false, 4, false, ModeEvent::None, InstrFormat::Invalid };
+
+	const CoprocOperands op = extract_coproc_operands(instr);
+	const bool is_transfer = syntax->format == InstrFormat::ArmCoprocDataTrans;
 
-	return { pc, instr, mnemonic, false, 4, true, ModeEvent::None };
+	Mnemonic mnemonic = (op.is_load && syntax->format != InstrFormat::ArmCoprocDataOp) ? syntax->load_name : syntax->store_name;
+	mnemonic += get_cond_suffix(op.cond);
+	if (is_transfer && op.long_transfer) mnemonic += "L";
+	mnemonic += " ";
+
+	for (std::uint8_t i = 0; i < syntax->field_count; ++i) {
+		const CoprocField field = syntax->fields[i];
+		if (field == CoprocField::Op2) {
+			if (op.opcode2 != 0) mnemonic.append(", ", DECIMAL[op.opcode2]);
+			continue;
+		}
+		if (i != 0) mnemonic += ", ";
+
+		switch (field) {
+			case CoprocField::Cp: mnemonic.append("p", DECIMAL[op.cp_num]); break;
+			case CoprocField::Op1: mnemonic += DECIMAL[op.opcode1]; break;
+			case CoprocField::Crd: mnemonic.append("c", DECIMAL[op.crd]); break;
+			case CoprocField::Crn: mnemonic.append("c", DECIMAL[op.crn]); break;
+			case CoprocField::Crm: mnemonic.append("c", DECIMAL[op.crm]); break;
+			case CoprocField::Rd: mnemonic += get_register_name(op.crd); break;
+			case CoprocField::Addr: {
+				const std::uint16_t offset = static_cast<std::uint16_t>(op.offset) << 2;
+
+				mnemonic.append("[", get_register_name(op.crn));
+				if (!op.pre_index) mnemonic += "]";
+				if (offset != 0 || !op.add_offset) {
+					mnemonic += ", #";
+					if (!op.add_offset) mnemonic += "-";
+					print_literal(mnemonic, offset, false);
+				}
+				if (op.pre_index) {
+					mnemonic += "]";
+					if (op.write_back) mnemonic += "!";
+				}
+				break;
+			}
+			case CoprocField::Op2: break;
+		}
+	}
+
+	// The GBA's ARM7TDMI has no coprocessors attached, so every one of these takes the undefined
+	// instruction trap. They are rendered in full but reported invalid so the mode probe and data
+	// heuristics can reject the words that produced them.
+	return { pc, instr, mnemonic, false, 4, false, ModeEvent::None, syntax->format };
+}
+
+/* --- Structured Decoding --- */
+
+void td::ArmFieldDecoder::extract_fields(const std::uint32_t instr, DecodedFields& fields) {
+	// Fixed-position nibbles shared by most formats; complete_fields moves or clears them per format.
+	fields.format = classify(instr);
+	fields.cond = (instr >> 28) & 0xF; // Bit 31-28
+	fields.rn = (instr >> 16) & 0xF;   // Bit 19-16
+	fields.rd = (instr >> 12) & 0xF;   // Bit 15-12
+	fields.rs = (instr >> 8) & 0xF;    // Bit 11-8
+	fields.rm = instr & 0xF;           // Bit 3-0
 }
+
+void td::ArmFieldDecoder::complete_fields(std::uint32_t pc, const std::uint32_t instr, DecodedFields& fields) {
+	constexpr std::uint8_t NONE = 0xFF;
+
+	const bool bit25 = (instr >> 25) & 0x1;
+	const bool pre_index = (instr >> 24) & 0x1;
+	const bool add_offset = (instr >> 23) & 0x1;
+	const bool bit22 = (instr >> 22) & 0x1;
+	const bool write_back = (instr >> 21) & 0x1;
+	const bool bit20 = (instr >> 20) & 0x1;
+
+	// Addressing flags of the load/store formats
+	std::uint16_t addressing = DecodeFlag::Valid;
+	if (pre_index) addressing |= DecodeFlag::PreIndex;
+	if (add_offset) addressing |= DecodeFlag::AddOffset;
+	if (write_back) addressing |= DecodeFlag::WriteBack;
+	if (bit20) addressing |= DecodeFlag::Load;
+
+	fields.opcode = 0;
+	fields.flags = DecodeFlag::Valid;
+	fields.imm = 0;
+
+	switch (fields.format) {
+		case InstrFormat::ArmBranchExchange:
+			fields.rd = fields.rn = fields.rs = NONE;
+			fields.flags |= DecodeFlag::BranchExchange;
+			break;
+		case InstrFormat::ArmBranch: {
+			const std::int32_t offset = static_cast<std::int32_t>((instr & 0x00FFFFFF) << 8) >> 6;
+			fields.rd = fields.rn = fields.rs = fields.rm = NONE;
+			fields.imm = offset + pc + 8;
+			fields.flags |= DecodeFlag::HasTarget;
+			if ((instr >> 24) & 0x1) fields.flags |= DecodeFlag::Link;
+			break;
+		}
+		case InstrFormat::ArmDataProc:
+			fields.opcode = (instr >> 21) & 0xF;
+			if (fields.opcode == 13 || fields.opcode == 15) fields.rn = NONE; // MOV, MVN
+			if (fields.opcode >= 8 && fields.opcode <= 11) fields.rd = NONE;  // TST, TEQ, CMP, CMN
+			if (bit20) fields.flags |= DecodeFlag::SetFlags;
+			if (bit20 && ((instr >> 12) & 0xF) == 15) fields.flags |= DecodeFlag::ExceptionReturn;
+			if (bit25) {
+				fields.imm = rotr32(instr & 0xFF, ((instr >> 8) & 0xF) * 2);
+				fields.rs = fields.rm = NONE;
+				fields.flags |= DecodeFlag::Immediate;
+			}
+			else {
+				fields.imm = (instr >> 4) & 0xFF; // Shift field
+				if (!(instr & 0x10)) fields.rs = NONE;
+			}
+			break;
+		case InstrFormat::ArmPsrMrs:
+			fields.opcode = bit22;
+			fields.rn = fields.rs = fields.rm = NONE;
+			break;
+		case InstrFormat::ArmPsrMsrReg:
+			fields.opcode = bit22;
+			fields.rd = fields.rn = fields.rs = NONE;
+			break;
+		case InstrFormat::ArmPsrMsrImm:
+			fields.opcode = bit22;
+			fields.rd = fields.rn = fields.rs = NONE;
+			if (bit25) {
+				fields.imm = rotr32(instr & 0xFF, ((instr >> 8) & 0xF) * 2);
+				fields.rm = NONE;
+				fields.flags |= DecodeFlag::Immediate;
+			}
+			break;
+		case InstrFormat::ArmMul: {
+			const std::uint8_t accumulate_register = fields.rd;
+			fields.opcode = write_back; // A
+			fields.rd = fields.rn;
+			fields.rn = write_back ? accumulate_register : NONE;
+			if (bit20) fields.flags |= DecodeFlag::SetFlags;
+			break;
+		}
+		case InstrFormat::ArmMulLong:
+			fields.opcode = (bit22 << 1) | write_back; // U, A; rd = RdLo and rn = RdHi as encoded
+			if (bit20) fields.flags |= DecodeFlag::SetFlags;
+			break;
+		case InstrFormat::ArmSingleDataTrans:
+			fields.flags = addressing;
+			if (bit22) fields.flags |= DecodeFlag::Byte;
+			fields.rs = NONE;
+			if (bit25) {
+				fields.imm = (instr >> 4) & 0xFF; // Shift field
+			}
+			else {
+				fields.imm = instr & 0xFFF;
+				fields.rm = NONE;
+				fields.flags |= DecodeFlag::Immediate;
+			}
+			break;
+		case InstrFormat::ArmHalfwordTransReg:
+		case InstrFormat::ArmHalfwordTransImm:
+			fields.opcode = (instr >> 5) & 0x3; // SH
+			fields.flags = addressing;
+			fields.rs = NONE;
+			if (fields.format == InstrFormat::ArmHalfwordTransImm) {
+				fields.imm = ((instr >> 4) & 0xF0) | (instr & 0xF);
+				fields.rm = NONE;
+				fields.flags |= DecodeFlag::Immediate;
+			}
+			if (!bit20 && fields.opcode >= 2) fields.flags &= ~DecodeFlag::Valid;
+			break;
+		case InstrFormat::ArmBlockDataTrans:
+			fields.flags = addressing;
+			fields.rd = fields.rs = fields.rm = NONE;
+			fields.imm = instr & 0xFFFF;
+			if (bit22) fields.flags |= DecodeFlag::SetFlags;
+			if (bit20 && bit22 && (instr & 0x8000)) fields.flags |= DecodeFlag::ExceptionReturn;
+			break;
+		case InstrFormat::ArmSingleDataSwap:
+			fields.rs = NONE;
+			if (bit22) fields.flags |= DecodeFlag::Byte;
+			break;
+		case InstrFormat::ArmSwi:
+			fields.rd = fields.rn = fields.rs = fields.rm = NONE;
+			fields.imm = instr & 0x00FFFFFF;
+			break;
+		case InstrFormat::ArmCoprocDataTrans:
+		case InstrFormat::ArmCoprocDataOp:
+		case InstrFormat::ArmCoprocRegTrans: {
+			const CoprocOperands op = extract_coproc_operands(instr);
+			fields.opcode = op.opcode1;
+			if (fields.format == InstrFormat::ArmCoprocDataTrans) {
+				fields.flags = addressing;
+				fields.imm = static_cast<std::uint32_t>(op.offset) << 2;
+				fields.rm = NONE;
+			}
+			else {
+				fields.imm = op.opcode2;
+				if (fields.format == InstrFormat::ArmCoprocRegTrans && op.is_load) fields.flags |= DecodeFlag::Load;
+			}
+			// No coprocessors are attached, see dis_coproc
+			fields.flags &= ~DecodeFlag::Valid;
+			break;
+		}
+		case InstrFormat::ArmUndefined:
+			fields.rd = fields.rn = fields.rs = fields.rm = NONE;
+			break;
+		default:
+			fields.rd = fields.rn = fields.rs = fields.rm = NONE;
+			fields.flags = 0;
+			break;
+	}
+}
+
+td::DecodedFields td::ArmFieldDecoder::decode_fields(std::uint32_t pc, const std::uint32_t instr) {
+	DecodedFields fields;
+	extract_fields(instr, fields);
+	complete_fields(pc, instr, fields);
+	return fields;
+}
+
+void td::ArmFieldDecoder::decode_batch(std::span<const std::uint32_t> instrs, std::uint32_t base_pc, const DecodedBatch& out) {
+	const std::size_t count = instrs.size();
+
+	// Pass 1: fixed-position fields and formats, SIMD where the CPU allows.
+	extract_arm_fields(instrs, out);
+
+	// Pass 2: per-format operand semantics.
+	for (std::size_t i = 0; i < count; ++i) {
+		DecodedFields fields{};
+		fields.format = out.format[i];
+		fields.cond = out.cond[i];
+		fields.rd = out.rd[i];
+		fields.rn = out.rn[i];
+		fields.rs = out.rs[i];
+		fields.rm = out.rm[i];
+		complete_fields(base_pc + static_cast<std::uint32_t>(i * 4), instrs[i], fields);
+		out.store(i, fields);
+	}
+}
+
+template class td::BasicArmDisasm<td::HexFormat>;
+template class td::BasicArmDisasm<td::DecimalFormat>;
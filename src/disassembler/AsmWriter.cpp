@@ -0,0 +1,644 @@
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <totr/disassembler/AsmWriter.hpp>
+#include <totr/disassembler/Common.hpp>
+#include <totr/disassembler/DataRenderer.hpp>
+#include <totr/disassembler/DecodedFields.hpp>
+
+namespace td = totr::Disassembler;
+
+namespace {
+	constexpr std::uint8_t PC = 15;
+	constexpr std::size_t FLUSH_SIZE = 1 << 16;
+
+	// GAS encodes an ARM immediate with the smallest rotation that fits; any other rotation of
+	// the same value assembles to a different word.
+	bool is_canonical_immediate(std::uint32_t instr) {
+		const std::uint32_t rotation = ((instr >> 8) & 0xF) * 2;
+		const std::uint32_t value = std::rotr(instr & 0xFF, static_cast<int>(rotation));
+		for (std::uint32_t i = 0; i < 32; i += 2) {
+			if (std::rotl(value, static_cast<int>(i)) <= 0xFF) return i == rotation;
+		}
+		return false;
+	}
+
+	bool uses_pc(const td::DecodedFields& fields) {
+		return fields.rd == PC || fields.rn == PC || fields.rs == PC || fields.rm == PC;
+	}
+
+	void append_hex(std::string& line, std::uint32_t value, int digits) {
+		char buffer[12];
+		line.append(buffer, td::format_hex_fixed(buffer, value, digits));
+	}
+
+	void append_immediate(std::string& line, std::uint32_t value, bool prefix_hash = true) {
+		char buffer[12];
+		line.append(buffer, td::format_literal(buffer, value, true, prefix_hash));
+	}
+
+	void append_register(std::string& line, std::uint8_t reg) {
+		line.append(td::get_register_name(reg));
+	}
+
+	void append_register_list(std::string& line, std::uint32_t register_list, int length) {
+		td::Mnemonic list;
+		td::print_register_list(list, register_list, length);
+		line.append(list.view());
+	}
+
+	constexpr std::string_view ARM_DATA_OPS[16] = {
+		"AND", "EOR", "SUB", "RSB", "ADD", "ADC", "SBC", "RSC", "TST", "TEQ", "CMP", "CMN", "ORR", "MOV", "BIC", "MVN"
+	};
+	constexpr std::string_view THUMB_ALU_OPS[16] = {
+		"AND", "EOR", "LSL", "LSR", "ASR", "ADC", "SBC", "ROR", "TST", "NEG", "CMP", "CMN", "ORR", "MUL", "BIC", "MVN"
+	};
+	constexpr std::string_view SHIFT_NAMES[4] = { "LSL", "LSR", "ASR", "ROR" };
+
+	// Rm with the shift of an ARM operand 2 or register offset; the decode keeps only Rm, so the
+	// shift comes from the word
+	void append_shifted_register(std::string& line, std::uint32_t instr) {
+		const std::uint8_t shift_type = (instr >> 5) & 0x3;
+		append_register(line, instr & 0xF);
+		if (instr & 0x10) {
+			line.append(", ").append(SHIFT_NAMES[shift_type]).append(" ");
+			append_register(line, (instr >> 8) & 0xF);
+			return;
+		}
+
+		const std::uint32_t amount = (instr >> 7) & 0x1F;
+		if (amount == 0 && shift_type == 0) return;
+		if (amount == 0 && shift_type == 3) {
+			line += ", RRX";
+			return;
+		}
+		line.append(", ").append(SHIFT_NAMES[shift_type]).append(" ");
+		append_immediate(line, amount == 0 ? 32 : amount); // LSR/ASR #32 encode as 0
+	}
+
+	template <std::endian Order>
+	class AsmEmitter {
+	public:
+		AsmEmitter(std::ostream& out, const td::ModeSweep<Order>& sweep, const td::MemoryReader<Order>& memory,
+			const td::ArmDisasm& arm, const td::ThumbDisasm& thumb, const td::SymbolTable& symbols, std::uint32_t base_address)
+			: m_out(out), m_sweep(sweep), m_memory(memory), m_arm(arm), m_thumb(thumb), m_symbols(symbols), m_base_address(base_address) {}
+
+		void write() {
+			collect();
+
+			m_buffer.reserve(FLUSH_SIZE + 256);
+			m_buffer += "\t.syntax divided\n\t.text\n";
+			if constexpr (Order == std::endian::big) m_buffer += "@ Big-endian image: assemble with -EB\n";
+
+			const auto& entries = m_sweep.entries();
+			std::optional<td::ArmMode> directive;
+			std::uint32_t written = 0; // End of the last unit emitted
+
+			for (std::size_t i = 0; i < entries.size(); ) {
+				const td::SweepEntry& entry = entries[i];
+				const std::uint32_t offset = entry.offset;
+
+				// Data regions the sweep skipped
+				if (offset > written) emit_data(written, offset);
+
+				if (offset + entry.size > m_memory.size()) {
+					// The last instruction runs past the image; keep only the bytes that exist
+					emit_labels_at(offset);
+					for (std::uint32_t byte = offset; byte < m_memory.size(); ++byte) {
+						m_buffer += "\t.byte ";
+						append_hex(m_buffer, m_memory.bytes()[byte], 2);
+						m_buffer += '\n';
+					}
+					emit_inner_labels(offset, static_cast<std::uint32_t>(m_memory.size()) - offset);
+					written = static_cast<std::uint32_t>(m_memory.size());
+					break;
+				}
+
+				if (const std::size_t covered = literal_entries(i)) {
+					emit_labels_at(offset);
+					m_buffer += "\t.word ";
+					append_hex(m_buffer, m_memory.read_word(offset), 8);
+					m_buffer += '\n';
+					emit_inner_labels(offset, 4);
+					written = offset + 4;
+					i += covered;
+					continue;
+				}
+
+				if (directive != entry.mode()) {
+					directive = entry.mode();
+					m_buffer += (*directive == td::ArmMode::ARM) ? "\t.arm\n" : "\t.thumb\n";
+				}
+				emit_labels_at(offset);
+				emit_instruction(entry);
+				emit_inner_labels(offset, entry.size);
+				written = offset + entry.size;
+				++i;
+
+				if (m_buffer.size() >= FLUSH_SIZE) flush();
+			}
+			if (written < m_memory.size()) emit_data(written, static_cast<std::uint32_t>(m_memory.size()));
+			flush();
+		}
+	private:
+		std::ostream& m_out;
+		const td::ModeSweep<Order>& m_sweep;
+		const td::MemoryReader<Order>& m_memory;
+		const td::ArmDisasm& m_arm;
+		const td::ThumbDisasm& m_thumb;
+		const td::SymbolTable& m_symbols;
+		std::uint32_t m_base_address;
+
+		std::vector<std::uint32_t> m_labels;     // Bus addresses inside the image, sorted
+		std::vector<std::string> m_label_names;  // Parallel to m_labels
+		std::size_t m_next_label = 0;
+		std::vector<bool> m_literal_words;       // Word index -> read by a PC-relative load
+		std::string m_buffer;
+		td::InstructionData m_data;
+
+		bool in_image(std::uint32_t address) const {
+			return address >= m_base_address && address - m_base_address < m_memory.size();
+		}
+
+		td::DecodedFields decode_fields(const td::SweepEntry& entry) const {
+			return m_sweep.fields(entry);
+		}
+
+		// Branch destinations, tracked BX destinations and symbols become labels; PC-relative
+		// load addresses become literal pool words.
+		void collect() {
+			m_literal_words.assign(m_memory.size() / 4, false);
+
+			for (const td::SweepEntry& entry : m_sweep.entries()) {
+				const td::DecodedFields fields = decode_fields(entry);
+				if (!fields.is_valid()) continue;
+				const std::uint32_t pc = m_base_address + entry.offset;
+
+				if ((fields.flags & td::DecodeFlag::HasTarget) && in_image(fields.imm)) m_labels.push_back(fields.imm);
+				if (fields.flags & td::DecodeFlag::BranchExchange) {
+					if (auto target = m_sweep.tracked_target(entry.offset); target && in_image(target->address)) m_labels.push_back(target->address);
+				}
+
+				std::optional<std::uint32_t> literal;
+				if (fields.format == td::InstrFormat::ArmSingleDataTrans && fields.rn == PC
+					&& (fields.flags & (td::DecodeFlag::Load | td::DecodeFlag::PreIndex | td::DecodeFlag::Immediate | td::DecodeFlag::WriteBack | td::DecodeFlag::Byte))
+						== (td::DecodeFlag::Load | td::DecodeFlag::PreIndex | td::DecodeFlag::Immediate)) {
+					literal = (fields.flags & td::DecodeFlag::AddOffset) ? pc + 8 + fields.imm : pc + 8 - fields.imm;
+				}
+				else if (fields.format == td::InstrFormat::ThumbPcRelLoad) {
+					literal = ((pc + 4) & ~2u) + fields.imm;
+				}
+				if (literal && (*literal & 3) == 0 && in_image(*literal) && *literal - m_base_address + 4 <= m_memory.size()) {
+					m_literal_words[(*literal - m_base_address) / 4] = true;
+				}
+			}
+
+			const std::uint32_t end = m_base_address + static_cast<std::uint32_t>(m_memory.size());
+			for (std::size_t i = m_symbols.lower_bound(m_base_address); i < m_symbols.size() && m_symbols.address(i) < end; ++i) {
+				m_labels.push_back(m_symbols.address(i));
+			}
+
+			std::sort(m_labels.begin(), m_labels.end());
+			m_labels.erase(std::unique(m_labels.begin(), m_labels.end()), m_labels.end());
+
+			m_label_names.reserve(m_labels.size());
+			for (std::uint32_t address : m_labels) {
+				if (auto name = m_symbols.find(address)) {
+					m_label_names.emplace_back(*name);
+				}
+				else {
+					std::string generated = "loc_";
+					char digits[12];
+					const std::size_t length = td::format_hex_fixed(digits, address, 8);
+					generated.append(digits + 2, length - 2);
+					m_label_names.push_back(std::move(generated));
+				}
+			}
+		}
+
+		std::optional<std::string_view> label(std::uint32_t address) const {
+			auto it = std::lower_bound(m_labels.begin(), m_labels.end(), address);
+			if (it == m_labels.end() || *it != address) return std::nullopt;
+			return m_label_names[it - m_labels.begin()];
+		}
+
+		void emit_labels_at(std::uint32_t offset) {
+			const std::uint32_t address = m_base_address + offset;
+			while (m_next_label < m_labels.size() && m_labels[m_next_label] < address) ++m_next_label;
+			if (m_next_label < m_labels.size() && m_labels[m_next_label] == address) {
+				m_buffer.append(m_label_names[m_next_label]).append(":\n");
+				++m_next_label;
+			}
+		}
+
+		// Labels that fall inside the unit just written are defined relative to the location counter
+		void emit_inner_labels(std::uint32_t offset, std::uint32_t size) {
+			const std::uint32_t end = m_base_address + offset + size;
+			for (; m_next_label < m_labels.size() && m_labels[m_next_label] < end; ++m_next_label) {
+				m_buffer.append("\t.set ").append(m_label_names[m_next_label]).append(", . - ");
+				m_buffer.append(std::to_string(end - m_labels[m_next_label])).append("\n");
+			}
+		}
+
+		// Number of sweep entries starting at entries[i] that exactly cover one literal pool word, or 0
+		std::size_t literal_entries(std::size_t i) const {
+			const auto& entries = m_sweep.entries();
+			const std::uint32_t offset = entries[i].offset;
+			if ((offset & 3) || offset / 4 >= m_literal_words.size() || !m_literal_words[offset / 4]) return 0;
+
+			if (entries[i].size == 4) return 1;
+			if (i + 1 < entries.size() && entries[i + 1].offset == offset + 2 && entries[i + 1].size == 2) return 2;
+			return 0;
+		}
+
+		void emit_data(std::uint32_t first, std::uint32_t last) {
+			for (const td::DataRow& row : td::split_data(m_memory, first, last)) {
+				emit_labels_at(row.offset);
+				m_buffer += '\t';
+				td::append_data_row(m_buffer, m_memory, row);
+				m_buffer += '\n';
+				emit_inner_labels(row.offset, row.size);
+				if (m_buffer.size() >= FLUSH_SIZE) flush();
+			}
+		}
+
+		void emit_instruction(const td::SweepEntry& entry) {
+			const bool is_arm = entry.mode() == td::ArmMode::ARM;
+			const std::uint32_t instr = is_arm ? m_memory.fetch_arm(entry.offset) : m_memory.fetch_thumb(entry.offset);
+			const td::DecodedFields fields = decode_fields(entry);
+
+			m_buffer += '\t';
+			const std::size_t start = m_buffer.size();
+			const bool rendered = is_arm ? render_arm(fields, instr, entry.offset) : render_thumb(fields, instr);
+			if (rendered) {
+				m_buffer += '\n';
+				return;
+			}
+
+			m_buffer.resize(start);
+			if (is_arm) {
+				m_buffer += ".word ";
+				append_hex(m_buffer, instr, 8);
+			}
+			else {
+				m_buffer += ".hword ";
+				append_hex(m_buffer, instr & 0xFFFF, 4);
+				if (entry.size == 4) {
+					m_buffer += ", ";
+					append_hex(m_buffer, instr >> 16, 4);
+				}
+			}
+
+			// Only words kept as data are rendered as listing text, for the comment
+			const std::uint32_t address = m_base_address + entry.offset;
+			if (is_arm) m_arm.decode(address, instr, m_data);
+			else m_thumb.decode(address, instr, m_data);
+			if (m_data.is_valid) m_buffer.append(" @ ").append(m_data.mnemonic.view());
+			m_buffer += '\n';
+		}
+
+		bool render_branch(std::string_view name, std::string_view cond, std::uint32_t target) {
+			const auto label_name = label(target);
+			if (!label_name) return false;
+			m_buffer.append(name).append(cond).append(" ").append(*label_name);
+			return true;
+		}
+
+		// [Rn, <offset>]{!} or [Rn], <offset> of the ARM transfers; `offset` writes the offset
+		// without its sign, and an immediate offset of zero is left out
+		template <typename Offset>
+		void append_address(const td::DecodedFields& fields, bool zero, Offset offset) {
+			const bool pre_index = fields.flags & td::DecodeFlag::PreIndex;
+			const std::string_view sign = (fields.flags & td::DecodeFlag::AddOffset) ? "" : "-";
+			m_buffer += '[';
+			append_register(m_buffer, fields.rn);
+			if (!pre_index) m_buffer += ']';
+			if (!zero) {
+				m_buffer.append(", ");
+				if (fields.flags & td::DecodeFlag::Immediate) m_buffer += '#';
+				m_buffer.append(sign);
+				offset();
+			}
+			if (pre_index) {
+				m_buffer += ']';
+				if (fields.flags & td::DecodeFlag::WriteBack) m_buffer += '!';
+			}
+		}
+
+		bool render_arm(const td::DecodedFields& fields, std::uint32_t instr, std::uint32_t offset) {
+			// NV is unpredictable on ARMv4 and has no assembler syntax; ARM code must be word aligned
+			if (!fields.is_valid() || fields.cond == 0xF || (offset & 3)) return false;
+
+			const std::string_view cond = td::get_cond_suffix(fields.cond);
+			const bool is_load = fields.flags & td::DecodeFlag::Load;
+			const bool sets_flags = fields.flags & td::DecodeFlag::SetFlags;
+			const bool immediate = fields.flags & td::DecodeFlag::Immediate;
+			const bool zero_offset = immediate && fields.imm == 0;
+			const bool plain_offset = (fields.flags & td::DecodeFlag::PreIndex) && (fields.flags & td::DecodeFlag::AddOffset)
+				&& !(fields.flags & td::DecodeFlag::WriteBack);
+			const bool writes_base = (fields.flags & td::DecodeFlag::WriteBack) || !(fields.flags & td::DecodeFlag::PreIndex);
+			const std::string_view psr = fields.opcode ? "SPSR" : "CPSR";
+
+			switch (fields.format) {
+				case td::InstrFormat::ArmBranchExchange:
+					m_buffer.append("BX").append(cond).append(" ");
+					append_register(m_buffer, fields.rm);
+					return true;
+				case td::InstrFormat::ArmBranch:
+					return render_branch((fields.flags & td::DecodeFlag::Link) ? "BL" : "B", cond, fields.imm);
+				case td::InstrFormat::ArmDataProc: {
+					const bool is_compare = fields.opcode >= 8 && fields.opcode <= 11;
+					const bool is_move = fields.opcode == 13 || fields.opcode == 15;
+					if (is_compare && (!sets_flags || ((instr >> 12) & 0xF) != 0)) return false;
+					if (is_move && ((instr >> 16) & 0xF) != 0) return false;
+					if (immediate && !is_canonical_immediate(instr)) return false;
+					// PC is unpredictable with a register-specified shift
+					if (!immediate && (instr & 0x10) && uses_pc(fields)) return false;
+
+					// A PC-relative ADD/SUB stays in that form; ADR would leave the offset to the assembler
+					m_buffer.append(ARM_DATA_OPS[fields.opcode]).append(cond);
+					if (sets_flags && !is_compare) m_buffer += 'S';
+					m_buffer += ' ';
+					if (!is_compare) {
+						append_register(m_buffer, fields.rd);
+						m_buffer.append(", ");
+					}
+					if (!is_move) {
+						append_register(m_buffer, fields.rn);
+						m_buffer.append(", ");
+					}
+					if (immediate) append_immediate(m_buffer, fields.imm);
+					else append_shifted_register(m_buffer, instr);
+					return true;
+				}
+				case td::InstrFormat::ArmPsrMrs:
+					m_buffer.append("MRS").append(cond).append(" ");
+					append_register(m_buffer, fields.rd);
+					m_buffer.append(", ").append(psr);
+					return true;
+				case td::InstrFormat::ArmPsrMsrReg:
+					m_buffer.append("MSR").append(cond).append(" ").append(psr).append(", ");
+					append_register(m_buffer, fields.rm);
+					return true;
+				case td::InstrFormat::ArmPsrMsrImm:
+					if (immediate) {
+						if (!is_canonical_immediate(instr)) return false;
+					}
+					else if (((instr >> 4) & 0xFF) != 0) return false;
+					m_buffer.append("MSR").append(cond).append(" ").append(psr).append("_f, ");
+					if (immediate) append_immediate(m_buffer, fields.imm);
+					else append_register(m_buffer, fields.rm);
+					return true;
+				case td::InstrFormat::ArmMul:
+					if ((instr & 0x0FC000F0) != 0x00000090 || uses_pc(fields)) return false;
+					if (fields.rn == 0xFF && ((instr >> 12) & 0xF) != 0) return false;
+					m_buffer.append(fields.opcode ? "MLA" : "MUL").append(cond).append(sets_flags ? "S " : " ");
+					append_register(m_buffer, fields.rd);
+					m_buffer.append(", ");
+					append_register(m_buffer, fields.rm);
+					m_buffer.append(", ");
+					append_register(m_buffer, fields.rs);
+					if (fields.opcode) {
+						m_buffer.append(", ");
+						append_register(m_buffer, fields.rn);
+					}
+					return true;
+				case td::InstrFormat::ArmMulLong:
+					if (uses_pc(fields) || fields.rd == fields.rn) return false;
+					m_buffer.append((fields.opcode & 2) ? "S" : "U").append((fields.opcode & 1) ? "MLAL" : "MULL");
+					m_buffer.append(cond).append(sets_flags ? "S " : " ");
+					append_register(m_buffer, fields.rd);
+					m_buffer.append(", ");
+					append_register(m_buffer, fields.rn);
+					m_buffer.append(", ");
+					append_register(m_buffer, fields.rm);
+					m_buffer.append(", ");
+					append_register(m_buffer, fields.rs);
+					return true;
+				case td::InstrFormat::ArmSingleDataSwap:
+					if ((instr & 0x0FB00FF0) != 0x01000090 || uses_pc(fields)) return false;
+					if (fields.rn == fields.rd || fields.rn == fields.rm) return false;
+					m_buffer.append("SWP").append(cond).append((fields.flags & td::DecodeFlag::Byte) ? "B " : " ");
+					append_register(m_buffer, fields.rd);
+					m_buffer.append(", ");
+					append_register(m_buffer, fields.rm);
+					m_buffer.append(", [");
+					append_register(m_buffer, fields.rn);
+					m_buffer += ']';
+					return true;
+				case td::InstrFormat::ArmSingleDataTrans:
+					if (zero_offset && !plain_offset) return false;
+					if (writes_base && (fields.rn == PC || fields.rn == fields.rd)) return false;
+					if ((fields.flags & td::DecodeFlag::Byte) && fields.rd == PC) return false;
+
+					m_buffer.append(is_load ? "LDR" : "STR").append(cond);
+					if (fields.flags & td::DecodeFlag::Byte) m_buffer += 'B';
+					// Post-indexed W forces a user mode access
+					if (!(fields.flags & td::DecodeFlag::PreIndex) && (fields.flags & td::DecodeFlag::WriteBack)) m_buffer += 'T';
+					m_buffer += ' ';
+					append_register(m_buffer, fields.rd);
+					m_buffer.append(", ");
+					append_address(fields, zero_offset, [&] {
+						if (immediate) append_immediate(m_buffer, fields.imm, false);
+						else append_shifted_register(m_buffer, instr);
+					});
+					return true;
+				case td::InstrFormat::ArmHalfwordTransReg:
+				case td::InstrFormat::ArmHalfwordTransImm:
+					if (fields.format == td::InstrFormat::ArmHalfwordTransReg && ((instr >> 8) & 0xF) != 0) return false;
+					if (zero_offset && !plain_offset) return false;
+					if (writes_base && (fields.rn == PC || fields.rn == fields.rd)) return false;
+					// Post-indexing has no writeback bit here, and PC cannot be transferred
+					if (!(fields.flags & td::DecodeFlag::PreIndex) && (fields.flags & td::DecodeFlag::WriteBack)) return false;
+					if (fields.rd == PC) return false;
+
+					// Divided syntax puts the condition before the size: LDR<cond>SH
+					m_buffer.append(is_load ? "LDR" : "STR").append(cond);
+					m_buffer.append(fields.opcode == 1 ? "H " : (fields.opcode == 2 ? "SB " : "SH "));
+					append_register(m_buffer, fields.rd);
+					m_buffer.append(", ");
+					append_address(fields, zero_offset, [&] {
+						if (immediate) append_immediate(m_buffer, fields.imm, false);
+						else append_register(m_buffer, fields.rm);
+					});
+					return true;
+				case td::InstrFormat::ArmBlockDataTrans: {
+					if (fields.imm == 0) return false;
+					if ((fields.flags & td::DecodeFlag::WriteBack) && fields.rn == PC) return false;
+					// User bank transfers cannot write the base back; only the exception return form may
+					if (sets_flags && (fields.flags & td::DecodeFlag::WriteBack) && !(fields.flags & td::DecodeFlag::ExceptionReturn)) return false;
+
+					// ... and before the addressing mode, which is always spelled out: LDM<cond>IA
+					const bool increment = fields.flags & td::DecodeFlag::AddOffset;
+					const bool before = fields.flags & td::DecodeFlag::PreIndex;
+					m_buffer.append(is_load ? "LDM" : "STM").append(cond);
+					m_buffer.append(increment ? "I" : "D").append(before ? "B " : "A ");
+					append_register(m_buffer, fields.rn);
+					if (fields.flags & td::DecodeFlag::WriteBack) m_buffer += '!';
+					m_buffer.append(", {");
+					append_register_list(m_buffer, fields.imm, 16);
+					m_buffer += '}';
+					if (sets_flags) m_buffer += '^';
+					return true;
+				}
+				case td::InstrFormat::ArmSwi:
+					m_buffer.append("SWI").append(cond).append(" ");
+					append_immediate(m_buffer, fields.imm);
+					return true;
+				default:
+					// Undefined, coprocessor (no coprocessors are attached) and invalid words
+					return false;
+			}
+		}
+
+		bool render_thumb(const td::DecodedFields& fields, std::uint32_t instr) {
+			if (!fields.is_valid()) return false;
+
+			const bool is_load = fields.flags & td::DecodeFlag::Load;
+			const bool immediate = fields.flags & td::DecodeFlag::Immediate;
+
+			switch (fields.format) {
+				case td::InstrFormat::ThumbMoveShiftedReg:
+					m_buffer.append(SHIFT_NAMES[fields.opcode]).append(" ");
+					append_register(m_buffer, fields.rd);
+					m_buffer.append(", ");
+					append_register(m_buffer, fields.rn);
+					m_buffer.append(", ");
+					// LSR and ASR encode a shift by 32 as 0
+					append_immediate(m_buffer, (fields.imm == 0 && fields.opcode != 0) ? 32 : fields.imm);
+					return true;
+				case td::InstrFormat::ThumbAddSub:
+					m_buffer.append(fields.opcode ? "SUB " : "ADD ");
+					append_register(m_buffer, fields.rd);
+					m_buffer.append(", ");
+					append_register(m_buffer, fields.rn);
+					m_buffer.append(", ");
+					if (immediate) append_immediate(m_buffer, fields.imm);
+					else append_register(m_buffer, fields.rm);
+					return true;
+				case td::InstrFormat::ThumbMovCmpAddSubImm: {
+					constexpr std::string_view NAMES[4] = { "MOV ", "CMP ", "ADD ", "SUB " };
+					m_buffer.append(NAMES[fields.opcode]);
+					append_register(m_buffer, fields.rd);
+					m_buffer.append(", ");
+					append_immediate(m_buffer, fields.imm);
+					return true;
+				}
+				case td::InstrFormat::ThumbAluOps:
+					m_buffer.append(THUMB_ALU_OPS[fields.opcode]).append(" ");
+					append_register(m_buffer, fields.rd);
+					m_buffer.append(", ");
+					append_register(m_buffer, fields.rm);
+					return true;
+				case td::InstrFormat::ThumbHiRegOpsBx:
+					if (fields.flags & td::DecodeFlag::BranchExchange) {
+						if ((instr & 0x7) != 0) return false;
+						m_buffer.append("BX ");
+					}
+					else {
+						constexpr std::string_view NAMES[3] = { "ADD ", "CMP ", "MOV " };
+						m_buffer.append(NAMES[fields.opcode]);
+						append_register(m_buffer, fields.rd);
+						m_buffer.append(", ");
+					}
+					append_register(m_buffer, fields.rm);
+					return true;
+				case td::InstrFormat::ThumbPcRelLoad:
+				case td::InstrFormat::ThumbSpRelLoadStore:
+				case td::InstrFormat::ThumbLoadStoreImmOff:
+				case td::InstrFormat::ThumbLoadStoreHalfword:
+				case td::InstrFormat::ThumbLoadStoreRegOff:
+					m_buffer.append(is_load ? "LDR" : "STR");
+					if (fields.format == td::InstrFormat::ThumbLoadStoreHalfword) m_buffer += 'H';
+					if (fields.flags & td::DecodeFlag::Byte) m_buffer += 'B';
+					m_buffer += ' ';
+					append_register(m_buffer, fields.rd);
+					m_buffer.append(", [");
+					append_register(m_buffer, fields.rn);
+					m_buffer.append(", ");
+					if (immediate) append_immediate(m_buffer, fields.imm);
+					else append_register(m_buffer, fields.rm);
+					m_buffer += ']';
+					return true;
+				case td::InstrFormat::ThumbLoadStoreSignExt: {
+					// LDSB / LDSH are spelled LDRSB / LDRSH
+					constexpr std::string_view NAMES[4] = { "STRH ", "LDRSB ", "LDRH ", "LDRSH " };
+					m_buffer.append(NAMES[fields.opcode]);
+					append_register(m_buffer, fields.rd);
+					m_buffer.append(", [");
+					append_register(m_buffer, fields.rn);
+					m_buffer.append(", ");
+					append_register(m_buffer, fields.rm);
+					m_buffer += ']';
+					return true;
+				}
+				case td::InstrFormat::ThumbLoadAddress:
+					// ADR is written as the ADD from PC it encodes
+					m_buffer.append("ADD ");
+					append_register(m_buffer, fields.rd);
+					m_buffer.append(", ");
+					append_register(m_buffer, fields.rn);
+					m_buffer.append(", ");
+					append_immediate(m_buffer, fields.imm);
+					return true;
+				case td::InstrFormat::ThumbAddOffToSp:
+					m_buffer.append(fields.opcode ? "SUB SP, " : "ADD SP, ");
+					append_immediate(m_buffer, fields.imm);
+					return true;
+				case td::InstrFormat::ThumbPushPopReg: {
+					if ((instr & 0x1FF) == 0) return false;
+					const std::uint32_t low = fields.imm & 0xFF;
+					m_buffer.append(is_load ? "POP {" : "PUSH {");
+					append_register_list(m_buffer, low, 8);
+					if (fields.imm & 0xC000) {
+						if (low) m_buffer.append(", ");
+						m_buffer.append(is_load ? "PC" : "LR");
+					}
+					m_buffer += '}';
+					return true;
+				}
+				case td::InstrFormat::ThumbMultiLoadStore:
+					// An empty list, or the base in the list, has no single assembler spelling on ARMv4T
+					if (fields.imm == 0 || ((fields.imm >> fields.rn) & 1)) return false;
+					m_buffer.append(is_load ? "LDMIA " : "STMIA ");
+					append_register(m_buffer, fields.rn);
+					m_buffer.append("!, {");
+					append_register_list(m_buffer, fields.imm, 8);
+					m_buffer += '}';
+					return true;
+				case td::InstrFormat::ThumbCondBranch:
+				case td::InstrFormat::ThumbUncondBranch:
+					return render_branch("B", td::get_cond_suffix(fields.cond), fields.imm);
+				case td::InstrFormat::ThumbLongBranchLink:
+					return render_branch("BL", "", fields.imm);
+				case td::InstrFormat::ThumbSwi:
+					m_buffer.append("SWI ");
+					append_immediate(m_buffer, fields.imm);
+					return true;
+				default:
+					return false;
+			}
+		}
+
+		void flush() {
+			m_out.write(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+			m_buffer.clear();
+		}
+	};
+}
+
+template <std::endian Order>
+void td::write_gnu_as(std::ostream& out, const ModeSweep<Order>& sweep, const MemoryReader<Order>& memory,
+	const ArmDisasm& arm, const ThumbDisasm& thumb, const SymbolTable& symbols, std::uint32_t base_address) {
+	AsmEmitter<Order>{ out, sweep, memory, arm, thumb, symbols, base_address }.write();
+}
+
+template void td::write_gnu_as(std::ostream&, const td::ModeSweep<std::endian::little>&, const td::LittleEndianReader&,
+	const td::ArmDisasm&, const td::ThumbDisasm&, const td::SymbolTable&, std::uint32_t);
+template void td::write_gnu_as(std::ostream&, const td::ModeSweep<std::endian::big>&, const td::BigEndianReader&,
+	const td::ArmDisasm&, const td::ThumbDisasm&, const td::SymbolTable&, std::uint32_t);
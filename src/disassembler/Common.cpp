@@ -1,10 +1,267 @@
 #include <string>
 #include <span>
 #include <cstdint>
+#include <bit>
+#include <cstring>
+#include <algorithm>
 
 #include <totr/disassembler/Common.hpp>
+#include <totr/disassembler/MemoryReader.hpp>
+
+namespace {
+	constexpr char HEX_DIGITS[] = "0123456789ABCDEF";
+
+	constexpr char DECIMAL_PAIRS[] =
+		"00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+		"40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+		"8081828384858687888990919293949596979899";
+
+	int count_decimal_digits(std::uint32_t value) {
+		int digits = 1;
+		for (;;) {
+			if (value < 10) return digits;
+			if (value < 100) return digits + 1;
+			if (value < 1000) return digits + 2;
+			if (value < 10000) return digits + 3;
+			value /= 10000;
+			digits += 4;
+		}
+	}
+
+	// Register list text for one byte of a list, with bit 0 naming register `first`: runs of two or
+	// more registers collapse to "Rn-Rm". The run touching each edge is located so that two halves
+	// can be joined when a run crosses from R7 to R8.
+	struct ListFragment {
+		char text[24];
+		std::uint8_t length;
+		std::uint8_t head_end;   // End of the text of the run containing bit 0
+		std::uint8_t tail_start; // Start of the text of the run containing bit 7
+		std::uint8_t first_end;  // Last register of the run containing bit 0
+		std::uint8_t last_start; // First register of the run containing bit 7
+	};
+
+	constexpr std::string_view LIST_NAMES[16] = {
+		"R0", "R1", "R2", "R3", "R4", "R5", "R6", "R7",
+		"R8", "R9", "R10", "R11", "R12", "R13", "R14", "R15"
+	};
+
+	constexpr std::size_t put(char* out, std::string_view text) {
+		for (std::size_t i = 0; i < text.size(); ++i) out[i] = text[i];
+		return text.size();
+	}
+
+	constexpr ListFragment make_fragment(std::uint8_t bits, std::uint8_t first) {
+		ListFragment fragment{};
+		std::size_t length = 0;
+		for (int r = 0; r < 8;) {
+			if (!((bits >> r) & 1)) {
+				++r;
+				continue;
+			}
+			int end = r;
+			while (end + 1 < 8 && ((bits >> (end + 1)) & 1)) ++end;
+
+			if (length) length += put(fragment.text + length, ", ");
+			if (end == 7) {
+				fragment.tail_start = static_cast<std::uint8_t>(length);
+				fragment.last_start = static_cast<std::uint8_t>(first + r);
+			}
+			length += put(fragment.text + length, LIST_NAMES[first + r]);
+			if (end > r) {
+				length += put(fragment.text + length, "-");
+				length += put(fragment.text + length, LIST_NAMES[first + end]);
+			}
+			if (r == 0) {
+				fragment.head_end = static_cast<std::uint8_t>(length);
+				fragment.first_end = static_cast<std::uint8_t>(first + end);
+			}
+			r = end + 1;
+		}
+		fragment.length = static_cast<std::uint8_t>(length);
+		return fragment;
+	}
+
+	struct ListTables {
+		ListFragment low[256];  // R0-R7
+		ListFragment high[256]; // R8-R15
+	};
+
+	constexpr ListTables make_list_tables() {
+		ListTables tables{};
+		for (int bits = 0; bits < 256; ++bits) {
+			tables.low[bits] = make_fragment(static_cast<std::uint8_t>(bits), 0);
+			tables.high[bits] = make_fragment(static_cast<std::uint8_t>(bits), 8);
+		}
+		return tables;
+	}
+
+	constexpr ListTables LIST_TABLES = make_list_tables();
+
+	// Length write_register_list renders for a 16-bit list, from the fragment layout alone
+	constexpr std::size_t register_list_length(std::uint32_t register_list) {
+		const ListFragment& low = LIST_TABLES.low[register_list & 0xFF];
+		const ListFragment& high = LIST_TABLES.high[(register_list >> 8) & 0xFF];
+		if (!high.length || !low.length) return low.length + high.length;
+		if ((register_list & 0x180) == 0x180) {
+			return low.tail_start + LIST_NAMES[low.last_start].size() + 1 + LIST_NAMES[high.first_end].size()
+				+ high.length - high.head_end;
+		}
+		return low.length + 2 + high.length;
+	}
+
+	constexpr std::size_t longest_register_list() {
+		std::size_t longest = 0;
+		for (std::uint32_t list = 0; list <= 0xFFFF; ++list) longest = std::max(longest, register_list_length(list));
+		return longest;
+	}
+
+	// "R0-R1, R3-R4, R6-R7, R9-R10, R12-R13, R15" (0xB6DB) is the longest list
+	constexpr std::size_t REGISTER_LIST_MAX = 41;
+	static_assert(longest_register_list() == REGISTER_LIST_MAX);
+
+	// Renders a 16-bit register list from the two byte fragments; at most REGISTER_LIST_MAX characters
+	std::size_t write_register_list(char* out, std::uint32_t register_list) {
+		const ListFragment& low = LIST_TABLES.low[register_list & 0xFF];
+		const ListFragment& high = LIST_TABLES.high[(register_list >> 8) & 0xFF];
+		if (!high.length) {
+			std::memcpy(out, low.text, low.length);
+			return low.length;
+		}
+		if (!low.length) {
+			std::memcpy(out, high.text, high.length);
+			return high.length;
+		}
+
+		std::size_t length;
+		if ((register_list & 0x180) == 0x180) {
+			// A run crossing R7/R8: join the low half's last run start to the high half's first run end
+			std::memcpy(out, low.text, low.tail_start);
+			length = low.tail_start;
+			length += put(out + length, LIST_NAMES[low.last_start]);
+			out[length++] = '-';
+			length += put(out + length, LIST_NAMES[high.first_end]);
+			std::memcpy(out + length, high.text + high.head_end, high.length - high.head_end);
+			return length + high.length - high.head_end;
+		}
+		std::memcpy(out, low.text, low.length);
+		length = low.length;
+		out[length++] = ',';
+		out[length++] = ' ';
+		std::memcpy(out + length, high.text, high.length);
+		return length + high.length;
+	}
+
+	// Writes exactly `digits` upper-case hex digits, most significant first.
+	void write_hex_digits(char* out, std::uint32_t value, int digits) {
+		for (int i = digits - 1; i >= 0; --i) {
+			out[i] = HEX_DIGITS[value & 0xF];
+			value >>= 4;
+		}
+	}
+
+	// Writes exactly `digits` decimal digits, two at a time from the least significant end.
+	void write_decimal_digits(char* out, std::uint32_t value, int digits) {
+		int pos = digits;
+		while (value >= 100) {
+			const std::uint32_t pair = (value % 100) * 2;
+			value /= 100;
+			out[--pos] = DECIMAL_PAIRS[pair + 1];
+			out[--pos] = DECIMAL_PAIRS[pair];
+		}
+		if (value >= 10) {
+			out[--pos] = DECIMAL_PAIRS[value * 2 + 1];
+			out[--pos] = DECIMAL_PAIRS[value * 2];
+		}
+		else {
+			out[--pos] = static_cast<char>('0' + value);
+		}
+	}
+}
+
+std::size_t totr::Disassembler::format_literal(char* out, std::uint32_t value, bool hex, bool prefix_hash) {
+	std::size_t length = 0;
+	if (prefix_hash) out[length++] = '#';
+
+	if (hex) {
+		out[length++] = '0';
+		out[length++] = 'x';
+		const int digits = value == 0 ? 1 : (std::bit_width(value) + 3) / 4;
+		write_hex_digits(out + length, value, digits);
+		return length + digits;
+	}
+
+	const int digits = count_decimal_digits(value);
+	write_decimal_digits(out + length, value, digits);
+	return length + digits;
+}
+
+std::size_t totr::Disassembler::format_hex_fixed(char* out, std::uint32_t value, int digits) {
+	out[0] = '0';
+	out[1] = 'x';
+	write_hex_digits(out + 2, value, digits);
+	return 2 + digits;
+}
+
+void totr::Disassembler::append_literal(Mnemonic& mnemonic, std::uint32_t value, bool hex, bool prefix_hash) {
+	if (mnemonic.remaining() >= 12) {
+		mnemonic.commit(format_literal(mnemonic.tail(), value, hex, prefix_hash));
+		return;
+	}
+	char buffer[12];
+	mnemonic += std::string_view(buffer, format_literal(buffer, value, hex, prefix_hash));
+}
+
+const char* totr::Disassembler::get_format_name(InstrFormat format) {
+	switch (format) {
+		case InstrFormat::Invalid: return "invalid";
+		case InstrFormat::ArmBranchExchange: return "arm_branch_exchange";
+		case InstrFormat::ArmBranch: return "arm_branch";
+		case InstrFormat::ArmDataProc: return "arm_data_proc";
+		case InstrFormat::ArmPsrMrs: return "arm_psr_trans_mrs";
+		case InstrFormat::ArmPsrMsrReg: return "arm_psr_trans_msr_reg";
+		case InstrFormat::ArmPsrMsrImm: return "arm_psr_trans_msr_imm";
+		case InstrFormat::ArmMul: return "arm_mul_mla";
+		case InstrFormat::ArmMulLong: return "arm_mul_mla_long";
+		case InstrFormat::ArmSingleDataTrans: return "arm_single_data_trans";
+		case InstrFormat::ArmHalfwordTransReg: return "arm_halfword_data_trans_reg";
+		case InstrFormat::ArmHalfwordTransImm: return "arm_halfword_data_trans_imm";
+		case InstrFormat::ArmBlockDataTrans: return "arm_block_data_trans";
+		case InstrFormat::ArmSingleDataSwap: return "arm_single_data_swap";
+		case InstrFormat::ArmSwi: return "arm_swi";
+		case InstrFormat::ArmUndefined: return "arm_undefined";
+		case InstrFormat::ArmCoprocDataTrans: return "arm_coproc_data_trans";
+		case InstrFormat::ArmCoprocDataOp: return "arm_coproc_data_op";
+		case InstrFormat::ArmCoprocRegTrans: return "arm_coproc_reg_trans";
+		case InstrFormat::ThumbMoveShiftedReg: return "thumb_move_shifted_reg";
+		case InstrFormat::ThumbAddSub: return "thumb_add_sub";
+		case InstrFormat::ThumbMovCmpAddSubImm: return "thumb_mov_cmp_add_sub_imm";
+		case InstrFormat::ThumbAluOps: return "thumb_alu_ops";
+		case InstrFormat::ThumbHiRegOpsBx: return "thumb_hi_reg_ops_bx";
+		case InstrFormat::ThumbPcRelLoad: return "thumb_pc_rel_load";
+		case InstrFormat::ThumbLoadStoreRegOff: return "thumb_load_store_reg_off";
+		case InstrFormat::ThumbLoadStoreSignExt: return "thumb_load_store_sign_ext";
+		case InstrFormat::ThumbLoadStoreImmOff: return "thumb_load_store_imm_off";
+		case InstrFormat::ThumbLoadStoreHalfword: return "thumb_load_store_halfword";
+		case InstrFormat::ThumbSpRelLoadStore: return "thumb_sp_rel_load_store";
+		case InstrFormat::ThumbLoadAddress: return "thumb_load_address";
+		case InstrFormat::ThumbAddOffToSp: return "thumb_add_off_to_sp";
+		case InstrFormat::ThumbPushPopReg: return "thumb_push_pop_reg";
+		case InstrFormat::ThumbMultiLoadStore: return "thumb_multi_load_store";
+		case InstrFormat::ThumbCondBranch: return "thumb_cond_branch";
+		case InstrFormat::ThumbSwi: return "thumb_swi";
+		case InstrFormat::ThumbUncondBranch: return "thumb_uncond_branch";
+		case InstrFormat::ThumbLongBranchLink: return "thumb_long_branch_link";
+		case InstrFormat::Count: break;
+	}
+	return "unknown";
+}
+
+std::string_view totr::Disassembler::get_register_name(std::uint8_t reg, bool use_alias) {
+	static constexpr std::string_view NAMES[16] = {
+		"R0", "R1", "R2", "R3", "R4", "R5", "R6", "R7",
+		"R8", "R9", "R10", "R11", "R12", "R13", "R14", "R15"
+	};
 
-std::string totr::Disassembler::get_register_name(std::uint8_t reg, bool use_alias) {
 	reg &= 0x0F;
 	if (use_alias) {
 		switch (reg) {
@@ -13,10 +270,10 @@ std::string totr::Disassembler::get_register_name(std::uint8_t reg, bool use_ali
 			case (15): return "PC"; // R15 : Program Counter
 		}
 	}
-	return "R" + std::to_string(reg);
+	return NAMES[reg];
 }
 
-std::string totr::Disassembler::get_cond_suffix(std::uint8_t cond) {
+std::string_view totr::Disassembler::get_cond_suffix(std::uint8_t cond) {
 	cond &= 0xF;
 	switch (cond) {
 		case (0): return "EQ";
@@ -39,44 +296,16 @@ std::string totr::Disassembler::get_cond_suffix(std::uint8_t cond) {
 	return "";
 }
 
-std::string totr::Disassembler::print_register_list(std::uint32_t register_list, int length) {
-	std::string mnemonic;
-
-	// Each of the 8 bits corresponds to a specific register by index. Eg. Bit 5=R5, Bit 0=R0, etc.
-	bool running = false;
-	std::uint8_t start = 0;
-	for (std::uint8_t r = 0; r < length; r++) {
-		if ((register_list >> r) & 0x1) {
-			if (!running) {
-				running = true;
-				start = r;
-				mnemonic += get_register_name(start, false);
-			}
-			else {
-				if (r == length-1) {
-					if (r - start == 2) mnemonic += ", " + get_register_name(r, false);
-					else if (r - start > 2) mnemonic += "-" + get_register_name(r, false);
-				}
-			}
-		}
-		else {
-			if (running) {
-				running = false;
-				if (r - start >= 2) mnemonic += "-" + get_register_name(r - 1, false);
-				if (register_list >> r) mnemonic += ", ";
-			}
-		}
+void totr::Disassembler::print_register_list(Mnemonic& mnemonic, std::uint32_t register_list, int length) {
+	const std::uint32_t mask = (length >= 16) ? 0xFFFF : ((1u << length) - 1);
+	if (mnemonic.remaining() >= REGISTER_LIST_MAX) {
+		mnemonic.commit(write_register_list(mnemonic.tail(), register_list & mask));
+		return;
 	}
-
-	return mnemonic;
+	char buffer[REGISTER_LIST_MAX];
+	mnemonic += std::string_view(buffer, write_register_list(buffer, register_list & mask));
 }
 
 std::uint32_t totr::Disassembler::read_word32_at(std::span<const std::uint8_t> rom, std::uint32_t pc) {
-	if (pc + 3 >= rom.size()) {
-		return std::uint32_t(rom[pc]) | (std::uint32_t(rom[pc + 1]) << 8);
-	}
-	return std::uint32_t(rom[pc]) |
-		(std::uint32_t(rom[pc + 1]) << 8) |
-		(std::uint32_t(rom[pc + 2]) << 16) |
-		(std::uint32_t(rom[pc + 3]) << 24);
+	return LittleEndianReader{ rom }.read_word(pc);
 }
@@ -0,0 +1,178 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <totr/disassembler/Common.hpp>
+#include <totr/disassembler/DataRenderer.hpp>
+
+namespace td = totr::Disassembler;
+
+namespace {
+	constexpr std::uint32_t MIN_STRING = 4;      // Shorter printable runs are left to .word / .byte
+	constexpr std::uint32_t MAX_STRING_ROW = 48; // Characters per .ascii row
+	constexpr std::uint32_t WORDS_PER_ROW = 4;
+
+	std::uint32_t byte_swap(std::uint32_t value) {
+		return (value >> 24) | ((value >> 8) & 0xFF00) | ((value << 8) & 0xFF0000) | (value << 24);
+	}
+
+	// Per-byte and per-word classes of one region, computed up front in flat loops the compiler
+	// vectorises; the split below only reads them.
+	struct DataClasses {
+		std::uint32_t first;
+		std::uint32_t aligned;                // First word boundary at or after `first`
+		std::vector<std::uint32_t> run;       // Printable characters starting at each byte
+		std::vector<std::uint8_t> pointer;    // Aligned word holds a ROM bus address
+
+		std::uint32_t string_at(std::uint32_t offset) const { return run[offset - first]; }
+		bool pointer_at(std::uint32_t offset) const {
+			const std::uint32_t index = (offset - aligned) / 4;
+			return index < pointer.size() && pointer[index];
+		}
+	};
+
+	template <std::endian Order>
+	DataClasses classify(const td::MemoryReader<Order>& memory, std::uint32_t first, std::uint32_t last) {
+		const std::uint8_t* bytes = memory.bytes().data();
+		const std::uint32_t size = last - first;
+
+		DataClasses classes{ first, (first + 3) & ~3u, {}, {} };
+		std::vector<std::uint8_t> printable(size);
+		for (std::uint32_t i = 0; i < size; ++i) {
+			const std::uint8_t byte = bytes[first + i];
+			printable[i] = (byte >= 0x20) & (byte <= 0x7E);
+		}
+		classes.run.assign(size + 1, 0);
+		for (std::uint32_t i = size; i-- > 0; ) classes.run[i] = printable[i] ? classes.run[i + 1] + 1 : 0;
+
+		const std::uint32_t words = (last >= classes.aligned) ? (last - classes.aligned) / 4 : 0;
+		classes.pointer.resize(words);
+		for (std::uint32_t i = 0; i < words; ++i) {
+			std::uint32_t value;
+			std::memcpy(&value, bytes + classes.aligned + i * 4, 4);
+			if constexpr (Order != std::endian::native) value = byte_swap(value);
+			classes.pointer[i] = (value >> 25) == (0x08000000 >> 25); // 0x08000000-0x09FFFFFF
+		}
+		return classes;
+	}
+
+	void append_hex_list(std::string& line, const char* directive, const std::uint32_t* values, std::uint32_t count, int digits) {
+		char hex[12];
+		line += directive;
+		for (std::uint32_t i = 0; i < count; ++i) {
+			if (i) line += ", ";
+			line.append(hex, td::format_hex_fixed(hex, values[i], digits));
+		}
+	}
+}
+
+template <std::endian Order>
+std::vector<td::DataRow> td::split_data(const MemoryReader<Order>& memory, std::uint32_t first, std::uint32_t last) {
+	std::vector<DataRow> rows;
+	last = std::min<std::uint32_t>(last, static_cast<std::uint32_t>(memory.size()));
+	if (first >= last) return rows;
+
+	const DataClasses classes = classify(memory, first, last);
+	const auto string_starts = [&](std::uint32_t offset) { return offset < last && classes.string_at(offset) >= MIN_STRING; };
+	const auto table_starts = [&](std::uint32_t offset) { return classes.pointer_at(offset) && classes.pointer_at(offset + 4); };
+
+	DataKind previous = DataKind::Bytes;
+	bool split_string = false; // The last row ended inside a string too long for one row
+	std::uint32_t pos = first;
+	while (pos < last) {
+		// Strings, continuing a long one across rows
+		const std::uint32_t characters = classes.string_at(pos);
+		if (characters >= MIN_STRING || (split_string && characters > 0)) {
+			std::uint32_t size = std::min(characters, MAX_STRING_ROW);
+			if (size == characters && pos + size < last && memory.bytes()[pos + size] == 0) ++size;
+			rows.push_back({ pos, size, DataKind::Ascii });
+			pos += size;
+			previous = DataKind::Ascii;
+			split_string = size < characters;
+			continue;
+		}
+
+		// Pointer tables
+		if (!(pos & 3) && (table_starts(pos) || (previous == DataKind::Pointers && classes.pointer_at(pos)))) {
+			std::uint32_t size = 0;
+			while (size < WORDS_PER_ROW * 4 && classes.pointer_at(pos + size)) size += 4;
+			rows.push_back({ pos, size, DataKind::Pointers });
+			pos += size;
+			previous = DataKind::Pointers;
+			split_string = false;
+			continue;
+		}
+
+		// Words, stopping where a string or a pointer table begins
+		std::uint32_t size = 0;
+		if (!(pos & 3)) {
+			while (size < WORDS_PER_ROW * 4 && pos + size + 4 <= last) {
+				const std::uint32_t word = pos + size;
+				if (size && table_starts(word)) break;
+				if (string_starts(word) || string_starts(word + 1) || string_starts(word + 2) || string_starts(word + 3)) break;
+				size += 4;
+			}
+		}
+		if (size) {
+			rows.push_back({ pos, size, DataKind::Words });
+		}
+		else if (!(pos & 1) && pos + 2 <= last && (pos & 3 || last - pos < 4) && !string_starts(pos + 1)) {
+			size = 2;
+			rows.push_back({ pos, size, DataKind::Halfwords });
+		}
+		else {
+			// Up to the next word boundary or string
+			const std::uint32_t boundary = std::min(last, (pos + 4) & ~3u);
+			while (pos + size < boundary && (size == 0 || !string_starts(pos + size))) ++size;
+			rows.push_back({ pos, size, DataKind::Bytes });
+		}
+		pos += size;
+		previous = rows.back().kind;
+		split_string = false;
+	}
+	return rows;
+}
+
+template <std::endian Order>
+void td::append_data_row(std::string& line, const MemoryReader<Order>& memory, const DataRow& row) {
+	std::uint32_t values[WORDS_PER_ROW * 4];
+	switch (row.kind) {
+		case DataKind::Words:
+		case DataKind::Pointers: {
+			const std::uint32_t count = std::min(row.size / 4, WORDS_PER_ROW);
+			for (std::uint32_t i = 0; i < count; ++i) values[i] = memory.read_word(row.offset + i * 4);
+			append_hex_list(line, ".word ", values, count, 8);
+			break;
+		}
+		case DataKind::Halfwords: {
+			const std::uint32_t count = std::min(row.size / 2, WORDS_PER_ROW * 2);
+			for (std::uint32_t i = 0; i < count; ++i) values[i] = memory.read_halfword(row.offset + i * 2);
+			append_hex_list(line, ".hword ", values, count, 4);
+			break;
+		}
+		case DataKind::Bytes: {
+			const std::uint32_t count = std::min(row.size, WORDS_PER_ROW * 4);
+			for (std::uint32_t i = 0; i < count; ++i) values[i] = memory.bytes()[row.offset + i];
+			append_hex_list(line, ".byte ", values, count, 2);
+			break;
+		}
+		case DataKind::Ascii: {
+			const char* text = reinterpret_cast<const char*>(memory.bytes().data() + row.offset);
+			const bool terminated = text[row.size - 1] == '\0';
+			line += terminated ? ".asciz \"" : ".ascii \"";
+			for (std::uint32_t i = 0; i < row.size - terminated; ++i) {
+				if (text[i] == '"' || text[i] == '\\') line += '\\';
+				line += text[i];
+			}
+			line += '"';
+			break;
+		}
+	}
+}
+
+template std::vector<td::DataRow> td::split_data(const td::LittleEndianReader&, std::uint32_t, std::uint32_t);
+template std::vector<td::DataRow> td::split_data(const td::BigEndianReader&, std::uint32_t, std::uint32_t);
+template void td::append_data_row(std::string&, const td::LittleEndianReader&, const td::DataRow&);
+template void td::append_data_row(std::string&, const td::BigEndianReader&, const td::DataRow&);
@@ -0,0 +1,432 @@
+#include <totr/disassembler/DisassemblyServer.hpp>
+
+#ifdef TOTR_HAVE_UNIX_SOCKETS
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <set>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace td = totr::Disassembler;
+
+namespace {
+	constexpr std::uint32_t MAX_REQUEST_SIZE = 1 << 16;
+	constexpr std::size_t HEADER_SIZE = 4;
+	constexpr std::uint32_t MAX_DECODE_COUNT = 1 << 16;
+	constexpr int POLL_INTERVAL_MS = 100;
+	constexpr int SEND_TIMEOUT_MS = 5000;
+	constexpr std::uint8_t PC = 15;
+
+#ifdef MSG_NOSIGNAL
+	constexpr int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+	constexpr int SEND_FLAGS = 0; // The caller ignores SIGPIPE
+#endif
+
+	std::vector<std::string_view> split(std::string_view text) {
+		std::vector<std::string_view> tokens;
+		std::size_t pos = 0;
+		while ((pos = text.find_first_not_of(" \t\r\n", pos)) != std::string_view::npos) {
+			const std::size_t end = std::min(text.find_first_of(" \t\r\n", pos), text.size());
+			tokens.push_back(text.substr(pos, end - pos));
+			pos = end;
+		}
+		return tokens;
+	}
+
+	std::uint32_t parse_number(std::string_view token) {
+		const std::string text(token);
+		std::size_t used = 0;
+		unsigned long value = 0;
+		try {
+			value = std::stoul(text, &used, 0);
+		}
+		catch (const std::exception&) {
+			used = 0;
+		}
+		if (used != text.size() || value > 0xFFFFFFFFul) throw std::invalid_argument("bad number: " + text);
+		return static_cast<std::uint32_t>(value);
+	}
+
+	void append_hex(std::string& out, std::uint32_t value) {
+		char digits[12];
+		out += '#';
+		out.append(digits, td::format_hex_fixed(digits, value, 8));
+	}
+
+	enum class Frame { Partial, Ready, TooLarge };
+
+	// Appends what a non-blocking connection has buffered, stopping once `buffer` holds a frame of
+	// the largest size; false once the peer has closed the connection or it failed
+	bool receive(int fd, std::string& buffer) {
+		char chunk[4096];
+		while (buffer.size() < HEADER_SIZE + MAX_REQUEST_SIZE) {
+			const ssize_t got = ::recv(fd, chunk, sizeof(chunk), 0);
+			if (got > 0) buffer.append(chunk, static_cast<std::size_t>(got));
+			else if (got < 0 && errno == EINTR) continue;
+			else return got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+		}
+		return true;
+	}
+
+	// Moves the body of the first frame in `buffer` to `request` once all of it has arrived
+	Frame next_frame(std::string& buffer, std::string& request) {
+		if (buffer.size() < HEADER_SIZE) return Frame::Partial;
+		const auto* header = reinterpret_cast<const std::uint8_t*>(buffer.data());
+		const std::uint32_t size = header[0] | (header[1] << 8) | (header[2] << 16) | (std::uint32_t(header[3]) << 24);
+		if (size > MAX_REQUEST_SIZE) return Frame::TooLarge;
+		if (buffer.size() < HEADER_SIZE + size) return Frame::Partial;
+
+		request.assign(buffer, HEADER_SIZE, size);
+		buffer.erase(0, HEADER_SIZE + size);
+		return Frame::Ready;
+	}
+
+	// Connections are non-blocking; one whose client stops reading is given up after SEND_TIMEOUT_MS
+	bool write_exact(int fd, const void* buffer, std::size_t size) {
+		const auto* bytes = static_cast<const std::uint8_t*>(buffer);
+		while (size != 0) {
+			const ssize_t sent = ::send(fd, bytes, size, SEND_FLAGS);
+			if (sent < 0 && errno == EINTR) continue;
+			if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+				pollfd writable{ fd, POLLOUT, 0 };
+				if (::poll(&writable, 1, SEND_TIMEOUT_MS) > 0) continue;
+				return false;
+			}
+			if (sent <= 0) return false;
+			bytes += sent;
+			size -= static_cast<std::size_t>(sent);
+		}
+		return true;
+	}
+
+	// Frame lengths are little-endian on the wire whatever the host order
+	bool write_frame(int fd, std::string_view body) {
+		const std::uint32_t size = static_cast<std::uint32_t>(body.size());
+		const std::uint8_t header[4] = { std::uint8_t(size), std::uint8_t(size >> 8), std::uint8_t(size >> 16), std::uint8_t(size >> 24) };
+		return write_exact(fd, header, sizeof(header)) && write_exact(fd, body.data(), body.size());
+	}
+}
+
+template <std::endian Order>
+td::DisassemblyServer<Order>::Image::Image(ServerImage image, const SymbolTable& symbols,
+	const std::unordered_map<std::uint32_t, ArmMode>& overrides, const ServerOptions& options)
+	: name(std::move(image.name)), bytes(std::move(image.bytes)), memory(std::span<const std::uint8_t>{ bytes }),
+	  sweep(memory, symbols, options.base_address, overrides, options.track_registers) {
+	sweep.run();
+}
+
+template <std::endian Order>
+td::DisassemblyServer<Order>::DisassemblyServer(std::vector<ServerImage> images, SymbolTable symbols,
+	const std::unordered_map<std::uint32_t, ArmMode>& overrides, ServerOptions options)
+	: m_symbols(std::move(symbols)), m_options(options), m_arm(options.hex_literals), m_thumb(options.hex_literals) {
+	for (ServerImage& image : images) {
+		m_images.push_back(std::make_unique<Image>(std::move(image), m_symbols, overrides, m_options));
+		index_xrefs(*m_images.back());
+	}
+}
+
+template <std::endian Order>
+td::DisassemblyServer<Order>::~DisassemblyServer() = default;
+
+// Branch and BL destinations, tracked BX destinations and PC-relative literal loads, keyed by
+// what they refer to. Rebuilt whole after an override: a flat sort is a few milliseconds even on
+// a 32 MB image and keeps lookups to one binary search.
+template <std::endian Order>
+void td::DisassemblyServer<Order>::index_xrefs(Image& image) const {
+	image.xrefs.clear();
+
+	for (const SweepEntry& entry : image.sweep.entries()) {
+		const std::uint32_t pc = m_options.base_address + entry.offset;
+		const DecodedFields fields = image.sweep.fields(entry);
+		if (!fields.is_valid()) continue;
+
+		if (fields.flags & DecodeFlag::HasTarget) {
+			image.xrefs.push_back({ fields.imm, pc, (fields.flags & DecodeFlag::Link) ? "call" : "branch" });
+		}
+		else if (fields.flags & DecodeFlag::BranchExchange) {
+			if (auto target = image.sweep.tracked_target(entry.offset)) image.xrefs.push_back({ target->address, pc, "bx" });
+		}
+		else if (fields.format == InstrFormat::ArmSingleDataTrans && fields.rn == PC
+			&& (fields.flags & (DecodeFlag::Load | DecodeFlag::PreIndex | DecodeFlag::Immediate | DecodeFlag::WriteBack))
+				== (DecodeFlag::Load | DecodeFlag::PreIndex | DecodeFlag::Immediate)) {
+			image.xrefs.push_back({ (fields.flags & DecodeFlag::AddOffset) ? pc + 8 + fields.imm : pc + 8 - fields.imm, pc, "load" });
+		}
+		else if (fields.format == InstrFormat::ThumbPcRelLoad) {
+			image.xrefs.push_back({ ((pc + 4) & ~2u) + fields.imm, pc, "load" });
+		}
+	}
+
+	std::sort(image.xrefs.begin(), image.xrefs.end(), [](const Xref& a, const Xref& b) {
+		return a.target != b.target ? a.target < b.target : a.source < b.source;
+	});
+}
+
+// Index of the sweep entry covering bus address `address`
+template <std::endian Order>
+std::size_t td::DisassemblyServer<Order>::find_entry(const Image& image, std::uint32_t address) const {
+	const std::vector<SweepEntry>& entries = image.sweep.entries();
+	const std::uint32_t offset = address - m_options.base_address;
+	if (address < m_options.base_address || offset >= image.bytes.size() || entries.empty()) {
+		throw std::out_of_range("address outside the image");
+	}
+
+	auto it = std::upper_bound(entries.begin(), entries.end(), offset,
+		[](std::uint32_t value, const SweepEntry& entry) { return value < entry.offset; });
+	if (it == entries.begin() || offset >= std::prev(it)->offset + std::prev(it)->size) {
+		throw std::out_of_range("address is not inside an instruction");
+	}
+	return static_cast<std::size_t>(std::prev(it) - entries.begin());
+}
+
+template <std::endian Order>
+std::string td::DisassemblyServer<Order>::handle(std::string_view request) {
+	const std::vector<std::string_view> args = split(request);
+	std::string reply = "ok\n";
+
+	try {
+		if (args.empty()) throw std::invalid_argument("empty request");
+		const std::string_view command = args[0];
+
+		if (command == "roms") {
+			for (std::size_t index = 0; index < m_images.size(); ++index) {
+				reply += std::to_string(index) + ' ' + std::to_string(m_images[index]->bytes.size()) + ' ' + m_images[index]->name + '\n';
+			}
+			return reply;
+		}
+
+		if (command != "decode" && command != "mode" && command != "xrefs" && command != "override") {
+			throw std::invalid_argument("unknown command: " + std::string(command));
+		}
+		if (args.size() < 3) throw std::invalid_argument("expected: " + std::string(command) + " <rom> <address> ...");
+		const std::uint32_t index = parse_number(args[1]);
+		if (index >= m_images.size()) throw std::out_of_range("no rom " + std::string(args[1]));
+		Image& image = *m_images[index];
+		const std::uint32_t address = parse_number(args[2]);
+
+		if (command == "decode") {
+			const std::uint32_t count = (args.size() > 3) ? parse_number(args[3]) : 1;
+			if (count > MAX_DECODE_COUNT) throw std::out_of_range("count above " + std::to_string(MAX_DECODE_COUNT));
+
+			std::shared_lock lock(image.mutex);
+			const std::vector<SweepEntry>& entries = image.sweep.entries();
+			InstructionData data;
+			const std::size_t first = find_entry(image, address);
+			for (std::size_t i = first; i < entries.size() && i - first < count; ++i) {
+				const SweepEntry& entry = entries[i];
+				const std::uint32_t pc = m_options.base_address + entry.offset;
+				if (entry.mode() == ArmMode::ARM) m_arm.decode(pc, image.memory.fetch_arm(entry.offset), data);
+				else m_thumb.decode(pc, image.memory.fetch_thumb(entry.offset), data);
+
+				append_hex(reply, pc);
+				reply += " : ";
+				append_hex(reply, data.instruction);
+				reply += " : ";
+				reply += data.mnemonic.view();
+				reply += '\n';
+			}
+		}
+		else if (command == "mode") {
+			std::shared_lock lock(image.mutex);
+			const SweepEntry& entry = image.sweep.entries()[find_entry(image, address)];
+			reply += (entry.mode() == ArmMode::ARM) ? "ARM\n" : "THUMB\n";
+		}
+		else if (command == "xrefs") {
+			std::shared_lock lock(image.mutex);
+			auto it = std::lower_bound(image.xrefs.begin(), image.xrefs.end(), address,
+				[](const Xref& xref, std::uint32_t value) { return xref.target < value; });
+			for (; it != image.xrefs.end() && it->target == address; ++it) {
+				append_hex(reply, it->source);
+				reply += " : ";
+				reply += it->kind;
+				reply += '\n';
+			}
+		}
+		else if (command == "override") {
+			if (args.size() < 4) throw std::invalid_argument("expected: override <rom> <address> arm|thumb|clear");
+
+			std::unique_lock lock(image.mutex);
+			std::size_t decoded;
+			if (args[3] == "arm") decoded = image.sweep.set_override(address, ArmMode::ARM);
+			else if (args[3] == "thumb") decoded = image.sweep.set_override(address, ArmMode::THUMB);
+			else if (args[3] == "clear") decoded = image.sweep.remove_override(address);
+			else throw std::invalid_argument("expected arm, thumb or clear: " + std::string(args[3]));
+
+			if (decoded != 0) index_xrefs(image);
+			reply += "decoded " + std::to_string(decoded) + '\n';
+		}
+	}
+	catch (const std::exception& e) {
+		return std::string("error ") + e.what() + '\n';
+	}
+	return reply;
+}
+
+template <std::endian Order>
+void td::DisassemblyServer<Order>::serve(const std::string& socket_path) {
+	sockaddr_un address{};
+	address.sun_family = AF_UNIX;
+	if (socket_path.size() >= sizeof(address.sun_path)) throw std::runtime_error("Socket path too long: " + socket_path);
+	std::memcpy(address.sun_path, socket_path.c_str(), socket_path.size() + 1);
+
+	int wake[2];
+	if (::pipe(wake) != 0) throw std::runtime_error(std::string("Cannot create pipe: ") + std::strerror(errno));
+	// A full pipe already means "wake up", so neither end may block
+	::fcntl(wake[0], F_SETFL, O_NONBLOCK);
+	::fcntl(wake[1], F_SETFL, O_NONBLOCK);
+	const int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+	if (listener < 0) {
+		const std::string reason = std::strerror(errno);
+		::close(wake[0]);
+		::close(wake[1]);
+		throw std::runtime_error("Cannot create socket: " + reason);
+	}
+	::unlink(socket_path.c_str());
+	if (::bind(listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || ::listen(listener, SOMAXCONN) != 0) {
+		const std::string reason = std::strerror(errno);
+		::close(listener);
+		::close(wake[0]);
+		::close(wake[1]);
+		throw std::runtime_error("Cannot listen on " + socket_path + ": " + reason);
+	}
+
+	// Connections are read here without blocking, each into its own buffer. Once a buffer holds a
+	// whole request the connection leaves the poll set and the request goes to a worker, which
+	// answers it and returns the connection through `returned` (or `dropped` when the reply could
+	// not be sent). Workers never wait for a client to send, so a few of them serve any number of
+	// open connections, and one request per connection is in flight so replies keep their order.
+	std::mutex queue_mutex;
+	std::condition_variable queue_ready;
+	std::deque<std::pair<int, std::string>> ready;
+	std::vector<int> returned;
+	std::vector<int> dropped;
+	bool closing = false;
+
+	const auto work = [&] {
+		for (;;) {
+			std::pair<int, std::string> job;
+			{
+				std::unique_lock lock(queue_mutex);
+				queue_ready.wait(lock, [&] { return closing || !ready.empty(); });
+				if (closing) return;
+				job = std::move(ready.front());
+				ready.pop_front();
+			}
+			const bool keep = write_frame(job.first, handle(job.second));
+			{
+				std::lock_guard lock(queue_mutex);
+				(keep ? returned : dropped).push_back(job.first);
+			}
+			const char token = 0;
+			::write(wake[1], &token, 1);
+		}
+	};
+
+	const unsigned thread_count = m_options.thread_count ? m_options.thread_count : std::max(1u, std::thread::hardware_concurrency());
+	std::vector<std::thread> workers;
+	for (unsigned i = 0; i < thread_count; ++i) workers.emplace_back(work);
+
+	// Partial frames by connection; only this thread touches them
+	std::unordered_map<int, std::string> received;
+	std::vector<pollfd> polled{ { listener, POLLIN, 0 }, { wake[0], POLLIN, 0 } };
+
+	const auto close_connection = [&](int fd) {
+		received.erase(fd);
+		::close(fd);
+	};
+
+	// Hands the next request of `fd` to a worker once it is complete, otherwise polls for more;
+	// called with queue_mutex held
+	const auto dispatch = [&](int fd, bool open) {
+		std::string request;
+		switch (next_frame(received[fd], request)) {
+		case Frame::Ready:
+			ready.emplace_back(fd, std::move(request));
+			queue_ready.notify_one();
+			break;
+		case Frame::TooLarge:
+			write_frame(fd, "error request too large\n");
+			close_connection(fd);
+			break;
+		case Frame::Partial:
+			if (open) polled.push_back({ fd, POLLIN, 0 });
+			else close_connection(fd);
+			break;
+		}
+	};
+
+	while (!m_stopping.load()) {
+		if (::poll(polled.data(), polled.size(), POLL_INTERVAL_MS) <= 0) continue;
+
+		if (polled[1].revents & POLLIN) {
+			char drain[64];
+			while (::read(wake[0], drain, sizeof(drain)) == static_cast<ssize_t>(sizeof(drain))) {}
+		}
+
+		std::lock_guard lock(queue_mutex);
+		std::vector<pollfd> readable;
+		for (std::size_t i = 2; i < polled.size();) {
+			if (polled[i].revents & (POLLIN | POLLHUP | POLLERR)) {
+				readable.push_back(polled[i]);
+				polled[i] = polled.back();
+				polled.pop_back();
+			}
+			else {
+				++i;
+			}
+		}
+		for (const pollfd& entry : readable) dispatch(entry.fd, receive(entry.fd, received[entry.fd]));
+
+		// A returned connection may already have buffered its next request
+		for (int fd : returned) dispatch(fd, true);
+		returned.clear();
+		for (int fd : dropped) close_connection(fd);
+		dropped.clear();
+
+		if (polled[0].revents & POLLIN) {
+			const int fd = ::accept(listener, nullptr, nullptr);
+			if (fd >= 0) {
+				::fcntl(fd, F_SETFL, O_NONBLOCK);
+				polled.push_back({ fd, POLLIN, 0 });
+			}
+		}
+		for (pollfd& entry : polled) entry.revents = 0;
+	}
+
+	// Let requests in progress finish, then drop every connection
+	{
+		std::unique_lock lock(queue_mutex);
+		closing = true;
+		for (const auto& job : ready) ::close(job.first);
+		ready.clear();
+	}
+	queue_ready.notify_all();
+	for (std::thread& worker : workers) worker.join();
+
+	for (int fd : returned) ::close(fd);
+	for (int fd : dropped) ::close(fd);
+	for (std::size_t i = 2; i < polled.size(); ++i) ::close(polled[i].fd);
+	::close(listener);
+	::close(wake[0]);
+	::close(wake[1]);
+	::unlink(socket_path.c_str());
+	m_stopping.store(false);
+}
+
+template class td::DisassemblyServer<std::endian::little>;
+template class td::DisassemblyServer<std::endian::big>;
+
+#endif // TOTR_HAVE_UNIX_SOCKETS
@@ -0,0 +1,170 @@
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <istream>
+#include <iterator>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <totr/disassembler/ExecutionTrace.hpp>
+
+namespace td = totr::Disassembler;
+
+namespace {
+	constexpr std::size_t CHUNK_RECORDS = 1 << 22; // 16 MB of trace per chunk
+	constexpr std::size_t MIN_RECORDS_PER_THREAD = 1 << 16;
+	constexpr unsigned RECENT_BITS = 12;
+	constexpr std::size_t RECENT_SLOTS = std::size_t{ 1 } << RECENT_BITS;
+
+	// Fills `chunk` with up to CHUNK_RECORDS normalised records; fewer only at the end of the stream
+	void read_chunk(std::istream& in, std::vector<std::uint32_t>& chunk) {
+		chunk.resize(CHUNK_RECORDS);
+		in.read(reinterpret_cast<char*>(chunk.data()), static_cast<std::streamsize>(CHUNK_RECORDS * 4));
+		const std::size_t bytes = static_cast<std::size_t>(in.gcount());
+		if (in.bad()) throw std::runtime_error("Failed while reading trace.");
+		if (bytes % 4 != 0) throw std::runtime_error("Trace ends in a partial record.");
+		chunk.resize(bytes / 4);
+
+		for (std::uint32_t& record : chunk) {
+			const auto* p = reinterpret_cast<const std::uint8_t*>(&record);
+			const std::uint32_t value = std::uint32_t(p[0]) | (std::uint32_t(p[1]) << 8) | (std::uint32_t(p[2]) << 16) | (std::uint32_t(p[3]) << 24);
+			record = td::trace_record(value, (value & 1) ? td::ArmMode::THUMB : td::ArmMode::ARM);
+		}
+	}
+
+	std::vector<std::uint32_t> merge_unique(const std::vector<std::uint32_t>& a, const std::vector<std::uint32_t>& b) {
+		std::vector<std::uint32_t> merged;
+		merged.reserve(a.size() + b.size());
+		std::set_union(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(merged));
+		return merged;
+	}
+
+	// Drops records seen recently: a direct-mapped table of the last record per hash slot catches
+	// the repeats of hot loops before they reach the sort
+	void drop_recent(std::vector<std::uint32_t>& run) {
+		std::vector<std::uint32_t> recent(RECENT_SLOTS, 0xFFFFFFFF);
+		std::size_t kept = 0;
+		for (std::uint32_t record : run) {
+			std::uint32_t& slot = recent[(record * 0x9E3779B1u) >> (32 - RECENT_BITS)];
+			if (slot == record) continue;
+			slot = record;
+			run[kept++] = record;
+		}
+		run.resize(kept);
+	}
+
+	// LSD radix sort in three 11-bit digits, using `scratch` as the other buffer
+	void radix_sort(std::vector<std::uint32_t>& run, std::vector<std::uint32_t>& scratch) {
+		scratch.resize(run.size());
+		for (unsigned shift = 0; shift < 32; shift += 11) {
+			std::vector<std::size_t> counts(1 << 11, 0);
+			for (std::uint32_t record : run) ++counts[(record >> shift) & 0x7FF];
+			std::size_t total = 0;
+			for (std::size_t& count : counts) total += std::exchange(count, total);
+			for (std::uint32_t record : run) scratch[counts[(record >> shift) & 0x7FF]++] = record;
+			run.swap(scratch);
+		}
+	}
+
+	// Sorted, duplicate-free contents of `chunk`: each share is filtered and sorted on its own
+	// thread, then neighbouring shares are merged pairwise, one thread per pair, until one run is left
+	std::vector<std::uint32_t> sort_unique(const std::vector<std::uint32_t>& chunk, unsigned thread_count) {
+		const std::size_t shares = std::max<std::size_t>(1, std::min<std::size_t>(thread_count, chunk.size() / MIN_RECORDS_PER_THREAD));
+		const std::size_t per_share = (chunk.size() + shares - 1) / shares;
+		std::vector<std::vector<std::uint32_t>> runs(shares);
+
+		const auto sort_share = [&](std::size_t share) {
+			const std::size_t first = std::min(chunk.size(), share * per_share);
+			const std::size_t last = std::min(chunk.size(), first + per_share);
+			std::vector<std::uint32_t>& run = runs[share];
+			std::vector<std::uint32_t> scratch;
+			run.assign(chunk.begin() + first, chunk.begin() + last);
+			drop_recent(run);
+			radix_sort(run, scratch);
+			run.erase(std::unique(run.begin(), run.end()), run.end());
+		};
+
+		std::vector<std::thread> workers;
+		for (std::size_t share = 1; share < shares; ++share) workers.emplace_back(sort_share, share);
+		sort_share(0);
+		for (std::thread& worker : workers) worker.join();
+
+		while (runs.size() > 1) {
+			std::vector<std::vector<std::uint32_t>> merged((runs.size() + 1) / 2);
+			workers.clear();
+			for (std::size_t pair = 1; pair < runs.size() / 2; ++pair) {
+				workers.emplace_back([&, pair] { merged[pair] = merge_unique(runs[2 * pair], runs[2 * pair + 1]); });
+			}
+			merged[0] = merge_unique(runs[0], runs[1]);
+			if (runs.size() % 2) merged.back() = std::move(runs.back());
+			for (std::thread& worker : workers) worker.join();
+			runs = std::move(merged);
+		}
+		return std::move(runs[0]);
+	}
+}
+
+td::ExecutionTrace td::ExecutionTrace::read(std::istream& in, unsigned thread_count) {
+	if (thread_count == 0) thread_count = std::max(1u, std::thread::hardware_concurrency());
+
+	ExecutionTrace trace;
+	std::vector<std::uint32_t> current;
+	std::vector<std::uint32_t> next;
+	read_chunk(in, current);
+
+	while (!current.empty()) {
+		// Overlap reading the next chunk with sorting this one; the reader takes one of the threads
+		std::exception_ptr read_error;
+		std::thread reader([&] {
+			try {
+				if (in) read_chunk(in, next);
+				else next.clear();
+			}
+			catch (...) {
+				read_error = std::current_exception();
+			}
+		});
+
+		trace.m_steps += current.size();
+		std::vector<std::uint32_t> sorted = sort_unique(current, std::max(1u, thread_count - 1));
+		trace.m_records = trace.m_records.empty() ? std::move(sorted) : merge_unique(trace.m_records, sorted);
+
+		reader.join();
+		if (read_error) std::rethrow_exception(read_error);
+		std::swap(current, next);
+	}
+	return trace;
+}
+
+bool td::ExecutionTrace::executed(std::uint32_t address, ArmMode mode) const {
+	return std::binary_search(m_records.begin(), m_records.end(), trace_record(address, mode));
+}
+
+std::unordered_map<std::uint32_t, td::ArmMode> td::ExecutionTrace::mode_overrides() const {
+	std::unordered_map<std::uint32_t, ArmMode> overrides;
+
+	std::uint32_t run_end = 0;
+	ArmMode run_mode = ArmMode::ARM;
+	bool in_run = false;
+	for (std::size_t i = 0; i < m_records.size(); ++i) {
+		const std::uint32_t address = m_records[i] & ~1u;
+		const ArmMode mode = (m_records[i] & 1) ? ArmMode::THUMB : ArmMode::ARM;
+
+		// ARM sorts before THUMB at the same address, so a conflict is always adjacent
+		const bool both_modes = (i + 1 < m_records.size() && (m_records[i + 1] & ~1u) == address)
+			|| (i > 0 && (m_records[i - 1] & ~1u) == address);
+		if (both_modes) {
+			in_run = false;
+			continue;
+		}
+
+		if (!in_run || address != run_end || mode != run_mode) overrides.emplace(address, mode);
+		run_end = address + ((mode == ArmMode::ARM) ? 4 : 2);
+		run_mode = mode;
+		in_run = true;
+	}
+	return overrides;
+}
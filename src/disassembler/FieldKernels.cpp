@@ -0,0 +1,225 @@
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+#include <totr/disassembler/ArmDisasm.hpp>
+#include <totr/disassembler/FieldKernels.hpp>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define TOTR_FIELD_KERNELS_X86
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define TOTR_TARGET(isa)
+#else
+#define TOTR_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+
+namespace td = totr::Disassembler;
+
+namespace {
+	/*
+	Apart from BX, MRS and MSR every ARM format is decided by Bit 27-20 and 7-4 alone, so the SIMD
+	kernels classify with one lookup into a 4096 entry table built from ArmDisasm::classify. Words
+	the table marks as data processing are then checked against the exact BX/MRS/MSR encodings.
+	*/
+	struct ExactRule {
+		std::uint32_t mask;
+		std::uint32_t test;
+		td::InstrFormat format;
+	};
+
+	constexpr ExactRule ARM_EXACT_RULES[] = {
+		{ 0x0FFFFFF0, 0x012FFF10, td::InstrFormat::ArmBranchExchange },
+		{ 0x0FBF0FFF, 0x010F0000, td::InstrFormat::ArmPsrMrs },
+		{ 0x0FBFFFF0, 0x0129F000, td::InstrFormat::ArmPsrMsrReg },
+		{ 0x0DBFF000, 0x0128F000, td::InstrFormat::ArmPsrMsrImm },
+	};
+
+	constexpr std::uint32_t table_index(std::uint32_t instr) {
+		return ((instr >> 16) & 0xFF0) | ((instr >> 4) & 0xF);
+	}
+
+	const std::uint32_t* arm_format_table() {
+		static const auto table = [] {
+			std::array<std::uint32_t, 4096> formats{};
+			for (std::uint32_t index = 0; index < formats.size(); ++index) {
+				const std::uint32_t instr = ((index & 0xFF0) << 16) | ((index & 0xF) << 4);
+				formats[index] = static_cast<std::uint32_t>(td::ArmDisasm::classify(instr));
+			}
+			return formats;
+		}();
+		return table.data();
+	}
+
+	void extract_scalar(const std::uint32_t* instrs, std::size_t count, const td::DecodedBatch& out, std::size_t base) {
+		for (std::size_t i = 0; i < count; ++i) {
+			const std::uint32_t instr = instrs[i];
+			out.cond[base + i] = (instr >> 28) & 0xF;
+			out.rn[base + i] = (instr >> 16) & 0xF;
+			out.rd[base + i] = (instr >> 12) & 0xF;
+			out.rs[base + i] = (instr >> 8) & 0xF;
+			out.rm[base + i] = instr & 0xF;
+		}
+
+		const std::uint32_t* table = arm_format_table();
+		for (std::size_t i = 0; i < count; ++i) {
+			const std::uint32_t instr = instrs[i];
+			auto format = static_cast<td::InstrFormat>(table[table_index(instr)]);
+			if (format == td::InstrFormat::ArmDataProc) {
+				for (const ExactRule& rule : ARM_EXACT_RULES) {
+					if ((instr & rule.mask) == rule.test) { format = rule.format; break; }
+				}
+			}
+			out.format[base + i] = format;
+		}
+	}
+
+#ifdef TOTR_FIELD_KERNELS_X86
+	TOTR_TARGET("sse4.1")
+	void store_bytes_sse41(std::uint8_t* dest, __m128i lanes) {
+		// 4 x 32-bit lanes holding values below 256 -> 4 bytes
+		const __m128i words = _mm_packus_epi32(lanes, lanes);
+		const std::uint32_t packed = static_cast<std::uint32_t>(_mm_cvtsi128_si32(_mm_packus_epi16(words, words)));
+		std::memcpy(dest, &packed, 4);
+	}
+
+	TOTR_TARGET("sse4.1")
+	void extract_sse41(const std::uint32_t* instrs, std::size_t count, const td::DecodedBatch& out) {
+		const __m128i nibble = _mm_set1_epi32(0xF);
+		const __m128i data_proc = _mm_set1_epi32(static_cast<int>(td::InstrFormat::ArmDataProc));
+		const std::uint32_t* table = arm_format_table();
+
+		std::size_t i = 0;
+		for (; i + 4 <= count; i += 4) {
+			const __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i*>(instrs + i));
+			store_bytes_sse41(out.cond.data() + i, _mm_srli_epi32(w, 28));
+			store_bytes_sse41(out.rn.data() + i, _mm_and_si128(_mm_srli_epi32(w, 16), nibble));
+			store_bytes_sse41(out.rd.data() + i, _mm_and_si128(_mm_srli_epi32(w, 12), nibble));
+			store_bytes_sse41(out.rs.data() + i, _mm_and_si128(_mm_srli_epi32(w, 8), nibble));
+			store_bytes_sse41(out.rm.data() + i, _mm_and_si128(w, nibble));
+
+			const __m128i index = _mm_or_si128(_mm_and_si128(_mm_srli_epi32(w, 16), _mm_set1_epi32(0xFF0)), _mm_and_si128(_mm_srli_epi32(w, 4), nibble));
+			const __m128i looked_up = _mm_setr_epi32(
+				static_cast<int>(table[_mm_extract_epi32(index, 0)]), static_cast<int>(table[_mm_extract_epi32(index, 1)]),
+				static_cast<int>(table[_mm_extract_epi32(index, 2)]), static_cast<int>(table[_mm_extract_epi32(index, 3)]));
+
+			__m128i exact = _mm_setzero_si128();
+			__m128i exact_hit = _mm_setzero_si128();
+			for (const ExactRule& rule : ARM_EXACT_RULES) {
+				const __m128i hit = _mm_cmpeq_epi32(_mm_and_si128(w, _mm_set1_epi32(static_cast<int>(rule.mask))), _mm_set1_epi32(static_cast<int>(rule.test)));
+				exact = _mm_or_si128(exact, _mm_and_si128(hit, _mm_set1_epi32(static_cast<int>(rule.format))));
+				exact_hit = _mm_or_si128(exact_hit, hit);
+			}
+			const __m128i format = _mm_blendv_epi8(looked_up, exact, _mm_and_si128(exact_hit, _mm_cmpeq_epi32(looked_up, data_proc)));
+			store_bytes_sse41(reinterpret_cast<std::uint8_t*>(out.format.data() + i), format);
+		}
+		extract_scalar(instrs + i, count - i, out, i);
+	}
+
+	TOTR_TARGET("avx2")
+	void store_bytes_avx2(std::uint8_t* dest, __m256i lanes) {
+		// 8 x 32-bit lanes holding values below 256 -> 8 bytes. Packing works per 128-bit half,
+		// so the low dword of each half carries four results.
+		const __m256i words = _mm256_packus_epi32(lanes, lanes);
+		const __m256i bytes = _mm256_packus_epi16(words, words);
+		const std::uint32_t low = static_cast<std::uint32_t>(_mm256_extract_epi32(bytes, 0));
+		const std::uint32_t high = static_cast<std::uint32_t>(_mm256_extract_epi32(bytes, 4));
+		std::memcpy(dest, &low, 4);
+		std::memcpy(dest + 4, &high, 4);
+	}
+
+	TOTR_TARGET("avx2")
+	void extract_avx2(const std::uint32_t* instrs, std::size_t count, const td::DecodedBatch& out) {
+		const __m256i nibble = _mm256_set1_epi32(0xF);
+		const __m256i data_proc = _mm256_set1_epi32(static_cast<int>(td::InstrFormat::ArmDataProc));
+		const int* table = reinterpret_cast<const int*>(arm_format_table());
+
+		std::size_t i = 0;
+		for (; i + 8 <= count; i += 8) {
+			const __m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(instrs + i));
+			store_bytes_avx2(out.cond.data() + i, _mm256_srli_epi32(w, 28));
+			store_bytes_avx2(out.rn.data() + i, _mm256_and_si256(_mm256_srli_epi32(w, 16), nibble));
+			store_bytes_avx2(out.rd.data() + i, _mm256_and_si256(_mm256_srli_epi32(w, 12), nibble));
+			store_bytes_avx2(out.rs.data() + i, _mm256_and_si256(_mm256_srli_epi32(w, 8), nibble));
+			store_bytes_avx2(out.rm.data() + i, _mm256_and_si256(w, nibble));
+
+			const __m256i index = _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi32(w, 16), _mm256_set1_epi32(0xFF0)), _mm256_and_si256(_mm256_srli_epi32(w, 4), nibble));
+			const __m256i looked_up = _mm256_i32gather_epi32(table, index, 4);
+
+			__m256i exact = _mm256_setzero_si256();
+			__m256i exact_hit = _mm256_setzero_si256();
+			for (const ExactRule& rule : ARM_EXACT_RULES) {
+				const __m256i hit = _mm256_cmpeq_epi32(_mm256_and_si256(w, _mm256_set1_epi32(static_cast<int>(rule.mask))), _mm256_set1_epi32(static_cast<int>(rule.test)));
+				exact = _mm256_or_si256(exact, _mm256_and_si256(hit, _mm256_set1_epi32(static_cast<int>(rule.format))));
+				exact_hit = _mm256_or_si256(exact_hit, hit);
+			}
+			const __m256i format = _mm256_blendv_epi8(looked_up, exact, _mm256_and_si256(exact_hit, _mm256_cmpeq_epi32(looked_up, data_proc)));
+			store_bytes_avx2(reinterpret_cast<std::uint8_t*>(out.format.data() + i), format);
+		}
+		extract_scalar(instrs + i, count - i, out, i);
+	}
+
+	bool cpu_supports(td::FieldKernel kernel) {
+		if (kernel == td::FieldKernel::Scalar) return true;
+#if defined(_MSC_VER) && !defined(__clang__)
+		int regs[4];
+		__cpuid(regs, 1);
+		const bool sse41 = (regs[2] >> 19) & 1;
+		const bool os_avx = ((regs[2] >> 27) & 1) && ((regs[2] >> 28) & 1) && ((_xgetbv(0) & 0x6) == 0x6);
+		if (kernel == td::FieldKernel::SSE41) return sse41;
+		__cpuidex(regs, 7, 0);
+		return os_avx && ((regs[1] >> 5) & 1);
+#else
+		__builtin_cpu_init();
+		if (kernel == td::FieldKernel::SSE41) return __builtin_cpu_supports("sse4.1");
+		return __builtin_cpu_supports("avx2");
+#endif
+	}
+#else
+	bool cpu_supports(td::FieldKernel kernel) { return kernel == td::FieldKernel::Scalar; }
+#endif
+
+	td::FieldKernel best_kernel() {
+		if (cpu_supports(td::FieldKernel::AVX2)) return td::FieldKernel::AVX2;
+		if (cpu_supports(td::FieldKernel::SSE41)) return td::FieldKernel::SSE41;
+		return td::FieldKernel::Scalar;
+	}
+
+	std::atomic<td::FieldKernel>& kernel_slot() {
+		static std::atomic<td::FieldKernel> kernel{ best_kernel() };
+		return kernel;
+	}
+}
+
+void td::extract_arm_fields(std::span<const std::uint32_t> instrs, const DecodedBatch& out) {
+	switch (kernel_slot().load(std::memory_order_relaxed)) {
+#ifdef TOTR_FIELD_KERNELS_X86
+		case FieldKernel::AVX2: extract_avx2(instrs.data(), instrs.size(), out); return;
+		case FieldKernel::SSE41: extract_sse41(instrs.data(), instrs.size(), out); return;
+#endif
+		default: extract_scalar(instrs.data(), instrs.size(), out, 0); return;
+	}
+}
+
+td::FieldKernel td::active_field_kernel() {
+	return kernel_slot().load(std::memory_order_relaxed);
+}
+
+td::FieldKernel td::select_field_kernel(FieldKernel kernel) {
+	if (!cpu_supports(kernel)) kernel = best_kernel();
+	kernel_slot().store(kernel, std::memory_order_relaxed);
+	return kernel;
+}
+
+const char* td::get_field_kernel_name(FieldKernel kernel) {
+	switch (kernel) {
+		case FieldKernel::Scalar: return "scalar";
+		case FieldKernel::SSE41: return "sse4.1";
+		case FieldKernel::AVX2: return "avx2";
+	}
+	return "unknown";
+}
@@ -5,44 +5,328 @@
 #include <algorithm>
 #include <cctype>
 #include <cstdint>
+#include <cstring>
 #include <stdexcept>
+#include <array>
+#include <optional>
+#include <string_view>
+#include <utility>
+
+#ifdef TOTR_HAVE_ZLIB
+#include <zlib.h>
+#endif
 
 #include <totr/disassembler/FileUtil.hpp>
 
-std::unordered_map<std::uint32_t, totr::Disassembler::ArmMode> totr::Disassembler::load_overrides(const std::string& filepath) {
-    std::unordered_map<std::uint32_t, ArmMode> overrides;
+namespace {
+    constexpr std::size_t INPUT_CHUNK_SIZE = 64 * 1024;
+
+    std::uint32_t read_le16(const std::uint8_t* p) { return std::uint32_t(p[0]) | (std::uint32_t(p[1]) << 8); }
+    std::uint32_t read_le32(const std::uint8_t* p) { return read_le16(p) | (read_le16(p + 2) << 16); }
+
+    void read_exact(std::ifstream& file, std::uint8_t* out, std::size_t length) {
+        if (!file.read(reinterpret_cast<char*>(out), static_cast<std::streamsize>(length)))
+            throw std::runtime_error("Failed while reading ROM.");
+    }
+
+#ifdef TOTR_HAVE_ZLIB
+    constexpr std::size_t MAX_INITIAL_OUTPUT = 64 << 20; // Twice the largest GBA image
+    constexpr std::size_t MAX_OUTPUT_STEP = 16 << 20;
+    constexpr std::uint64_t MAX_DEFLATE_RATIO = 1032;    // Deflate cannot expand input further than this
+
+    // Streams `compressed_size` bytes from the file through zlib, writing straight into `rom`.
+    // Only one input chunk is buffered. `expected_size` comes from the untrusted header, so it only
+    // sizes the first allocation, capped by what the input can expand to; the output then grows in
+    // bounded steps and is trimmed to what was produced.
+    void inflate_stream(std::ifstream& file, std::uint64_t compressed_size, int window_bits,
+                        std::vector<std::uint8_t>& rom, std::size_t expected_size) {
+        z_stream stream{};
+        if (inflateInit2(&stream, window_bits) != Z_OK) throw std::runtime_error("Failed to initialise zlib.");
+
+        rom.resize(static_cast<std::size_t>(std::min<std::uint64_t>({ expected_size, MAX_INITIAL_OUTPUT,
+            std::max<std::uint64_t>(compressed_size * MAX_DEFLATE_RATIO, INPUT_CHUNK_SIZE) })));
+        std::vector<std::uint8_t> chunk(INPUT_CHUNK_SIZE);
+        std::size_t produced = 0;
+        int status = Z_OK;
+
+        // Moves the unread input to the front of the chunk and tops it up from the file
+        const auto refill = [&] {
+            if (stream.avail_in > 0) std::memmove(chunk.data(), stream.next_in, stream.avail_in);
+            const std::size_t length = static_cast<std::size_t>(std::min<std::uint64_t>(compressed_size, chunk.size() - stream.avail_in));
+            read_exact(file, chunk.data() + stream.avail_in, length);
+            compressed_size -= length;
+            stream.next_in = chunk.data();
+            stream.avail_in += static_cast<uInt>(length);
+        };
+
+        while (compressed_size > 0 || stream.avail_in > 0) {
+            if (stream.avail_in == 0) refill();
+
+            if (produced == rom.size()) {
+                const std::size_t step = std::clamp<std::size_t>(rom.size(), INPUT_CHUNK_SIZE, MAX_OUTPUT_STEP);
+                rom.reserve(rom.size() + step); // Exact, where resize alone would double the capacity
+                rom.resize(rom.size() + step);
+            }
+            stream.next_out = rom.data() + produced;
+            stream.avail_out = static_cast<uInt>(std::min<std::size_t>(rom.size() - produced, UINT32_MAX));
+
+            status = inflate(&stream, Z_NO_FLUSH);
+            produced = static_cast<std::size_t>(stream.next_out - rom.data());
+
+            if (status == Z_STREAM_END) {
+                // gzip allows concatenated members; anything that is not another member, such as
+                // zero padding, ends the stream
+                if (window_bits < 16 + MAX_WBITS) break;
+                if (stream.avail_in < 2 && compressed_size > 0) refill();
+                if (stream.avail_in < 2 || stream.next_in[0] != 0x1F || stream.next_in[1] != 0x8B) break;
+                if (inflateReset(&stream) != Z_OK) break;
+            }
+            else if (status != Z_OK && status != Z_BUF_ERROR) {
+                inflateEnd(&stream);
+                throw std::runtime_error("Corrupt compressed ROM data.");
+            }
+        }
+
+        inflateEnd(&stream);
+        if (status != Z_STREAM_END) throw std::runtime_error("Truncated compressed ROM data.");
+        rom.resize(produced);
+        rom.shrink_to_fit();
+    }
+#endif
+
+    std::vector<std::uint8_t> inflate_gzip(std::ifstream& file, std::streamsize size) {
+#ifdef TOTR_HAVE_ZLIB
+        // ISIZE trailer holds the uncompressed length modulo 2^32 of the last member; only a size hint
+        std::array<std::uint8_t, 4> trailer{};
+        file.seekg(size - 4, std::ios::beg);
+        read_exact(file, trailer.data(), trailer.size());
+        file.seekg(0, std::ios::beg);
+
+        std::vector<std::uint8_t> rom;
+        inflate_stream(file, static_cast<std::uint64_t>(size), 16 + MAX_WBITS, rom, read_le32(trailer.data()));
+        if (rom.empty()) throw std::runtime_error("Empty or unreadable file.");
+        return rom;
+#else
+        (void)file; (void)size;
+        throw std::runtime_error("ROM is gzip compressed but this build has no zlib support.");
+#endif
+    }
+
+    bool has_rom_extension(const std::string& name) {
+        std::string lower = name;
+        std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char letter) { return std::tolower(letter); });
+        for (const char* ext : { ".gba", ".agb", ".bin", ".rom" }) {
+            std::size_t ext_len = std::char_traits<char>::length(ext);
+            if (lower.size() >= ext_len && lower.compare(lower.size() - ext_len, ext_len, ext) == 0) return true;
+        }
+        return false;
+    }
+
+    std::vector<std::uint8_t> extract_zip(std::ifstream& file, std::streamsize size) {
+        // locate the end of central directory record; it sits in the last 64KiB + 22 bytes
+        constexpr std::size_t EOCD_SIZE = 22;
+        const std::size_t tail_size = static_cast<std::size_t>(std::min<std::streamsize>(size, 0xFFFF + EOCD_SIZE));
+        std::vector<std::uint8_t> tail(tail_size);
+        file.seekg(size - static_cast<std::streamsize>(tail_size), std::ios::beg);
+        read_exact(file, tail.data(), tail.size());
+
+        std::size_t eocd = std::string::npos;
+        for (std::size_t i = tail_size >= EOCD_SIZE ? tail_size - EOCD_SIZE + 1 : 0; i-- > 0;) {
+            if (read_le32(&tail[i]) == 0x06054B50) { eocd = i; break; }
+        }
+        if (eocd == std::string::npos) throw std::runtime_error("Malformed zip archive.");
+
+        const std::uint32_t entry_count = read_le16(&tail[eocd + 10]);
+        const std::uint32_t directory_size = read_le32(&tail[eocd + 12]);
+        const std::uint32_t directory_offset = read_le32(&tail[eocd + 16]);
+
+        std::vector<std::uint8_t> directory(directory_size);
+        file.seekg(directory_offset, std::ios::beg);
+        read_exact(file, directory.data(), directory.size());
+
+        // pick the first entry that looks like a ROM, otherwise the first file in the archive
+        struct Entry { std::uint32_t method, crc, compressed_size, uncompressed_size, local_offset; };
+        std::optional<Entry> chosen;
+        bool chosen_by_name = false;
+        for (std::size_t pos = 0, n = 0; n < entry_count && pos + 46 <= directory.size(); ++n) {
+            const std::uint8_t* header = &directory[pos];
+            if (read_le32(header) != 0x02014B50) throw std::runtime_error("Malformed zip archive.");
+
+            const std::uint32_t name_len = read_le16(header + 28);
+            const std::uint32_t extra_len = read_le16(header + 30);
+            const std::uint32_t comment_len = read_le16(header + 32);
+            if (pos + 46 + name_len > directory.size()) throw std::runtime_error("Malformed zip archive.");
+            std::string name(reinterpret_cast<const char*>(header + 46), name_len);
+
+            Entry entry{ read_le16(header + 10), read_le32(header + 16), read_le32(header + 20), read_le32(header + 24), read_le32(header + 42) };
+            bool is_rom = has_rom_extension(name);
+            if (!name.empty() && name.back() != '/' && (!chosen || (is_rom && !chosen_by_name))) {
+                chosen = entry;
+                chosen_by_name = is_rom;
+            }
+            pos += 46 + name_len + extra_len + comment_len;
+        }
+        if (!chosen) throw std::runtime_error("Zip archive contains no files.");
+        if (chosen->uncompressed_size == 0) throw std::runtime_error("Empty or unreadable file.");
+
+        std::array<std::uint8_t, 30> local{};
+        file.seekg(chosen->local_offset, std::ios::beg);
+        read_exact(file, local.data(), local.size());
+        if (read_le32(local.data()) != 0x04034B50) throw std::runtime_error("Malformed zip archive.");
+        file.seekg(read_le16(&local[26]) + read_le16(&local[28]), std::ios::cur);
+
+        std::vector<std::uint8_t> rom;
+        switch (chosen->method) {
+            case 0: // stored
+                if (chosen->uncompressed_size != chosen->compressed_size || chosen->compressed_size > static_cast<std::uint64_t>(size))
+                    throw std::runtime_error("Malformed zip archive.");
+                rom.resize(chosen->uncompressed_size);
+                read_exact(file, rom.data(), rom.size());
+                break;
+            case 8: // deflate
+#ifdef TOTR_HAVE_ZLIB
+                inflate_stream(file, chosen->compressed_size, -MAX_WBITS, rom, chosen->uncompressed_size);
+                break;
+#else
+                throw std::runtime_error("ROM is deflate compressed but this build has no zlib support.");
+#endif
+            default:
+                throw std::runtime_error("Unsupported zip compression method.");
+        }
+
+#ifdef TOTR_HAVE_ZLIB
+        if (crc32(crc32(0L, Z_NULL, 0), rom.data(), static_cast<uInt>(rom.size())) != chosen->crc)
+            throw std::runtime_error("Zip entry failed CRC check.");
+#endif
+        return rom;
+    }
+
+    // `address mode` pairs of an override file, mode tokens lower-cased; comments and malformed lines are skipped
+    std::vector<std::pair<std::uint32_t, std::string>> read_override_lines(const std::string& filepath) {
+        std::vector<std::pair<std::uint32_t, std::string>> lines;
+
+        std::ifstream file_stream(filepath);
+        if (!file_stream) return lines;
+
+        std::string line;
+        while (std::getline(file_stream, line)) {
+            if (auto comment_pos = line.find('#'); comment_pos != std::string::npos)
+                line.erase(comment_pos);
 
+            // trim leading / trailing whitespace
+            auto is_not_space = [](unsigned char ch) { return !std::isspace(ch); };
+            line.erase(line.begin(), std::find_if(line.begin(), line.end(), is_not_space));
+
+            line.erase(std::find_if(line.rbegin(), line.rend(), is_not_space).base(), line.end());
+            if (line.empty()) continue;
+
+            // split into address token and mode token
+            std::istringstream token_stream(line);
+            std::string addr_token, mode_token;
+            if (!(token_stream >> addr_token >> mode_token)) continue; // malformed line
+
+            std::uint32_t pc_address = static_cast<std::uint32_t>(std::stoul(addr_token, nullptr, 0));
+
+            // normalise mode string to lower-case
+            std::transform(mode_token.begin(), mode_token.end(), mode_token.begin(),
+                [](unsigned char letter) { return std::tolower(letter); });
+
+            lines.emplace_back(pc_address, std::move(mode_token));
+        }
+        return lines;
+    }
+} // namespace
+
+totr::Disassembler::OverrideFile totr::Disassembler::load_overrides(const std::string& filepath) {
+    // Read once: the path may be a pipe that cannot be opened a second time
+    std::vector<std::pair<std::uint32_t, std::string>> lines = read_override_lines(filepath);
+    // Stable, so the last line for an address still wins
+    std::stable_sort(lines.begin(), lines.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    OverrideFile overrides;
+    for (std::size_t i = 0; i < lines.size(); ++i) {
+        const auto& [pc_address, mode_token] = lines[i];
+        if (mode_token != "data") {
+            overrides.modes[pc_address] = (mode_token == "thumb") ? ArmMode::THUMB : ArmMode::ARM;
+            continue;
+        }
+
+        // A region runs up to the next address the file mentions, or to the end of the image
+        std::uint32_t end = 0xFFFFFFFF;
+        for (std::size_t next = i + 1; next < lines.size(); ++next) {
+            if (lines[next].first != pc_address) { end = lines[next].first; break; }
+        }
+        overrides.data_regions.push_back({ pc_address, end });
+    }
+    return overrides;
+}
+
+totr::Disassembler::SymbolTable totr::Disassembler::load_symbols(const std::string& filepath) {
+    // Accepts `address name` lines as found in no$gba .sym files (bare hex) and GNU ld .map
+    // files (0x-prefixed). Section headers, size columns and directives like `.arm` are skipped.
     std::ifstream file_stream(filepath);
-    if (!file_stream) return overrides;
+    if (!file_stream) throw std::runtime_error("Cannot open symbol file: " + filepath);
 
+    SymbolTable symbols;
     std::string line;
     while (std::getline(file_stream, line)) {
-        if (auto comment_pos = line.find('#'); comment_pos != std::string::npos)
+        if (auto comment_pos = line.find_first_of("#;"); comment_pos != std::string::npos)
             line.erase(comment_pos);
 
-        // trim leading / trailing whitespace
-        auto is_not_space = [](unsigned char ch) { return !std::isspace(ch); };
-        line.erase(line.begin(), std::find_if(line.begin(), line.end(), is_not_space));
+        std::istringstream token_stream(line);
+        std::string addr_token, name_token;
+        if (!(token_stream >> addr_token >> name_token)) continue;
 
-        line.erase(std::find_if(line.rbegin(), line.rend(), is_not_space).base(), line.end());
-        if (line.empty()) continue;
+        std::string_view digits = addr_token;
+        if (digits.size() > 2 && digits[0] == '0' && (digits[1] == 'x' || digits[1] == 'X')) digits.remove_prefix(2);
+        if (digits.empty() || digits.size() > 8) continue;
+        if (!std::all_of(digits.begin(), digits.end(), [](unsigned char ch) { return std::isxdigit(ch); })) continue;
 
-        // split into address token and mode token
-        std::istringstream token_stream(line);
-        std::string addr_token, mode_token;
-        if (!(token_stream >> addr_token >> mode_token)) continue; // malformed line
+        // a second numeric column is a section size, and a leading '.' marks a directive or section
+        if (name_token[0] == '.' || std::isdigit(static_cast<unsigned char>(name_token[0]))) continue;
 
-        std::uint32_t pc_address = static_cast<std::uint32_t>(std::stoul(addr_token, nullptr, 0));
+        symbols.add(static_cast<std::uint32_t>(std::stoul(std::string(digits), nullptr, 16)), name_token);
+    }
 
-        // normalise mode string to lower-case
+    symbols.finalize();
+    return symbols;
+}
+
+std::vector<totr::Disassembler::Signature> totr::Disassembler::load_signatures(const std::string& filepath) {
+    // One signature per line: `name arm|thumb unit unit ...`, e.g. `SoundMain thumb B5F0 4??? 6800`
+    std::ifstream file_stream(filepath);
+    if (!file_stream) throw std::runtime_error("Cannot open signature file: " + filepath);
+
+    std::vector<Signature> signatures;
+    std::string line;
+    for (std::size_t line_number = 1; std::getline(file_stream, line); ++line_number) {
+        if (auto comment_pos = line.find_first_of("#;"); comment_pos != std::string::npos)
+            line.erase(comment_pos);
+
+        std::istringstream token_stream(line);
+        std::string name_token, mode_token;
+        if (!(token_stream >> name_token)) continue;
+        const std::string where = filepath + ":" + std::to_string(line_number) + ": ";
+
+        token_stream >> mode_token;
         std::transform(mode_token.begin(), mode_token.end(), mode_token.begin(),
             [](unsigned char letter) { return std::tolower(letter); });
+        if (mode_token != "arm" && mode_token != "thumb") throw std::runtime_error(where + "expected `arm` or `thumb` after the name");
 
-        ArmMode decoded_mode = (mode_token == "thumb") ? ArmMode::THUMB : ArmMode::ARM;
+        Signature signature{ name_token, (mode_token == "thumb") ? ArmMode::THUMB : ArmMode::ARM, {} };
+        for (std::string unit_token; token_stream >> unit_token; ) {
+            try {
+                signature.units.push_back(parse_signature_unit(unit_token, signature.mode));
+            }
+            catch (const std::invalid_argument& e) {
+                throw std::runtime_error(where + e.what());
+            }
+        }
+        if (signature.units.empty()) throw std::runtime_error(where + "signature has no instructions");
 
-        overrides[pc_address] = decoded_mode;
+        signatures.push_back(std::move(signature));
     }
-    return overrides;
+    return signatures;
 }
 
 std::vector<uint8_t> totr::Disassembler::load_rom(const std::string& path) {
@@ -51,11 +335,28 @@ std::vector<uint8_t> totr::Disassembler::load_rom(const std::string& path) {
 
     std::streamsize size = file.tellg();
     if (size <= 0) throw std::runtime_error("Empty or unreadable file.");
+    file.seekg(0, std::ios::beg);
+
+    // sniff the container format from the leading magic bytes
+    std::array<std::uint8_t, 4> magic{};
+    if (size >= 4) {
+        if (!file.read(reinterpret_cast<char*>(magic.data()), magic.size()))
+            throw std::runtime_error("Failed while reading ROM.");
+        file.seekg(0, std::ios::beg);
+    }
+
+    if (magic[0] == 0x1F && magic[1] == 0x8B) return inflate_gzip(file, size);
+    if (magic[0] == 'P' && magic[1] == 'K' && magic[2] == 0x03 && magic[3] == 0x04) return extract_zip(file, size);
 
     std::vector<uint8_t> rom(static_cast<size_t>(size));
-    file.seekg(0, std::ios::beg);
     if (!file.read(reinterpret_cast<char*>(rom.data()), size))
         throw std::runtime_error("Failed while reading ROM.");
 
     return rom;
 }
+
+totr::Disassembler::ExecutionTrace totr::Disassembler::load_trace(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) throw std::runtime_error("Cannot open trace file: " + path);
+    return ExecutionTrace::read(file);
+}
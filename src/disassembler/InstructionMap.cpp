@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <totr/disassembler/ArmDisasm.hpp>
+#include <totr/disassembler/InstructionMap.hpp>
+#include <totr/disassembler/ThumbDisasm.hpp>
+
+namespace td = totr::Disassembler;
+
+namespace {
+	// Smallest share of bitmap words handed to one thread; below this spawning costs more than decoding.
+	constexpr std::size_t MIN_WORDS_PER_THREAD = 256;
+
+	// MOV Rd, Rd / LSL Rd, Rd, #0
+	bool is_padding(const td::DecodedFields& fields) {
+		if (fields.format == td::InstrFormat::ThumbHiRegOpsBx) return fields.opcode == 2 && fields.rd == fields.rm;
+		return fields.format == td::InstrFormat::ThumbMoveShiftedReg && fields.opcode == 0 && fields.imm == 0 && fields.rd == fields.rn;
+	}
+
+	bool ends_block(const td::DecodedFields& fields, td::ArmMode mode) {
+		if (fields.flags & (td::DecodeFlag::BranchExchange | td::DecodeFlag::ExceptionReturn)) return true;
+		const bool load = fields.flags & td::DecodeFlag::Load;
+		if (mode == td::ArmMode::ARM) {
+			if (fields.cond != 0xE) return false;
+			switch (fields.format) {
+				case td::InstrFormat::ArmBranch: return !(fields.flags & td::DecodeFlag::Link);
+				case td::InstrFormat::ArmDataProc: return fields.rd == 15;
+				case td::InstrFormat::ArmSingleDataTrans: return load && fields.rd == 15;
+				case td::InstrFormat::ArmBlockDataTrans: return load && (fields.imm & 0x8000);
+				default: return false;
+			}
+		}
+		switch (fields.format) {
+			case td::InstrFormat::ThumbHiRegOpsBx: return fields.opcode == 2 && fields.rd == 15;
+			case td::InstrFormat::ThumbPushPopReg: return load && (fields.imm & 0x8000);
+			default: return false;
+		}
+	}
+
+	// Runs fill(first, last) over [0, count) bitmap words. Threads own whole 64-bit words, so no
+	// two threads ever write the same bitmap word or format byte.
+	template <typename Fill>
+	void for_each_range(std::size_t count, unsigned thread_count, Fill fill) {
+		const std::size_t shares = std::max<std::size_t>(1, std::min<std::size_t>(thread_count, count / MIN_WORDS_PER_THREAD));
+		if (shares == 1) { fill(std::size_t{ 0 }, count); return; }
+
+		const std::size_t per_share = (count + shares - 1) / shares;
+		std::vector<std::thread> workers;
+		workers.reserve(shares - 1);
+		for (std::size_t share = 1; share < shares; ++share) {
+			const std::size_t first = std::min(count, share * per_share);
+			const std::size_t last = std::min(count, first + per_share);
+			workers.emplace_back(fill, first, last);
+		}
+		fill(std::size_t{ 0 }, std::min(count, per_share));
+		for (std::thread& worker : workers) worker.join();
+	}
+}
+
+std::uint8_t td::instruction_traits(const DecodedFields& fields, ArmMode mode) {
+	if (!fields.is_valid()) return 0;
+	std::uint8_t traits = InstrTrait::Valid;
+	if (ends_block(fields, mode)) traits |= InstrTrait::EndsBlock;
+	if (mode == ArmMode::ARM) {
+		if (fields.format == InstrFormat::ArmUndefined) traits |= InstrTrait::Rare;
+		if (fields.cond != 0xE) traits |= InstrTrait::Conditional | InstrTrait::SetsCondition;
+		if (fields.flags & DecodeFlag::SetFlags) traits |= InstrTrait::SetsCondition;
+	}
+	else {
+		if (fields.format == InstrFormat::ThumbUncondBranch) traits |= InstrTrait::Rare;
+		if (is_padding(fields)) traits |= InstrTrait::Padding;
+		if (fields.flags & DecodeFlag::Wide) traits |= InstrTrait::Wide;
+	}
+	return traits;
+}
+
+template <std::endian Order>
+td::InstructionMap td::InstructionMap::build(const MemoryReader<Order>& memory, unsigned thread_count) {
+	if (thread_count == 0) thread_count = std::max(1u, std::thread::hardware_concurrency());
+
+	InstructionMap map;
+	map.m_size = memory.size();
+
+	const std::size_t arm_slots = (map.m_size + 3) / 4;
+	const std::size_t thumb_slots = map.m_size / 2;
+	map.m_arm_valid.assign((arm_slots + 63) / 64, 0);
+	map.m_thumb_valid.assign((thumb_slots + 63) / 64, 0);
+	map.m_arm_format.resize(arm_slots);
+	map.m_thumb_format.resize(thumb_slots);
+	map.m_arm_traits.resize(arm_slots);
+	map.m_thumb_traits.resize(thumb_slots);
+
+	// ARM and THUMB bitmap words are interleaved into one index space so both halves share the threads.
+	const std::size_t arm_words = map.m_arm_valid.size();
+	const std::size_t total_words = arm_words + map.m_thumb_valid.size();
+
+	for_each_range(total_words, thread_count, [&](std::size_t first, std::size_t last) {
+		for (std::size_t word = first; word < last; ++word) {
+			const bool is_arm = word < arm_words;
+			const std::size_t base = (is_arm ? word : word - arm_words) * 64;
+			const std::size_t slots = is_arm ? arm_slots : thumb_slots;
+			std::uint64_t bits = 0;
+
+			for (std::size_t slot = base; slot < std::min(base + 64, slots); ++slot) {
+				DecodedFields fields;
+				if (is_arm) {
+					const std::uint32_t offset = static_cast<std::uint32_t>(slot * 4);
+					fields = ArmDisasm::decode_fields(offset, memory.fetch_arm(offset));
+					map.m_arm_format[slot] = fields.format;
+					map.m_arm_traits[slot] = instruction_traits(fields, ArmMode::ARM);
+				}
+				else {
+					const std::uint32_t offset = static_cast<std::uint32_t>(slot * 2);
+					fields = ThumbDisasm::decode_fields(offset, memory.fetch_thumb(offset));
+					map.m_thumb_format[slot] = fields.format;
+					map.m_thumb_traits[slot] = instruction_traits(fields, ArmMode::THUMB);
+				}
+				if (fields.is_valid()) bits |= std::uint64_t{ 1 } << (slot - base);
+			}
+
+			if (is_arm) map.m_arm_valid[word] = bits;
+			else map.m_thumb_valid[word - arm_words] = bits;
+		}
+	});
+
+	return map;
+}
+
+template td::InstructionMap td::InstructionMap::build(const td::LittleEndianReader&, unsigned);
+template td::InstructionMap td::InstructionMap::build(const td::BigEndianReader&, unsigned);
@@ -5,18 +5,18 @@
 
 namespace td = totr::Disassembler;
 
-td::ModeGuess td::probe_mode(std::span<const uint8_t> rom, uint32_t pc, const td::ArmDisasm& arm, const td::ThumbDisasm& thumb) {
-    if (pc >= rom.size()) return ModeGuess::NEITHER;
+template <std::endian Order>
+td::ModeGuess td::probe_mode(const td::MemoryReader<Order>& memory, uint32_t pc, const td::ArmDisasm& arm, const td::ThumbDisasm& thumb) {
+    if (pc >= memory.size()) return ModeGuess::NEITHER;
 
-    uint32_t instr = read_word32_at(rom, pc);
     bool arm_ok = false;
     bool thumb_ok = false;
 
-    InstructionData data = arm.decode(pc, instr);
+    InstructionData data = arm.decode(pc, memory.fetch_arm(pc));
     arm_ok = data.is_valid;
 
-    if (pc + 1 < rom.size()) {
-        InstructionData data = thumb.decode(pc, instr);
+    if (pc + 1 < memory.size()) {
+        InstructionData data = thumb.decode(pc, memory.fetch_thumb(pc));
         thumb_ok = data.is_valid;
     }
 
@@ -25,3 +25,35 @@ td::ModeGuess td::probe_mode(std::span<const uint8_t> rom, uint32_t pc, const td
     if (arm_ok && thumb_ok) return ModeGuess::BOTH;
     return ModeGuess::NEITHER;
 }
+
+template <std::endian Order>
+td::ModeGuess td::probe_mode(const td::MemoryReader<Order>& memory, uint32_t pc) {
+    if (pc >= memory.size()) return ModeGuess::NEITHER;
+
+    const bool arm_ok = ArmDisasm::decode_fields(pc, memory.fetch_arm(pc)).is_valid();
+    const bool thumb_ok = pc + 1 < memory.size() && ThumbDisasm::decode_fields(pc, memory.fetch_thumb(pc)).is_valid();
+
+    if (arm_ok && !thumb_ok) return ModeGuess::ARM;
+    if (!arm_ok && thumb_ok) return ModeGuess::THUMB;
+    if (arm_ok && thumb_ok) return ModeGuess::BOTH;
+    return ModeGuess::NEITHER;
+}
+
+td::ModeGuess td::probe_mode(std::span<const uint8_t> rom, uint32_t pc, const td::ArmDisasm& arm, const td::ThumbDisasm& thumb) {
+    return probe_mode(LittleEndianReader{ rom }, pc, arm, thumb);
+}
+
+td::ModeGuess td::probe_mode(const td::InstructionMap& map, uint32_t pc) {
+    const bool arm_ok = map.arm_valid(pc);
+    const bool thumb_ok = map.thumb_valid(pc);
+
+    if (arm_ok && !thumb_ok) return ModeGuess::ARM;
+    if (!arm_ok && thumb_ok) return ModeGuess::THUMB;
+    if (arm_ok && thumb_ok) return ModeGuess::BOTH;
+    return ModeGuess::NEITHER;
+}
+
+template td::ModeGuess td::probe_mode(const td::LittleEndianReader&, uint32_t, const td::ArmDisasm&, const td::ThumbDisasm&);
+template td::ModeGuess td::probe_mode(const td::BigEndianReader&, uint32_t, const td::ArmDisasm&, const td::ThumbDisasm&);
+template td::ModeGuess td::probe_mode(const td::LittleEndianReader&, uint32_t);
+template td::ModeGuess td::probe_mode(const td::BigEndianReader&, uint32_t);
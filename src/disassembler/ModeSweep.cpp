@@ -0,0 +1,501 @@
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <optional>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+#include <totr/disassembler/ArmDisasm.hpp>
+#include <totr/disassembler/InstructionProbe.hpp>
+#include <totr/disassembler/ModeSweep.hpp>
+#include <totr/disassembler/Stats.hpp>
+#include <totr/disassembler/ThumbDisasm.hpp>
+
+namespace td = totr::Disassembler;
+
+namespace {
+	constexpr std::size_t RESYNC_WINDOW = 16;       // Instructions the implausible rate is measured over
+	constexpr int RESYNC_THRESHOLD = 6;             // Implausible instructions in the window that trigger a check
+	constexpr std::size_t RESYNC_CONFIRM = 8;       // Plausible instructions after a restart point that confirm it
+	constexpr std::size_t RESYNC_LOOKBACK = 64;     // Instructions searched back for the block end
+	constexpr std::size_t RESYNC_MIN_RUN = 4;       // Shortest run either reading is judged on
+	constexpr std::size_t RESYNC_CANDIDATES = 4;    // Block ends tried per check
+
+	// Decodes that are rare in real code of that mode but common when the other mode's code or data
+	// is read in it: ARM code is rarely conditional without a compare before it (THUMB code read as
+	// ARM almost always is), and ARM code read as THUMB is every other halfword an unconditional
+	// branch. `flags_live` is set when the instruction before is plausible ARM that sets the condition.
+	bool implausible(std::uint8_t traits, bool flags_live) {
+		return !(traits & td::InstrTrait::Valid) || (traits & td::InstrTrait::Rare)
+			|| ((traits & td::InstrTrait::Conditional) && !flags_live);
+	}
+
+	// Decisions the detector must not reverse, its own included
+	bool authoritative(const td::SweepEntry& entry) {
+		return entry.reason == td::ModeReason::Override || entry.reason == td::ModeReason::BranchExchange
+			|| entry.reason == td::ModeReason::InvalidRate;
+	}
+
+	// Overwrites [first, last) of `entries` with `run`, shifting the tail at most once
+	void splice(std::vector<td::SweepEntry>& entries, std::size_t first, std::size_t last, const std::vector<td::SweepEntry>& run) {
+		const std::size_t common = std::min(run.size(), last - first);
+		std::copy(run.begin(), run.begin() + common, entries.begin() + first);
+		if (run.size() < last - first) entries.erase(entries.begin() + first + common, entries.begin() + last);
+		else entries.insert(entries.begin() + last, run.begin() + common, run.end());
+	}
+}
+
+template <std::endian Order>
+td::ModeSweep<Order>::ModeSweep(MemoryReader<Order> memory, const SymbolTable& symbols, std::uint32_t base_address,
+	std::unordered_map<std::uint32_t, ArmMode> overrides, bool track_registers, std::vector<DataRegion> data)
+	: m_memory(memory), m_symbols(symbols), m_base_address(base_address), m_overrides(std::move(overrides)), m_track_registers(track_registers) {
+	const std::uint32_t image_end = static_cast<std::uint32_t>(m_memory.size());
+	for (const DataRegion& region : data) {
+		const std::uint32_t start = std::max(region.start, m_base_address) - m_base_address;
+		const std::uint32_t end = std::min(std::max(region.end, m_base_address) - m_base_address, image_end);
+		if (start < end) m_data.push_back({ start, end });
+	}
+
+	// Merge overlapping regions so the sweep needs a single cursor
+	std::sort(m_data.begin(), m_data.end(), [](const DataRegion& a, const DataRegion& b) { return a.start < b.start; });
+	std::size_t kept = 0;
+	for (const DataRegion& region : m_data) {
+		if (kept && region.start <= m_data[kept - 1].end) m_data[kept - 1].end = std::max(m_data[kept - 1].end, region.end);
+		else m_data[kept++] = region;
+	}
+	m_data.resize(kept);
+}
+
+template <std::endian Order>
+std::size_t td::ModeSweep<Order>::run() {
+	if (m_map.size() != m_memory.size()) m_map = InstructionMap::build(m_memory);
+	m_entries.clear();
+	m_targets.clear();
+	m_target_modes.clear();
+
+	std::set<std::uint32_t> pending;
+	return sweep_from(0, 0, pending);
+}
+
+template <std::endian Order>
+std::size_t td::ModeSweep<Order>::set_override(std::uint32_t address, ArmMode mode) {
+	auto [it, inserted] = m_overrides.try_emplace(address, mode);
+	if (!inserted) {
+		if (it->second == mode) return 0;
+		it->second = mode;
+	}
+	if (address < m_base_address) return 0;
+	return resweep(address - m_base_address);
+}
+
+template <std::endian Order>
+std::size_t td::ModeSweep<Order>::remove_override(std::uint32_t address) {
+	if (m_overrides.erase(address) == 0 || address < m_base_address) return 0;
+	return resweep(address - m_base_address);
+}
+
+template <std::endian Order>
+std::vector<td::ModeSegment> td::ModeSweep<Order>::segments() const {
+	std::vector<ModeSegment> segments;
+	for (std::size_t i = 0; i < m_entries.size(); ++i) {
+		const SweepEntry& entry = m_entries[i];
+		if (i == 0 || entry.mode() != segments.back().mode || entry.offset != segments.back().end) {
+			ModeReason reason = (i == 0) ? ModeReason::Initial : m_entries[i - 1].reason;
+			if (i > 0 && entry.offset != segments.back().end) {
+				// After a data region
+				reason = m_overrides.contains(m_base_address + entry.offset) ? ModeReason::Override : ModeReason::None;
+			}
+			segments.push_back({ entry.offset, entry.offset, entry.mode(), reason });
+		}
+		segments.back().end = entry.offset + entry.size;
+	}
+	return segments;
+}
+
+template <std::endian Order>
+std::optional<td::BranchTarget> td::ModeSweep<Order>::tracked_target(std::uint32_t offset) const {
+	if (auto it = m_targets.find(offset); it != m_targets.end()) return it->second;
+	return std::nullopt;
+}
+
+template <std::endian Order>
+td::DecodedFields td::ModeSweep<Order>::fields(const SweepEntry& entry) const {
+	// Entries handed out by entries() carry their decode
+	if (!m_entries.empty() && &entry >= m_entries.data() && &entry < m_entries.data() + m_entries.size()) {
+		return entry.fields;
+	}
+	return decode(entry.offset, entry.mode());
+}
+
+template <std::endian Order>
+td::DecodedFields td::ModeSweep<Order>::decode(std::uint32_t offset, ArmMode mode) const {
+	TOTR_STATS_SCOPE(Decode);
+	const std::uint32_t address = m_base_address + offset;
+	if (mode == ArmMode::ARM) return ArmDisasm::decode_fields(address, m_memory.fetch_arm(offset));
+	return ThumbDisasm::decode_fields(address, m_memory.fetch_thumb(offset));
+}
+
+template <std::endian Order>
+std::optional<td::ArmMode> td::ModeSweep<Order>::target_mode(std::uint32_t address, std::uint32_t before) const {
+	auto it = m_target_modes.lower_bound({ address, before });
+	if (it == m_target_modes.begin()) return std::nullopt;
+	--it;
+	if (it->first.first != address) return std::nullopt;
+	return it->second;
+}
+
+template <std::endian Order>
+std::size_t td::ModeSweep<Order>::resweep(std::uint32_t offset) {
+	std::size_t decoded = 0;
+	std::set<std::uint32_t> pending{ offset };
+
+	while (!pending.empty()) {
+		const std::uint32_t dirty = *pending.begin();
+		pending.erase(pending.begin());
+
+		// The mode at `dirty` is decided after the instruction that ends there, so nothing changes
+		// unless it is an instruction boundary, or was one in the run the detector swept before
+		// switching back to a block end behind it. Offset 0 is never a decision point.
+		auto it = std::lower_bound(m_entries.begin(), m_entries.end(), dirty,
+			[](const SweepEntry& entry, std::uint32_t value) { return entry.offset < value; });
+		const std::size_t at = static_cast<std::size_t>(it - m_entries.begin());
+		const bool boundary = it != m_entries.end() && it->offset == dirty && at > 0;
+		std::size_t changed = at;
+		const std::uint32_t reach = (dirty > 4 * RESYNC_LOOKBACK) ? dirty - 4 * RESYNC_LOOKBACK : 0;
+		for (std::size_t i = changed; i-- > 0 && m_entries[i].offset >= reach; ) {
+			if (m_entries[i].reason == ModeReason::InvalidRate) changed = i;
+		}
+		if (!boundary && changed == at) continue;
+
+		// Restart where no register was known, so the tracker state there is reproducible, and far
+		// enough back that the detector's switches and restart points before it do not depend on
+		// the instructions that change
+		std::size_t first = (changed > RESYNC_LOOKBACK) ? changed - RESYNC_LOOKBACK : 0;
+		while (first > 0 && !(m_entries[first].flags & SweepFlag::TrackerClear)) --first;
+
+		decoded += sweep_from(first, dirty, pending);
+	}
+	return decoded;
+}
+
+template <std::endian Order>
+std::size_t td::ModeSweep<Order>::find_mode_change(std::size_t first, const std::vector<SweepEntry>& run, std::size_t barrier) const {
+	// Entries before run[0] are the old ones before m_entries[first]; barrier keeps index 0 out of a full run
+	const auto ends_plausible_block = [&](std::size_t i) {
+		for (std::size_t back = 1; back <= 2 && back <= first + i; ++back) {
+			const SweepEntry& entry = (i >= back) ? run[i - back] : m_entries[first + i - back];
+			if (entry.flags & SweepFlag::Implausible) return false;
+			const std::uint8_t traits = instruction_traits(entry.fields, entry.mode());
+			if (traits & InstrTrait::EndsBlock) return true;
+			if (!(traits & InstrTrait::Padding)) return false;
+		}
+		return false;
+	};
+
+	// Block ends behind which at least a third of the current mode's reading is implausible, latest first
+	const std::size_t end = run.size();
+	const ArmMode mode = run.back().mode();
+	const std::size_t limit = std::max(barrier, (end > RESYNC_LOOKBACK) ? end - RESYNC_LOOKBACK : 0);
+	std::size_t candidates[RESYNC_CANDIDATES];
+	std::size_t count = 0;
+	std::size_t bad = 0;
+	for (std::size_t i = end; i-- > limit && count < RESYNC_CANDIDATES; ) {
+		if (run[i].mode() != mode) break;
+		bad += (run[i].flags & SweepFlag::Implausible) != 0;
+		const std::size_t length = end - i;
+		if (length >= RESYNC_MIN_RUN && 3 * bad >= length && ends_plausible_block(i)) candidates[count++] = i;
+	}
+
+	// Earliest first, the other mode has to read cleanly up to the current position or its own block end.
+	// Its reading comes from the instruction map, so candidates and re-sweeps never decode it again.
+	const ArmMode other = (mode == ArmMode::ARM) ? ArmMode::THUMB : ArmMode::ARM;
+	const std::uint32_t stop = run.back().offset + run.back().size;
+	while (count > 0) {
+		const std::size_t candidate = candidates[--count];
+		std::uint32_t pc = run[candidate].offset;
+		if (other == ArmMode::ARM && (pc & 3)) continue;
+
+		// Few instructions fit before `stop`, which caps the implausible ones a pass allows
+		const std::size_t allowed = (stop - pc) / ((other == ArmMode::ARM) ? 32 : 16);
+		std::size_t decoded = 0;
+		std::size_t other_bad = 0;
+		bool flags_live = false;
+		while (pc < stop && pc < m_memory.size()) {
+			const std::uint8_t traits = m_map.traits(pc, other);
+			const bool bad = implausible(traits, flags_live);
+			++decoded;
+			if (bad && ++other_bad > allowed) break;
+			if (!bad && (traits & InstrTrait::EndsBlock)) break;
+			flags_live = other == ArmMode::ARM && !bad && (traits & InstrTrait::SetsCondition);
+			pc += (other == ArmMode::ARM || (traits & InstrTrait::Wide)) ? 4 : 2;
+		}
+		if (decoded >= RESYNC_MIN_RUN && 8 * other_bad <= decoded) return candidate;
+	}
+	return end;
+}
+
+template <std::endian Order>
+std::size_t td::ModeSweep<Order>::sweep_from(std::size_t first, std::uint32_t dirty, std::set<std::uint32_t>& pending) {
+	std::uint32_t pc = first < m_entries.size() ? m_entries[first].offset : 0;
+	ArmMode mode = first < m_entries.size() ? m_entries[first].mode() : ArmMode::ARM;
+	const std::uint32_t start = pc;
+
+	RegisterTracker tracker;
+	std::vector<SweepEntry> fresh;
+	if (m_entries.empty()) {
+		fresh.reserve(m_memory.size() / 3);
+	}
+	std::vector<std::pair<std::uint32_t, BranchTarget>> fresh_targets;  // (source offset, destination)
+	std::unordered_map<std::uint32_t, ArmMode> fresh_modes;             // by bus address, latest BX wins
+
+	std::size_t old = first;
+	bool synced = false;
+
+	std::size_t next_symbol = m_symbols.lower_bound(m_base_address + pc);
+	std::size_t next_data = 0;
+
+	// Invalid-rate detector. Restart points are confirmed only inside long plausible runs, where its
+	// state is known (empty history, no pending check), so a re-sweep sees the switches a full run does.
+	std::uint16_t history = 0;                    // One bit per instruction in the window, set when implausible
+	std::size_t plausible_run = RESYNC_WINDOW;    // Plausible instructions in a row, the window before `start` included
+	std::uint32_t tracker_clear = 0;              // One bit per recent instruction, set when it started with nothing tracked
+	std::size_t barrier = (first > 0 && !authoritative(m_entries[first - 1])) ? 0 : 1; // First index into `fresh` a switch may start at
+	std::size_t next_check = 0;                   // A failed check waits for a fresh window
+	// Whether the old entry before m_entries[index] leaves the condition flags live for it
+	const auto old_flags_live = [&](std::size_t index) {
+		if (index == 0 || index > m_entries.size()) return false;
+		const SweepEntry& previous = m_entries[index - 1];
+		return (index == m_entries.size() || previous.offset + previous.size == m_entries[index].offset)
+			&& previous.mode() == ArmMode::ARM && !(previous.flags & SweepFlag::Implausible)
+			&& (instruction_traits(previous.fields, ArmMode::ARM) & InstrTrait::SetsCondition);
+	};
+	bool flags_live = first < m_entries.size() && old_flags_live(first);
+
+	while (pc < m_memory.size()) {
+		// Skip data; execution does not flow through it
+		while (next_data < m_data.size() && m_data[next_data].end <= pc) ++next_data;
+		if (next_data < m_data.size() && m_data[next_data].start <= pc) {
+			pc = m_data[next_data].end;
+			tracker.reset();
+			barrier = std::max(barrier, fresh.size());
+			flags_live = false;
+			if (auto it = m_overrides.find(m_base_address + pc); it != m_overrides.end()) mode = it->second;
+			continue;
+		}
+
+		const std::uint32_t address = m_base_address + pc;
+
+		// Function labels join unknown callers
+		while (next_symbol < m_symbols.size() && m_symbols.address(next_symbol) < address) ++next_symbol;
+		if (next_symbol < m_symbols.size() && m_symbols.address(next_symbol) == address) tracker.reset();
+
+		// Past the changed decision, the old result holds from the first boundary both sweeps agree on
+		while (old < m_entries.size() && m_entries[old].offset < pc) ++old;
+		if (pc >= dirty && old < m_entries.size() && m_entries[old].offset == pc && m_entries[old].mode() == mode
+			&& (m_entries[old].flags & SweepFlag::TrackerClear) && tracker.empty() && history == 0
+			&& (mode == ArmMode::THUMB || flags_live == old_flags_live(old))) {
+			// The last restart points before the seam are confirmed by the old instructions after it
+			for (std::size_t ahead = 1; ahead < RESYNC_CONFIRM && old + ahead <= m_entries.size(); ++ahead) {
+				if (m_entries[old + ahead - 1].flags & SweepFlag::Implausible) break;
+				if (++plausible_run < RESYNC_WINDOW + RESYNC_CONFIRM) continue;
+				if (tracker_clear & (1u << (RESYNC_CONFIRM - 1 - ahead))) fresh[fresh.size() + ahead - RESYNC_CONFIRM].flags |= SweepFlag::TrackerClear;
+			}
+			synced = true;
+			break;
+		}
+
+		SweepEntry entry{ pc, 4, 0, ModeReason::None };
+		if (mode == ArmMode::THUMB) entry.flags |= SweepFlag::Thumb;
+		const bool tracker_empty = tracker.empty();
+
+		// Decoding is a pure function of offset and mode, so the old run's decode is reused wherever
+		// it covers this instruction
+		DecodedFields fields;
+		if (old < m_entries.size() && m_entries[old].offset == pc && m_entries[old].mode() == mode) fields = m_entries[old].fields;
+		else fields = decode(pc, mode);
+		TOTR_STATS_COUNT(instructions);
+		TOTR_STATS_FORMAT(fields.format);
+		if (!fields.is_valid()) TOTR_STATS_COUNT(invalid);
+		const std::uint8_t traits = instruction_traits(fields, mode);
+		const bool bad = implausible(traits, flags_live);
+		if (bad) entry.flags |= SweepFlag::Implausible;
+
+		if (mode == ArmMode::THUMB && !(fields.flags & DecodeFlag::Wide)) entry.size = 2;
+		pc += entry.size;
+
+		std::optional<BranchTarget> target;
+		if (m_track_registers) {
+			if (fields.flags & DecodeFlag::BranchExchange) target = tracker.branch_exchange_target(fields);
+			tracker.step(fields, mode, address, m_memory, m_base_address);
+		}
+
+		bool ambiguous = false;
+		bool mode_switched = false;
+		const std::uint32_t next_address = m_base_address + pc;
+
+		if (fields.flags & DecodeFlag::BranchExchange) {
+			ambiguous = true;
+			TOTR_STATS_COUNT(bx_events);
+
+			ModeGuess guess;
+			if (target) {
+				TOTR_STATS_COUNT(bx_tracked);
+				fresh_targets.emplace_back(entry.offset, *target);
+				fresh_modes[target->address] = target->mode;
+			}
+
+			if (target && target->address == next_address) {
+				// The register says where execution continues; no need to guess
+				guess = (target->mode == ArmMode::ARM) ? ModeGuess::ARM : ModeGuess::THUMB;
+				entry.reason = ModeReason::BranchExchange;
+			}
+			else {
+				TOTR_STATS_SCOPE(ProbeMode);
+				guess = probe_mode(m_map, pc);
+				entry.reason = ModeReason::Heuristic;
+			}
+
+			switch (guess) {
+				case ModeGuess::ARM:
+					mode = ArmMode::ARM;
+					mode_switched = true;
+					ambiguous = false;
+					break;
+				case ModeGuess::THUMB:
+					mode = ArmMode::THUMB;
+					mode_switched = true;
+					ambiguous = false;
+					break;
+				default:
+					entry.reason = ModeReason::None;
+					break;
+			}
+			if (ambiguous) TOTR_STATS_COUNT(bx_ambiguous);
+			else TOTR_STATS_COUNT(bx_resolved);
+		}
+		else if (fields.flags & DecodeFlag::ExceptionReturn) {
+			mode = ArmMode::ARM;
+			entry.reason = ModeReason::ExceptionReturn;
+			TOTR_STATS_COUNT(exception_returns);
+		}
+
+		// A known BX destination outranks the probe; only overrides are stronger
+		std::optional<ArmMode> reached;
+		if (auto it = fresh_modes.find(next_address); it != fresh_modes.end()) reached = it->second;
+		else reached = target_mode(next_address, start);
+		if (reached) {
+			if (*reached != mode) mode_switched = true;
+			mode = *reached;
+			ambiguous = false;
+			tracker.reset();
+			entry.reason = ModeReason::BranchExchange;
+		}
+
+		{
+			TOTR_STATS_SCOPE(OverrideLookup);
+			if (auto it = m_overrides.find(next_address); it != m_overrides.end()) {
+				mode = it->second;
+				entry.flags |= SweepFlag::Override;
+				entry.reason = ModeReason::Override;
+				ambiguous = false;
+				TOTR_STATS_COUNT(override_hits);
+			}
+		}
+
+		if (ambiguous) entry.flags |= SweepFlag::Ambiguous;
+		if (mode_switched) entry.flags |= SweepFlag::ModeSwitched;
+		if (mode == ArmMode::THUMB) entry.flags |= SweepFlag::NextThumb;
+		entry.fields = fields;
+		fresh.push_back(entry);
+
+		flags_live = entry.mode() == ArmMode::ARM && !bad && (traits & InstrTrait::SetsCondition);
+		history = static_cast<std::uint16_t>((history << 1) | bad);
+		plausible_run = bad ? 0 : plausible_run + 1;
+		tracker_clear = (tracker_clear << 1) | tracker_empty;
+		if (plausible_run >= RESYNC_WINDOW + RESYNC_CONFIRM) {
+			const std::size_t confirmed = fresh.size() - RESYNC_CONFIRM;
+			barrier = std::max(barrier, confirmed);
+			next_check = 0;
+			if (tracker_clear & (1u << (RESYNC_CONFIRM - 1))) fresh[confirmed].flags |= SweepFlag::TrackerClear;
+		}
+		if (authoritative(entry)) barrier = std::max(barrier, fresh.size() + 1);
+
+		if (std::popcount(history) < RESYNC_THRESHOLD || fresh.size() < next_check) continue;
+		next_check = fresh.size() + RESYNC_WINDOW;
+		const std::size_t boundary = find_mode_change(first, fresh, barrier);
+		if (boundary == fresh.size()) continue;
+
+		// Restart at the block boundary in the other mode, dropping everything swept past it
+		TOTR_STATS_COUNT(mode_resyncs);
+		mode = (fresh[boundary].mode() == ArmMode::ARM) ? ArmMode::THUMB : ArmMode::ARM;
+		pc = fresh[boundary].offset;
+		SweepEntry& decision = boundary ? fresh[boundary - 1] : m_entries[first - 1];
+		decision.flags = (decision.flags & ~(SweepFlag::Ambiguous | SweepFlag::NextThumb)) | SweepFlag::ModeSwitched;
+		if (mode == ArmMode::THUMB) decision.flags |= SweepFlag::NextThumb;
+		decision.reason = ModeReason::InvalidRate;
+		fresh.resize(boundary);
+
+		// BX destinations found past it fall back to an earlier BX to the same address, if any
+		while (!fresh_targets.empty() && fresh_targets.back().first >= pc) {
+			const std::uint32_t address = fresh_targets.back().second.address;
+			fresh_targets.pop_back();
+			const auto earlier = std::find_if(fresh_targets.rbegin(), fresh_targets.rend(),
+				[&](const auto& found) { return found.second.address == address; });
+			if (earlier != fresh_targets.rend()) fresh_modes[address] = earlier->second.mode;
+			else fresh_modes.erase(address);
+		}
+
+		tracker.reset();
+		history = 0;
+		plausible_run = RESYNC_WINDOW;
+		tracker_clear = 0;
+		flags_live = false;
+		next_check = 0;
+		barrier = boundary + 1;
+		old = static_cast<std::size_t>(std::lower_bound(m_entries.begin() + first, m_entries.end(), pc,
+			[](const SweepEntry& old_entry, std::uint32_t value) { return old_entry.offset < value; }) - m_entries.begin());
+		next_symbol = m_symbols.lower_bound(m_base_address + pc);
+	}
+
+	const std::uint32_t stop = pc;
+	const std::size_t last = synced ? old : m_entries.size();
+
+	// Swap the BX destinations found in [start, stop). A destination past `stop` whose mode
+	// changes as a result moves the decision there, so it is swept again.
+	std::vector<std::uint32_t> touched;
+	for (auto it = m_targets.lower_bound(start); it != m_targets.end() && it->first < stop; ++it) touched.push_back(it->second.address);
+	for (const auto& [source, destination] : fresh_targets) touched.push_back(destination.address);
+
+	const auto reached_after_stop = [&](std::uint32_t destination) {
+		return destination >= m_base_address && destination - m_base_address >= stop;
+	};
+	std::vector<std::pair<std::uint32_t, std::optional<ArmMode>>> before;
+	for (std::uint32_t destination : touched) {
+		if (reached_after_stop(destination)) before.emplace_back(destination, target_mode(destination, destination - m_base_address));
+	}
+
+	for (auto it = m_targets.lower_bound(start); it != m_targets.end() && it->first < stop; ) {
+		m_target_modes.erase({ it->second.address, it->first });
+		it = m_targets.erase(it);
+	}
+	for (const auto& [source, destination] : fresh_targets) {
+		m_targets.emplace(source, destination);
+		m_target_modes[{ destination.address, source }] = destination.mode;
+	}
+
+	for (const auto& [destination, mode_before] : before) {
+		if (target_mode(destination, destination - m_base_address) != mode_before) pending.insert(destination - m_base_address);
+	}
+
+	// Splice the new run over the old one
+	const std::size_t swept = fresh.size();
+	const std::size_t replaced = last - first;
+	if (replaced == m_entries.size()) m_entries = std::move(fresh);
+	else splice(m_entries, first, last, fresh);
+
+	return swept;
+}
+
+template class td::ModeSweep<std::endian::little>;
+template class td::ModeSweep<std::endian::big>;
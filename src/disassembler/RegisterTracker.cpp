@@ -0,0 +1,302 @@
+#include <cstdint>
+#include <optional>
+
+#include <totr/disassembler/RegisterTracker.hpp>
+
+namespace td = totr::Disassembler;
+
+namespace {
+	constexpr std::uint8_t NONE = 0xFF;
+	constexpr std::uint8_t SP = 13, LR = 14, PC = 15;
+
+	std::uint32_t rotr32(std::uint32_t value, std::uint32_t rot) {
+		rot &= 31;
+		return (value >> rot) | (value << ((32 - rot) & 31));
+	}
+
+	// ARM operand 2 register form; `shift` is Bit 11-4 of the instruction.
+	std::optional<std::uint32_t> apply_shift(std::optional<std::uint32_t> value, std::uint8_t shift) {
+		if (!value || (shift & 0x1)) return std::nullopt; // shift by register
+		const std::uint8_t amount = shift >> 3;
+		const std::uint32_t v = *value;
+		switch ((shift >> 1) & 0x3) {
+			case 0: return v << amount;
+			case 1: return amount ? v >> amount : 0u;
+			case 2: return static_cast<std::uint32_t>(static_cast<std::int32_t>(v) >> (amount ? amount : 31));
+			default: if (amount == 0) return std::nullopt; return rotr32(v, amount); // RRX needs the carry flag
+		}
+	}
+
+	// ARM data processing opcodes; those needing the carry flag stay unknown.
+	std::optional<std::uint32_t> arm_alu(std::uint8_t opcode, std::uint32_t op1, std::uint32_t op2) {
+		switch (opcode) {
+			case 0: return op1 & op2;   // AND
+			case 1: return op1 ^ op2;   // EOR
+			case 2: return op1 - op2;   // SUB
+			case 3: return op2 - op1;   // RSB
+			case 4: return op1 + op2;   // ADD
+			case 12: return op1 | op2;  // ORR
+			case 13: return op2;        // MOV
+			case 14: return op1 & ~op2; // BIC
+			case 15: return ~op2;       // MVN
+			default: return std::nullopt;
+		}
+	}
+
+	// THUMB register shifts use the bottom byte of the shift register.
+	std::optional<std::uint32_t> thumb_shift(std::uint8_t opcode, std::uint32_t value, std::uint32_t amount) {
+		amount &= 0xFF;
+		switch (opcode) {
+			case 2: return amount < 32 ? value << amount : 0u;                                         // LSL
+			case 3: return amount < 32 ? value >> amount : 0u;                                         // LSR
+			case 4: return static_cast<std::uint32_t>(static_cast<std::int32_t>(value) >> (amount < 32 ? amount : 31)); // ASR
+			case 7: return rotr32(value, amount);                                                      // ROR
+			default: return std::nullopt;
+		}
+	}
+}
+
+std::optional<td::BranchTarget> td::RegisterTracker::branch_exchange_target(const DecodedFields& fields) const {
+	if (!(fields.flags & DecodeFlag::BranchExchange)) return std::nullopt;
+	const auto destination = value(fields.rm);
+	if (!destination) return std::nullopt;
+
+	if (*destination & 1) return BranchTarget{ *destination & ~1u, ArmMode::THUMB };
+	return BranchTarget{ *destination & ~3u, ArmMode::ARM };
+}
+
+void td::RegisterTracker::assign(std::uint8_t reg, std::optional<std::uint32_t> value, bool conditional) {
+	if (reg >= 16) return;
+	// A skipped conditional write keeps the old value, so only agreement keeps the register known
+	if (conditional && !(value && this->value(reg) == value)) { forget(reg); return; }
+	if (!value) { forget(reg); return; }
+
+	m_values[reg] = *value;
+	m_known |= 1u << reg;
+}
+
+template <std::endian Order>
+void td::RegisterTracker::step(const DecodedFields& fields, ArmMode mode, std::uint32_t pc, const MemoryReader<Order>& memory, std::uint32_t base_address) {
+	const bool is_arm = mode == ArmMode::ARM;
+
+	// Invalid words are most likely data; nothing known survives them
+	if (!fields.is_valid()) { reset(); return; }
+
+	if (fields.flags & DecodeFlag::BranchExchange) {
+		// Registers survive only when the BX lands on the next instruction in address order
+		const auto target = branch_exchange_target(fields);
+		const bool falls_through = target && target->address == pc + (is_arm ? 4 : 2);
+		if (fields.cond == 0xE && !falls_through) reset();
+		return;
+	}
+
+	// Literal pool loads: LDR Rd, [PC, #offset]
+	std::optional<std::uint32_t> literal;
+	std::optional<std::uint32_t> literal_address;
+	bool literal_byte = false;
+	if (is_arm && fields.format == InstrFormat::ArmSingleDataTrans && fields.rn == PC
+		&& (fields.flags & (DecodeFlag::Load | DecodeFlag::PreIndex | DecodeFlag::Immediate)) == (DecodeFlag::Load | DecodeFlag::PreIndex | DecodeFlag::Immediate)
+		&& !(fields.flags & DecodeFlag::WriteBack)) {
+		literal_address = (fields.flags & DecodeFlag::AddOffset) ? pc + 8 + fields.imm : pc + 8 - fields.imm;
+		literal_byte = fields.flags & DecodeFlag::Byte;
+	}
+	else if (!is_arm && fields.format == InstrFormat::ThumbPcRelLoad) {
+		literal_address = ((pc + 4) & ~2u) + fields.imm;
+	}
+
+	if (literal_address) {
+		const std::uint32_t offset = *literal_address - base_address;
+		const std::uint32_t width = literal_byte ? 1 : 4;
+		if (*literal_address >= base_address && offset + width <= memory.size() && (literal_byte || (offset & 3) == 0)) {
+			literal = literal_byte ? memory.bytes()[offset] : memory.read_word(offset);
+		}
+	}
+
+	if (is_arm) step_arm(fields, pc, literal);
+	else step_thumb(fields, pc, literal);
+}
+
+void td::RegisterTracker::step_arm(const DecodedFields& fields, std::uint32_t pc, std::optional<std::uint32_t> literal) {
+	const bool conditional = fields.cond != 0xE;
+	const std::uint32_t pc_value = pc + 8;
+
+	switch (fields.format) {
+		case InstrFormat::ArmDataProc: {
+			if (fields.opcode >= 8 && fields.opcode <= 11) return; // TST, TEQ, CMP, CMN
+			if (fields.rd == PC) { if (!conditional) reset(); return; }
+
+			std::optional<std::uint32_t> op2;
+			if (fields.flags & DecodeFlag::Immediate) op2 = fields.imm;
+			else op2 = apply_shift(operand(fields.rm, pc_value), static_cast<std::uint8_t>(fields.imm));
+
+			const std::optional<std::uint32_t> op1 = (fields.rn == NONE) ? 0u : operand(fields.rn, pc_value);
+			assign(fields.rd, (op1 && op2) ? arm_alu(fields.opcode, *op1, *op2) : std::nullopt, conditional);
+			return;
+		}
+		case InstrFormat::ArmMul: {
+			const auto rm = value(fields.rm), rs = value(fields.rs);
+			std::optional<std::uint32_t> product;
+			if (rm && rs) product = *rm * *rs;
+			if (product && fields.rn != NONE) {
+				const auto accumulate = value(fields.rn);
+				product = accumulate ? std::optional<std::uint32_t>(*product + *accumulate) : std::nullopt;
+			}
+			assign(fields.rd, product, conditional);
+			return;
+		}
+		case InstrFormat::ArmMulLong:
+			forget(fields.rd);
+			forget(fields.rn);
+			return;
+		case InstrFormat::ArmSingleDataTrans:
+		case InstrFormat::ArmHalfwordTransReg:
+		case InstrFormat::ArmHalfwordTransImm:
+			if ((fields.flags & DecodeFlag::WriteBack) || !(fields.flags & DecodeFlag::PreIndex)) forget(fields.rn);
+			if (fields.flags & DecodeFlag::Load) {
+				if (fields.rd == PC) { if (!conditional) reset(); return; }
+				assign(fields.rd, literal, conditional);
+			}
+			return;
+		case InstrFormat::ArmBlockDataTrans:
+			if (fields.flags & DecodeFlag::WriteBack) forget(fields.rn);
+			if (fields.flags & DecodeFlag::Load) {
+				if ((fields.imm & 0x8000) && !conditional) { reset(); return; }
+				forget_list(fields.imm);
+			}
+			return;
+		case InstrFormat::ArmSingleDataSwap:
+		case InstrFormat::ArmPsrMrs:
+			forget(fields.rd);
+			return;
+		case InstrFormat::ArmPsrMsrReg:
+		case InstrFormat::ArmPsrMsrImm:
+			return;
+		case InstrFormat::ArmBranch:
+			if (fields.flags & DecodeFlag::Link) {
+				clobber_call();
+				assign(LR, pc + 4, conditional);
+			}
+			else if (!conditional) reset();
+			return;
+		case InstrFormat::ArmSwi:
+			clobber_call();
+			return;
+		default: // Undefined
+			reset();
+			return;
+	}
+}
+
+void td::RegisterTracker::step_thumb(const DecodedFields& fields, std::uint32_t pc, std::optional<std::uint32_t> literal) {
+	const std::uint32_t pc_value = pc + 4;
+
+	switch (fields.format) {
+		case InstrFormat::ThumbMoveShiftedReg: {
+			const auto source = value(fields.rn);
+			std::optional<std::uint32_t> result;
+			if (source) {
+				// An immediate of 0 means a shift by 32 for LSR and ASR
+				const std::uint32_t amount = (fields.imm == 0 && fields.opcode != 0) ? 32 : fields.imm;
+				result = thumb_shift(static_cast<std::uint8_t>(fields.opcode + 2), *source, amount);
+			}
+			assign(fields.rd, result, false);
+			return;
+		}
+		case InstrFormat::ThumbAddSub: {
+			const auto op1 = value(fields.rn);
+			const auto op2 = (fields.flags & DecodeFlag::Immediate) ? std::optional<std::uint32_t>(fields.imm) : value(fields.rm);
+			std::optional<std::uint32_t> result;
+			if (op1 && op2) result = fields.opcode ? *op1 - *op2 : *op1 + *op2;
+			assign(fields.rd, result, false);
+			return;
+		}
+		case InstrFormat::ThumbMovCmpAddSubImm: {
+			const auto current = value(fields.rd);
+			switch (fields.opcode) {
+				case 0: assign(fields.rd, fields.imm, false); break;
+				case 2: assign(fields.rd, current ? std::optional<std::uint32_t>(*current + fields.imm) : std::nullopt, false); break;
+				case 3: assign(fields.rd, current ? std::optional<std::uint32_t>(*current - fields.imm) : std::nullopt, false); break;
+				default: break; // CMP
+			}
+			return;
+		}
+		case InstrFormat::ThumbAluOps: {
+			const auto op1 = value(fields.rd), op2 = value(fields.rm);
+			std::optional<std::uint32_t> result;
+			switch (fields.opcode) {
+				case 8: case 10: case 11: return; // TST, CMP, CMN
+				case 9: if (op2) result = 0u - *op2; break;  // NEG
+				case 15: if (op2) result = ~*op2; break;     // MVN
+				default:
+					if (!op1 || !op2) break;
+					switch (fields.opcode) {
+						case 0: result = *op1 & *op2; break;
+						case 1: result = *op1 ^ *op2; break;
+						case 12: result = *op1 | *op2; break;
+						case 13: result = *op1 * *op2; break;
+						case 14: result = *op1 & ~*op2; break;
+						default: result = thumb_shift(fields.opcode, *op1, *op2); break;
+					}
+			}
+			assign(fields.rd, result, false);
+			return;
+		}
+		case InstrFormat::ThumbHiRegOpsBx: {
+			if (fields.opcode == 1) return; // CMP
+			if (fields.rd == PC) { reset(); return; }
+			const auto source = operand(fields.rm, pc_value);
+			std::optional<std::uint32_t> result;
+			if (fields.opcode == 2) result = source;
+			else if (source && value(fields.rd)) result = *value(fields.rd) + *source;
+			assign(fields.rd, result, false);
+			return;
+		}
+		case InstrFormat::ThumbPcRelLoad:
+			assign(fields.rd, literal, false);
+			return;
+		case InstrFormat::ThumbLoadAddress: {
+			// ADR reads the word-aligned PC
+			const auto base = (fields.rn == PC) ? std::optional<std::uint32_t>(pc_value & ~2u) : value(fields.rn);
+			assign(fields.rd, base ? std::optional<std::uint32_t>(*base + fields.imm) : std::nullopt, false);
+			return;
+		}
+		case InstrFormat::ThumbAddOffToSp: {
+			const auto sp = value(SP);
+			assign(SP, sp ? std::optional<std::uint32_t>(fields.opcode ? *sp - fields.imm : *sp + fields.imm) : std::nullopt, false);
+			return;
+		}
+		case InstrFormat::ThumbLoadStoreRegOff:
+		case InstrFormat::ThumbLoadStoreSignExt:
+		case InstrFormat::ThumbLoadStoreImmOff:
+		case InstrFormat::ThumbLoadStoreHalfword:
+		case InstrFormat::ThumbSpRelLoadStore:
+			if (fields.flags & DecodeFlag::Load) forget(fields.rd);
+			return;
+		case InstrFormat::ThumbPushPopReg:
+			forget(SP);
+			if (fields.flags & DecodeFlag::Load) {
+				if (fields.imm & 0x8000) { reset(); return; } // POP {..., PC}
+				forget_list(fields.imm);
+			}
+			return;
+		case InstrFormat::ThumbMultiLoadStore:
+			forget(fields.rn);
+			if (fields.flags & DecodeFlag::Load) forget_list(fields.imm);
+			return;
+		case InstrFormat::ThumbCondBranch:
+			return;
+		case InstrFormat::ThumbSwi:
+			clobber_call();
+			return;
+		case InstrFormat::ThumbLongBranchLink:
+			clobber_call();
+			assign(LR, (pc + 4) | 1, false);
+			return;
+		default: // Unconditional branch
+			reset();
+			return;
+	}
+}
+
+template void td::RegisterTracker::step(const DecodedFields&, ArmMode, std::uint32_t, const td::LittleEndianReader&, std::uint32_t);
+template void td::RegisterTracker::step(const DecodedFields&, ArmMode, std::uint32_t, const td::BigEndianReader&, std::uint32_t);
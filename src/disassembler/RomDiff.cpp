@@ -0,0 +1,112 @@
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <vector>
+
+#include <totr/disassembler/ArmDisasm.hpp>
+#include <totr/disassembler/RomDiff.hpp>
+
+namespace td = totr::Disassembler;
+
+namespace {
+	constexpr std::size_t BLOCK_SIZE = 1 << 16;
+
+	// Offset of the first differing byte in [from, to), or `to`
+	std::size_t first_difference(const std::uint8_t* a, const std::uint8_t* b, std::size_t from, std::size_t to) {
+		while (from < to) {
+			const std::size_t length = std::min(BLOCK_SIZE, to - from);
+			if (std::memcmp(a + from, b + from, length) != 0) break;
+			from += length;
+		}
+
+		for (; from + 8 <= to; from += 8) {
+			std::uint64_t x, y;
+			std::memcpy(&x, a + from, 8);
+			std::memcpy(&y, b + from, 8);
+			if (x != y) {
+				const std::uint64_t bits = x ^ y;
+				if constexpr (std::endian::native == std::endian::little) return from + (std::countr_zero(bits) >> 3);
+				else return from + (std::countl_zero(bits) >> 3);
+			}
+		}
+		while (from < to && a[from] == b[from]) ++from;
+		return from;
+	}
+
+	// One past the last differing byte of the change starting at `from`; the change ends at the
+	// first run of `gap` equal bytes
+	std::size_t end_of_change(const std::uint8_t* a, const std::uint8_t* b, std::size_t from, std::size_t to, std::size_t gap) {
+		std::size_t last = from;
+		for (std::size_t i = from; i < to && i - last <= gap; ++i) {
+			if (a[i] != b[i]) last = i;
+		}
+		return last + 1;
+	}
+
+	// BL prefix: |1 1 1 1|0|offset high|
+	bool is_bl_prefix(std::uint16_t halfword) {
+		return (halfword & 0xF800) == 0xF000;
+	}
+
+	template <std::endian Order>
+	std::size_t unconditional_words(const td::MemoryReader<Order>& memory, std::uint32_t start, std::uint32_t end) {
+		std::size_t count = 0;
+		for (std::uint32_t offset = start; offset + 4 <= std::min<std::size_t>(end, memory.size()); offset += 4) {
+			const td::DecodedFields fields = td::ArmDisasm::decode_fields(offset, memory.fetch_arm(offset));
+			if (fields.is_valid() && fields.cond == 0xE) ++count;
+		}
+		return count;
+	}
+}
+
+std::vector<td::ByteRange> td::find_changes(std::span<const std::uint8_t> old_rom, std::span<const std::uint8_t> new_rom, std::uint32_t merge_gap) {
+	std::vector<ByteRange> changes;
+	const std::size_t common = std::min(old_rom.size(), new_rom.size());
+	const std::size_t longest = std::max(old_rom.size(), new_rom.size());
+
+	std::size_t offset = 0;
+	while ((offset = first_difference(old_rom.data(), new_rom.data(), offset, common)) < common) {
+		const std::size_t end = end_of_change(old_rom.data(), new_rom.data(), offset, common, merge_gap);
+		changes.push_back({ static_cast<std::uint32_t>(offset), static_cast<std::uint32_t>(end) });
+		offset = end;
+	}
+
+	if (longest > common) {
+		if (!changes.empty() && changes.back().end + merge_gap >= common) changes.back().end = static_cast<std::uint32_t>(longest);
+		else changes.push_back({ static_cast<std::uint32_t>(common), static_cast<std::uint32_t>(longest) });
+	}
+	return changes;
+}
+
+template <std::endian Order>
+std::vector<td::DiffWindow> td::diff_windows(const MemoryReader<Order>& old_memory, const MemoryReader<Order>& new_memory,
+	std::span<const ByteRange> changes, std::uint32_t context) {
+	const std::uint32_t limit = static_cast<std::uint32_t>(std::max(old_memory.size(), new_memory.size()));
+
+	std::vector<DiffWindow> windows;
+	for (const ByteRange& change : changes) {
+		const std::uint32_t start = (change.start > context ? change.start - context : 0) & ~3u;
+		const std::uint32_t end = std::min<std::uint64_t>((std::uint64_t{ change.end } + context + 3) & ~std::uint64_t{ 3 }, limit);
+
+		if (!windows.empty() && start <= windows.back().end) windows.back().end = std::max(windows.back().end, end);
+		else windows.push_back({ start, end, ArmMode::ARM });
+	}
+
+	for (DiffWindow& window : windows) {
+		const std::size_t words = (window.end - window.start) / 4 * 2;
+		const std::size_t unconditional = unconditional_words(old_memory, window.start, window.end)
+			+ unconditional_words(new_memory, window.start, window.end);
+		window.mode = (words != 0 && unconditional * 2 >= words) ? ArmMode::ARM : ArmMode::THUMB;
+
+		if (window.mode == ArmMode::THUMB && window.start >= 2
+			&& (is_bl_prefix(old_memory.read_halfword(window.start - 2)) || is_bl_prefix(new_memory.read_halfword(window.start - 2)))) {
+			window.start -= 2;
+		}
+	}
+	return windows;
+}
+
+template std::vector<td::DiffWindow> td::diff_windows(const td::LittleEndianReader&, const td::LittleEndianReader&, std::span<const td::ByteRange>, std::uint32_t);
+template std::vector<td::DiffWindow> td::diff_windows(const td::BigEndianReader&, const td::BigEndianReader&, std::span<const td::ByteRange>, std::uint32_t);
@@ -0,0 +1,188 @@
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <totr/disassembler/SignatureMatcher.hpp>
+
+namespace td = totr::Disassembler;
+
+namespace {
+	// Smallest share of the image handed to one thread; below this spawning costs more than scanning.
+	constexpr std::size_t MIN_BYTES_PER_THREAD = 1 << 20;
+
+	std::uint32_t unit_size(td::ArmMode mode) {
+		return (mode == td::ArmMode::ARM) ? 4 : 2;
+	}
+
+	std::uint32_t byte_swap(std::uint32_t value) {
+		return (value >> 24) | ((value >> 8) & 0xFF00) | ((value << 8) & 0xFF0000) | (value << 24);
+	}
+}
+
+td::SignatureUnit td::parse_signature_unit(std::string_view token, ArmMode mode) {
+	const std::size_t bits = (mode == ArmMode::ARM) ? 32 : 16;
+	SignatureUnit unit{ 0, 0 };
+
+	// `0b` only starts a binary pattern of full width; `0B0E` is a THUMB unit in hex
+	if (token.size() == bits + 2 && token[0] == '0' && (token[1] == 'b' || token[1] == 'B')) {
+		token.remove_prefix(2);
+		for (char digit : token) {
+			unit.mask <<= 1;
+			unit.value <<= 1;
+			if (digit == '0' || digit == '1') {
+				unit.mask |= 1;
+				unit.value |= static_cast<std::uint32_t>(digit - '0');
+			}
+			else if (digit != 'x' && digit != 'X' && digit != '?') {
+				throw std::invalid_argument("Bad binary digit in signature unit: " + std::string(token));
+			}
+		}
+		return unit;
+	}
+
+	if (token.size() > 2 && token[0] == '0' && (token[1] == 'x' || token[1] == 'X')) token.remove_prefix(2);
+	if (token.size() != bits / 4) {
+		throw std::invalid_argument("Expected " + std::to_string(bits / 4) + " hex or " + std::to_string(bits) + " binary digits: " + std::string(token));
+	}
+	for (char digit : token) {
+		unit.mask <<= 4;
+		unit.value <<= 4;
+		if (digit == '?') continue;
+
+		std::uint32_t nibble;
+		if (digit >= '0' && digit <= '9') nibble = digit - '0';
+		else if (digit >= 'a' && digit <= 'f') nibble = digit - 'a' + 10;
+		else if (digit >= 'A' && digit <= 'F') nibble = digit - 'A' + 10;
+		else throw std::invalid_argument("Bad hex digit in signature unit: " + std::string(token));
+		unit.mask |= 0xF;
+		unit.value |= nibble;
+	}
+	return unit;
+}
+
+td::SignatureMatcher::SignatureMatcher(std::vector<Signature> signatures) : m_signatures(std::move(signatures)) {
+	for (std::uint32_t index = 0; index < m_signatures.size(); ++index) {
+		const Signature& signature = m_signatures[index];
+		if (signature.units.empty()) continue;
+
+		// The most specific unit rejects the most positions
+		std::uint32_t anchor = 0;
+		for (std::uint32_t unit = 1; unit < signature.units.size(); ++unit) {
+			if (std::popcount(signature.units[unit].mask) > std::popcount(signature.units[anchor].mask)) anchor = unit;
+		}
+		const SignatureUnit& unit = signature.units[anchor];
+
+		auto group = std::find_if(m_groups.begin(), m_groups.end(),
+			[&](const AnchorGroup& candidate) { return candidate.mode == signature.mode && candidate.mask == unit.mask; });
+		if (group == m_groups.end()) {
+			m_groups.push_back({ signature.mode, unit.mask, std::vector<std::uint64_t>(65536 / 64, 0), {} });
+			group = std::prev(m_groups.end());
+		}
+
+		const std::uint32_t value = unit.value & unit.mask;
+		const std::uint32_t slot = filter_slot(value);
+		group->filter[slot >> 6] |= std::uint64_t{ 1 } << (slot & 63);
+		group->anchors.push_back({ value, index, anchor });
+	}
+
+	for (AnchorGroup& group : m_groups) {
+		std::sort(group.anchors.begin(), group.anchors.end(),
+			[](const Anchor& a, const Anchor& b) { return a.value < b.value; });
+	}
+}
+
+template <std::endian Order>
+bool td::SignatureMatcher::matches(const MemoryReader<Order>& memory, const Signature& signature, std::uint32_t offset) const {
+	const std::uint32_t size = unit_size(signature.mode);
+	if (offset + signature.units.size() * size > memory.size()) return false;
+
+	for (const SignatureUnit& unit : signature.units) {
+		const std::uint32_t encoding = (size == 4) ? memory.read_word(offset) : memory.read_halfword(offset);
+		if ((encoding & unit.mask) != unit.value) return false;
+		offset += size;
+	}
+	return true;
+}
+
+template <std::endian Order>
+std::vector<td::SignatureHit> td::SignatureMatcher::scan(const MemoryReader<Order>& memory, unsigned thread_count) const {
+	if (thread_count == 0) thread_count = std::max(1u, std::thread::hardware_concurrency());
+
+	const std::uint8_t* bytes = memory.bytes().data();
+	const std::uint32_t size = static_cast<std::uint32_t>(memory.size());
+
+	const auto probe = [&](const AnchorGroup& group, std::uint32_t encoding, std::uint32_t offset, std::vector<SignatureHit>& hits) {
+		const std::uint32_t key = encoding & group.mask;
+		const std::uint32_t slot = filter_slot(key);
+		if (!((group.filter[slot >> 6] >> (slot & 63)) & 1)) return;
+
+		auto it = std::lower_bound(group.anchors.begin(), group.anchors.end(), key,
+			[](const Anchor& anchor, std::uint32_t value) { return anchor.value < value; });
+		for (; it != group.anchors.end() && it->value == key; ++it) {
+			const std::uint32_t back = it->unit * unit_size(group.mode);
+			if (back > offset) continue;
+			if (matches(memory, m_signatures[it->signature], offset - back)) hits.push_back({ offset - back, it->signature });
+		}
+	};
+
+	// Anchors in the word-aligned range [first, last): one load per word serves the ARM groups
+	// and both THUMB halfwords
+	const auto scan_range = [&](std::uint32_t first, std::uint32_t last, std::vector<SignatureHit>& hits) {
+		for (std::uint32_t offset = first; offset < last; offset += 4) {
+			std::uint32_t word;
+			if (offset + 4 <= size) {
+				std::memcpy(&word, bytes + offset, 4);
+				if constexpr (Order != std::endian::native) word = byte_swap(word);
+			}
+			else {
+				word = memory.read_word(offset);
+			}
+			const std::uint32_t first_half = (Order == std::endian::little) ? (word & 0xFFFF) : (word >> 16);
+			const std::uint32_t second_half = (Order == std::endian::little) ? (word >> 16) : (word & 0xFFFF);
+
+			for (const AnchorGroup& group : m_groups) {
+				if (group.mode == ArmMode::ARM) {
+					probe(group, word, offset, hits);
+				}
+				else {
+					probe(group, first_half, offset, hits);
+					probe(group, second_half, offset + 2, hits);
+				}
+			}
+		}
+	};
+
+	const std::uint32_t limit = static_cast<std::uint32_t>(memory.size());
+	const std::size_t shares = std::max<std::size_t>(1, std::min<std::size_t>(thread_count, limit / MIN_BYTES_PER_THREAD));
+	std::vector<std::vector<SignatureHit>> results(shares);
+
+	// Shares start on word boundaries so every ARM anchor falls in exactly one of them
+	const std::uint32_t per_share = static_cast<std::uint32_t>(((limit + shares - 1) / shares + 3) & ~std::size_t{ 3 });
+	std::vector<std::thread> workers;
+	for (std::size_t share = 1; share < shares; ++share) {
+		const std::uint32_t first = std::min<std::uint32_t>(limit, static_cast<std::uint32_t>(share) * per_share);
+		const std::uint32_t last = std::min<std::uint32_t>(limit, first + per_share);
+		workers.emplace_back(scan_range, first, last, std::ref(results[share]));
+	}
+	scan_range(0, std::min(limit, per_share), results[0]);
+	for (std::thread& worker : workers) worker.join();
+
+	std::vector<SignatureHit> hits;
+	for (const std::vector<SignatureHit>& share : results) hits.insert(hits.end(), share.begin(), share.end());
+
+	// Anchors are found in offset order, but a signature's start can precede another's anchor
+	std::sort(hits.begin(), hits.end(), [](const SignatureHit& a, const SignatureHit& b) {
+		return a.offset != b.offset ? a.offset < b.offset : a.signature < b.signature;
+	});
+	return hits;
+}
+
+template std::vector<td::SignatureHit> td::SignatureMatcher::scan(const td::LittleEndianReader&, unsigned) const;
+template std::vector<td::SignatureHit> td::SignatureMatcher::scan(const td::BigEndianReader&, unsigned) const;
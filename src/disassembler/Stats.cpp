@@ -0,0 +1,130 @@
+#include <cstdint>
+#include <iomanip>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+#include <totr/disassembler/Stats.hpp>
+
+namespace td = totr::Disassembler;
+
+namespace {
+	void add_stats(td::RunStats& total, const td::RunStats& stats) {
+		for (std::size_t i = 0; i < total.phases.size(); ++i) {
+			total.phases[i].calls += stats.phases[i].calls;
+			total.phases[i].nanoseconds += stats.phases[i].nanoseconds;
+		}
+		for (std::size_t i = 0; i < total.formats.size(); ++i) total.formats[i] += stats.formats[i];
+		total.instructions += stats.instructions;
+		total.invalid += stats.invalid;
+		total.bx_events += stats.bx_events;
+		total.bx_resolved += stats.bx_resolved;
+		total.bx_ambiguous += stats.bx_ambiguous;
+		total.bx_tracked += stats.bx_tracked;
+		total.exception_returns += stats.exception_returns;
+		total.override_hits += stats.override_hits;
+		total.mode_resyncs += stats.mode_resyncs;
+	}
+
+	// Counters of running threads, and the sum of those that have exited. Thread-local objects
+	// are destroyed before these, so the main thread's counters still fold in at exit.
+	std::mutex registry_mutex;
+	std::vector<const td::RunStats*> live_stats;
+	td::RunStats retired_stats;
+
+	struct ThreadStats {
+		td::RunStats stats;
+
+		ThreadStats() {
+			std::lock_guard lock{ registry_mutex };
+			live_stats.push_back(&stats);
+		}
+		~ThreadStats() {
+			std::lock_guard lock{ registry_mutex };
+			add_stats(retired_stats, stats);
+			std::erase(live_stats, &stats);
+		}
+	};
+}
+
+td::RunStats& td::run_stats() {
+	thread_local ThreadStats local;
+	return local.stats;
+}
+
+td::RunStats td::collect_stats() {
+	std::lock_guard lock{ registry_mutex };
+	RunStats total = retired_stats;
+	for (const RunStats* stats : live_stats) add_stats(total, *stats);
+	return total;
+}
+
+const char* td::get_phase_name(Phase phase) {
+	switch (phase) {
+		case Phase::LoadRom: return "load_rom";
+		case Phase::LoadOverrides: return "load_overrides";
+		case Phase::Decode: return "decode";
+		case Phase::ProbeMode: return "probe_mode";
+		case Phase::OverrideLookup: return "override_lookup";
+		case Phase::Print: return "print_instruction";
+		case Phase::Count: break;
+	}
+	return "unknown";
+}
+
+void td::write_stats_text(std::ostream& out, const RunStats& stats) {
+	out << "\n--- Statistics ---\n";
+	out << std::left << std::setw(20) << "Phase" << std::right << std::setw(12) << "Calls"
+		<< std::setw(14) << "Total (ms)" << std::setw(12) << "ns/call" << "\n";
+
+	for (std::size_t i = 0; i < stats.phases.size(); ++i) {
+		const PhaseStats& phase = stats.phases[i];
+		if (phase.calls == 0) continue;
+		out << std::left << std::setw(20) << get_phase_name(static_cast<Phase>(i)) << std::right
+			<< std::setw(12) << phase.calls
+			<< std::setw(14) << std::fixed << std::setprecision(3) << (phase.nanoseconds / 1e6)
+			<< std::setw(12) << (phase.nanoseconds / phase.calls) << "\n";
+	}
+
+	out << "\nInstructions:        " << stats.instructions << "\n";
+	out << "Invalid:             " << stats.invalid << "\n";
+	out << "BX events:           " << stats.bx_events << " (" << stats.bx_resolved << " resolved, "
+		<< stats.bx_ambiguous << " ambiguous, " << stats.bx_tracked << " tracked)\n";
+	out << "Exception returns:   " << stats.exception_returns << "\n";
+	out << "Override hits:       " << stats.override_hits << "\n";
+	out << "Mode resyncs:        " << stats.mode_resyncs << "\n";
+
+	out << "\nFormats:\n";
+	for (std::size_t i = 0; i < stats.formats.size(); ++i) {
+		if (stats.formats[i] == 0) continue;
+		out << "  " << std::left << std::setw(30) << get_format_name(static_cast<InstrFormat>(i))
+			<< std::right << std::setw(12) << stats.formats[i] << "\n";
+	}
+}
+
+void td::write_stats_json(std::ostream& out, const RunStats& stats) {
+	out << "{\"phases\":{";
+	for (std::size_t i = 0; i < stats.phases.size(); ++i) {
+		if (i) out << ",";
+		out << "\"" << get_phase_name(static_cast<Phase>(i)) << "\":{\"calls\":" << stats.phases[i].calls
+			<< ",\"ns\":" << stats.phases[i].nanoseconds << "}";
+	}
+
+	out << "},\"counters\":{"
+		<< "\"instructions\":" << stats.instructions
+		<< ",\"invalid\":" << stats.invalid
+		<< ",\"bx_events\":" << stats.bx_events
+		<< ",\"bx_resolved\":" << stats.bx_resolved
+		<< ",\"bx_ambiguous\":" << stats.bx_ambiguous
+		<< ",\"bx_tracked\":" << stats.bx_tracked
+		<< ",\"exception_returns\":" << stats.exception_returns
+		<< ",\"override_hits\":" << stats.override_hits
+		<< ",\"mode_resyncs\":" << stats.mode_resyncs;
+
+	out << "},\"formats\":{";
+	for (std::size_t i = 0; i < stats.formats.size(); ++i) {
+		if (i) out << ",";
+		out << "\"" << get_format_name(static_cast<InstrFormat>(i)) << "\":" << stats.formats[i];
+	}
+	out << "}}\n";
+}
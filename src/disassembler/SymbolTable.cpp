@@ -0,0 +1,57 @@
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <totr/disassembler/SymbolTable.hpp>
+
+namespace td = totr::Disassembler;
+
+void td::SymbolTable::add(std::uint32_t address, std::string_view name) {
+	m_addresses.push_back(address);
+	m_names.push_back({ static_cast<std::uint32_t>(m_name_pool.size()), static_cast<std::uint32_t>(name.size()) });
+	m_name_pool.append(name);
+}
+
+void td::SymbolTable::finalize() {
+	std::vector<std::uint32_t> order(m_addresses.size());
+	std::iota(order.begin(), order.end(), 0u);
+	std::stable_sort(order.begin(), order.end(), [this](std::uint32_t a, std::uint32_t b) { return m_addresses[a] < m_addresses[b]; });
+
+	std::vector<std::uint32_t> addresses;
+	std::vector<NameRef> names;
+	addresses.reserve(order.size());
+	names.reserve(order.size());
+	for (std::uint32_t index : order) {
+		if (!addresses.empty() && addresses.back() == m_addresses[index]) continue;
+		addresses.push_back(m_addresses[index]);
+		names.push_back(m_names[index]);
+	}
+
+	m_addresses = std::move(addresses);
+	m_names = std::move(names);
+}
+
+std::string_view td::SymbolTable::name(std::size_t index) const {
+	const NameRef& entry = m_names[index];
+	return std::string_view(m_name_pool).substr(entry.offset, entry.length);
+}
+
+std::size_t td::SymbolTable::lower_bound(std::uint32_t address) const {
+	return static_cast<std::size_t>(std::lower_bound(m_addresses.begin(), m_addresses.end(), address) - m_addresses.begin());
+}
+
+std::optional<std::string_view> td::SymbolTable::find(std::uint32_t address) const {
+	std::size_t index = lower_bound(address);
+	if (index == m_addresses.size() || m_addresses[index] != address) return std::nullopt;
+	return name(index);
+}
+
+std::optional<td::SymbolMatch> td::SymbolTable::find_containing(std::uint32_t address) const {
+	auto it = std::upper_bound(m_addresses.begin(), m_addresses.end(), address);
+	if (it == m_addresses.begin()) return std::nullopt;
+	std::size_t index = static_cast<std::size_t>(it - m_addresses.begin()) - 1;
+	return SymbolMatch{ name(index), address - m_addresses[index] };
+}
@@ -1,6 +1,7 @@
-#include <format>
 #include <string>
 #include <cstdint>
+#include <optional>
+#include <span>
 
 #include <totr/disassembler/ThumbDisasm.hpp>
 #include <totr/disassembler/Common.hpp>
@@ -8,51 +9,88 @@
 namespace td = totr::Disassembler;
 
 td::InstructionData td::ThumbDisasm::decode(std::uint32_t pc, const std::uint32_t instr) const {
-	return thumb_dispatcher(pc, instr);
+	InstructionData data;
+	decode(pc, instr, data);
+	return data;
 }
 
-/* --- Utility Methods --- */
+void td::ThumbDisasm::decode(std::uint32_t pc, const std::uint32_t instr, InstructionData& out) const {
+	// One branch per instruction; the renderers themselves test nothing
+	static const BasicThumbDisasm<HexFormat> hex;
+	static const BasicThumbDisasm<DecimalFormat> decimal;
+	if (m_print_literals_hex) hex.decode(pc, instr, out);
+	else decimal.decode(pc, instr, out);
+}
 
-std::string td::ThumbDisasm::print_literal(std::uint32_t v, bool prefix_hash) const {
-	if (m_print_literals_hex) {
-		if (prefix_hash) return std::format("#0x{:X}", v);
-		return std::format("0x{:X}", v);
-	}
-	if (prefix_hash) return std::format("#{}", v);
-	return std::format("{}", v);
+template <typename Format>
+td::InstructionData td::BasicThumbDisasm<Format>::decode(std::uint32_t pc, const std::uint32_t instr) const {
+	return thumb_dispatcher(pc, instr);
+}
+
+template <typename Format>
+void td::BasicThumbDisasm<Format>::decode(std::uint32_t pc, const std::uint32_t instr, InstructionData& out) const {
+	out = thumb_dispatcher(pc, instr);
 }
 
 /* ---  Format Dispatchers --- */
 
-td::InstructionData td::ThumbDisasm::thumb_dispatcher(std::uint32_t pc, std::uint32_t instr) const {
+td::InstrFormat td::ThumbFieldDecoder::classify(const std::uint16_t instr) {
 	std::uint8_t high_byte = instr >> 8;
 
 	// Ordered from most to least specific instruction set format masks.
-	if ((high_byte & 0xFF) == 0xB0)      return dis_add_off_to_sp(pc, instr);
-	else if ((high_byte & 0xFF) == 0xDF) return dis_swi(pc, instr);
-	else if ((high_byte & 0xFC) == 0x40) return dis_alu_ops(pc, instr);
-	else if ((high_byte & 0xFC) == 0x44) return dis_hi_reg_ops_bx(pc, instr);
-	else if ((high_byte & 0xF6) == 0xB4) return dis_push_pop_reg(pc, instr);
-	else if ((high_byte & 0xF8) == 0x18) return dis_add_sub(pc, instr);
-	else if ((high_byte & 0xF8) == 0x48) return dis_pc_rel_load(pc, instr);
-	else if ((high_byte & 0xF2) == 0x50) return dis_load_store_reg_off(pc, instr);
-	else if ((high_byte & 0xF2) == 0x52) return dis_load_store_sign_ext(pc, instr);
-	else if ((high_byte & 0xF8) == 0xE0) return dis_uncond_branch(pc, instr);
-	else if ((high_byte & 0xF0) == 0x80) return dis_load_store_halfword(pc, instr);
-	else if ((high_byte & 0xF0) == 0x90) return dis_sp_rel_load_store(pc, instr);
-	else if ((high_byte & 0xF0) == 0xA0) return dis_load_address(pc, instr);
-	else if ((high_byte & 0xF0) == 0xC0) return dis_multi_load_store(pc, instr);
-	else if ((high_byte & 0xF0) == 0xD0) return dis_cond_branch(pc, instr);
-	else if ((high_byte & 0xF0) == 0xF0) return dis_long_branch_link(pc, instr);
-	else if ((high_byte & 0xE0) == 0x00) return dis_move_shifted_reg(pc, instr);
-	else if ((high_byte & 0xE0) == 0x20) return dis_mov_cmp_add_sub_imm(pc, instr);
-	else if ((high_byte & 0xE0) == 0x60) return dis_load_store_imm_off(pc, instr);
-	return { pc, instr, "Invalid instruction.", true, 2, false, ModeEvent::None };
+	if ((high_byte & 0xFF) == 0xB0)      return InstrFormat::ThumbAddOffToSp;
+	else if ((high_byte & 0xFF) == 0xDF) return InstrFormat::ThumbSwi;
+	else if ((high_byte & 0xFC) == 0x40) return InstrFormat::ThumbAluOps;
+	else if ((high_byte & 0xFC) == 0x44) return InstrFormat::ThumbHiRegOpsBx;
+	else if ((high_byte & 0xF6) == 0xB4) return InstrFormat::ThumbPushPopReg;
+	else if ((high_byte & 0xF8) == 0x18) return InstrFormat::ThumbAddSub;
+	else if ((high_byte & 0xF8) == 0x48) return InstrFormat::ThumbPcRelLoad;
+	else if ((high_byte & 0xF2) == 0x50) return InstrFormat::ThumbLoadStoreRegOff;
+	else if ((high_byte & 0xF2) == 0x52) return InstrFormat::ThumbLoadStoreSignExt;
+	else if ((high_byte & 0xF8) == 0xE0) return InstrFormat::ThumbUncondBranch;
+	else if ((high_byte & 0xF0) == 0x80) return InstrFormat::ThumbLoadStoreHalfword;
+	else if ((high_byte & 0xF0) == 0x90) return InstrFormat::ThumbSpRelLoadStore;
+	else if ((high_byte & 0xF0) == 0xA0) return InstrFormat::ThumbLoadAddress;
+	else if ((high_byte & 0xF0) == 0xC0) return InstrFormat::ThumbMultiLoadStore;
+	else if ((high_byte & 0xF0) == 0xD0) return InstrFormat::ThumbCondBranch;
+	else if ((high_byte & 0xF0) == 0xF0) return InstrFormat::ThumbLongBranchLink;
+	else if ((high_byte & 0xE0) == 0x00) return InstrFormat::ThumbMoveShiftedReg;
+	else if ((high_byte & 0xE0) == 0x20) return InstrFormat::ThumbMovCmpAddSubImm;
+	else if ((high_byte & 0xE0) == 0x60) return InstrFormat::ThumbLoadStoreImmOff;
+	return InstrFormat::Invalid;
+}
+
+template <typename Format>
+td::InstructionData td::BasicThumbDisasm<Format>::thumb_dispatcher(std::uint32_t pc, std::uint32_t instr) const {
+	switch (classify(static_cast<std::uint16_t>(instr))) {
+		case InstrFormat::ThumbMoveShiftedReg: return dis_move_shifted_reg(pc, instr);
+		case InstrFormat::ThumbAddSub: return dis_add_sub(pc, instr);
+		case InstrFormat::ThumbMovCmpAddSubImm: return dis_mov_cmp_add_sub_imm(pc, instr);
+		case InstrFormat::ThumbAluOps: return dis_alu_ops(pc, instr);
+		case InstrFormat::ThumbHiRegOpsBx: return dis_hi_reg_ops_bx(pc, instr);
+		case InstrFormat::ThumbPcRelLoad: return dis_pc_rel_load(pc, instr);
+		case InstrFormat::ThumbLoadStoreRegOff: return dis_load_store_reg_off(pc, instr);
+		case InstrFormat::ThumbLoadStoreSignExt: return dis_load_store_sign_ext(pc, instr);
+		case InstrFormat::ThumbLoadStoreImmOff: return dis_load_store_imm_off(pc, instr);
+		case InstrFormat::ThumbLoadStoreHalfword: return dis_load_store_halfword(pc, instr);
+		case InstrFormat::ThumbSpRelLoadStore: return dis_sp_rel_load_store(pc, instr);
+		case InstrFormat::ThumbLoadAddress: return dis_load_address(pc, instr);
+		case InstrFormat::ThumbAddOffToSp: return dis_add_off_to_sp(pc, instr);
+		case InstrFormat::ThumbPushPopReg: return dis_push_pop_reg(pc, instr);
+		case InstrFormat::ThumbMultiLoadStore: return dis_multi_load_store(pc, instr);
+		case InstrFormat::ThumbCondBranch: return dis_cond_branch(pc, instr);
+		case InstrFormat::ThumbSwi: return dis_swi(pc, instr);
+		case InstrFormat::ThumbUncondBranch: return dis_uncond_branch(pc, instr);
+		case InstrFormat::ThumbLongBranchLink: return dis_long_branch_link(pc, instr);
+		default: break;
+	}
+	return { pc, instr, "Invalid instruction.", true, 2, false, ModeEvent::None, InstrFormat::Invalid };
 }
 
 /* --- Format Decoders --- */
 
-td::InstructionData td::ThumbDisasm::dis_move_shifted_reg(std::uint32_t pc, const std::uint16_t instr) const {
+template <typename Format>
+td::InstructionData td::BasicThumbDisasm<Format>::dis_move_shifted_reg(std::uint32_t pc, const std::uint16_t instr) const {
 	/*
 	|_15|_14|_13|_12|_11|_10|_9_|_8_|_7_|_6_|_5_|_4_|_3_|_2_|_1_|_0_|
 	|_0___0___0_|___Op__|_______Offset______|_____Rs____|_____Rd____|
@@ -62,21 +100,23 @@ td::InstructionData td::ThumbDisasm::dis_move_shifted_reg(std::uint32_t pc, cons
 	const std::uint8_t src_register = (instr >> 3) & 0x7; // Bit 5-3
 	const std::uint8_t dest_register = instr & 0x7;       // Bit 2-0
 
-	std::string mnemonic;
+	Mnemonic mnemonic;
 	switch (opcode) {
 		case(0): mnemonic += "LSL "; break;
 		case(1): mnemonic += "LSR "; break;
 		case(2): mnemonic += "ASR "; break;
 		// Case 3 falls into Add/Subtract format
 	}
-	mnemonic += get_register_name(dest_register) + ", ";
-	mnemonic += get_register_name(src_register) + ", ";
-	mnemonic += print_literal(offset);
+	mnemonic.append(get_register_name(dest_register), ", ");
+	mnemonic.append(get_register_name(src_register), ", ");
+	// LSR and ASR encode a shift by 32 as 0
+	print_literal(mnemonic, (offset == 0 && opcode != 0) ? 32 : offset);
 
-	return { pc, instr, mnemonic, true, 2, true, ModeEvent::None };
+	return { pc, instr, mnemonic, true, 2, true, ModeEvent::None, InstrFormat::ThumbMoveShiftedReg };
 }
 
-td::InstructionData td::ThumbDisasm::dis_add_sub(std::uint32_t pc, const std::uint16_t instr) const {
+template <typename Format>
+td::InstructionData td::BasicThumbDisasm<Format>::dis_add_sub(std::uint32_t pc, const std::uint16_t instr) const {
 	/*
 	|..........1 ..................0|
 	|5_4_3_2_1_0_9_8_7_6_5_4_3_2_1_0|
@@ -91,15 +131,17 @@ td::InstructionData td::ThumbDisasm::dis_add_sub(std::uint32_t pc, const std::ui
 	const std::uint8_t src_register = (instr >> 3) & 0x7; // Bit 5-3
 	const std::uint8_t dest_register = instr & 0x7;       // Bit 2-0
 
-	std::string mnemonic = (opcode ? "SUB " : "ADD ");
-	mnemonic += get_register_name(dest_register) + ", ";
-	mnemonic += get_register_name(src_register) + ", ";
-	mnemonic += (is_imm ? print_literal(value) : get_register_name(value));
+	Mnemonic mnemonic = (opcode ? "SUB " : "ADD ");
+	mnemonic.append(get_register_name(dest_register), ", ");
+	mnemonic.append(get_register_name(src_register), ", ");
+	if (is_imm) print_literal(mnemonic, value);
+	else mnemonic += get_register_name(value);
 
-	return { pc, instr, mnemonic, true, 2, true, ModeEvent::None };
+	return { pc, instr, mnemonic, true, 2, true, ModeEvent::None, InstrFormat::ThumbAddSub };
 }
 
-td::InstructionData td::ThumbDisasm::dis_mov_cmp_add_sub_imm(std::uint32_t pc, const std::uint16_t instr) const {
+template <typename Format>
+td::InstructionData td::BasicThumbDisasm<Format>::dis_mov_cmp_add_sub_imm(std::uint32_t pc, const std::uint16_t instr) const {
 	/*
 	|_15|_14|_13|_12|_11|_10|_9_|_8_|_7_|_6_|_5_|_4_|_3_|_2_|_1_|_0_|
 	|_0___0___1_|___Op__|_____Rd____|_____________Offset____________|
@@ -108,20 +150,21 @@ td::InstructionData td::ThumbDisasm::dis_mov_cmp_add_sub_imm(std::uint32_t pc, c
 	const std::uint8_t target = (instr >> 8) & 0x7;  // Bit 10-8
 	const std::uint8_t offset = instr & 0xFF;        // Bit 7-0
 
-	std::string mnemonic;
+	Mnemonic mnemonic;
 	switch (opcode) {
 		case(0): mnemonic += "MOV "; break;
 		case(1): mnemonic += "CMP "; break;
 		case(2): mnemonic += "ADD "; break;
 		case(3): mnemonic += "SUB "; break;
 	}
-	mnemonic += get_register_name(target) + ", ";
-	mnemonic += print_literal(offset);
+	mnemonic.append(get_register_name(target), ", ");
+	print_literal(mnemonic, offset);
 
-	return { pc, instr, mnemonic, true, 2, true, ModeEvent::None };
+	return { pc, instr, mnemonic, true, 2, true, ModeEvent::None, InstrFormat::ThumbMovCmpAddSubImm };
 }
 
-td::InstructionData td::ThumbDisasm::dis_alu_ops(std::uint32_t pc, const std::uint16_t instr) const {
+template <typename Format>
+td::InstructionData td::BasicThumbDisasm<Format>::dis_alu_ops(std::uint32_t pc, const std::uint16_t instr) const {
 	/*
 	|_15|_14|_13|_12|_11|_10|_9_|_8_|_7_|_6_|_5_|_4_|_3_|_2_|_1_|_0_|
 	|_0___1___0___0___0___0_|_______Op______|_____Rs____|____Rd_____|
@@ -130,7 +173,7 @@ td::InstructionData td::ThumbDisasm::dis_alu_ops(std::uint32_t pc, const std::ui
 	const std::uint8_t src_register = (instr >> 3) & 0x7; // Bit 5-3
 	const std::uint8_t dest_register = instr & 0x7;       // Bit 2-0
 
-	std::string mnemonic;
+	Mnemonic mnemonic;
 	switch (opcode) {
 		case (0): mnemonic += "AND "; break;
 		case (1): mnemonic += "EOR "; break;
@@ -149,13 +192,14 @@ td::InstructionData td::ThumbDisasm::dis_alu_ops(std::uint32_t pc, const std::ui
 		case (14): mnemonic += "BIC "; break;
 		case (15): mnemonic += "MVN "; break;
 	}
-	mnemonic += get_register_name(dest_register) + ", ";
+	mnemonic.append(get_register_name(dest_register), ", ");
 	mnemonic += get_register_name(src_register);
 
-	return { pc, instr, mnemonic, true, 2, true, ModeEvent::None };
+	return { pc, instr, mnemonic, true, 2, true, ModeEvent::None, InstrFormat::ThumbAluOps };
 }
 
-td::InstructionData td::ThumbDisasm::dis_hi_reg_ops_bx(std::uint32_t pc, const std::uint16_t instr) const {
+template <typename Format>
+td::InstructionData td::BasicThumbDisasm<Format>::dis_hi_reg_ops_bx(std::uint32_t pc, const std::uint16_t instr) const {
 	/*
 	|_15|_14|_13|_12|_11|_10|_9_|_8_|_7_|_6_|_5_|_4_|_3_|_2_|_1_|_0_|
 	|_0___1___0___0___0___1_|___Op__|_H1|_H2|___Rs/Hs___|___Rd/Hd___|
@@ -166,40 +210,41 @@ td::InstructionData td::ThumbDisasm::dis_hi_reg_ops_bx(std::uint32_t pc, const s
 	const std::uint8_t src_register = (instr >> 3) & 0x7; // Bit 5-3
 	const std::uint8_t dest_register = instr & 0x7;       // Bit 2-0
 
-	std::string mnemonic;
+	Mnemonic mnemonic;
 	switch (opcode) {
 		case(0):
-			if (!high_op1 && !high_op2) return { pc, instr, "Invalid instruction.", true, 2 };
+			if (!high_op1 && !high_op2) return { pc, instr, "Invalid instruction.", true, 2, false, ModeEvent::None, InstrFormat::ThumbHiRegOpsBx };
 			mnemonic += "ADD ";
 			break;
 		case(1):
-			if (!high_op1 && !high_op2) return { pc, instr, "Invalid instruction.", true, 2 };
+			if (!high_op1 && !high_op2) return { pc, instr, "Invalid instruction.", true, 2, false, ModeEvent::None, InstrFormat::ThumbHiRegOpsBx };
 			mnemonic += "CMP ";
 			break;
 		case(2):
-			if (!high_op1 && !high_op2) return { pc, instr, "Invalid instruction.", true, 2 };
+			if (!high_op1 && !high_op2) return { pc, instr, "Invalid instruction.", true, 2, false, ModeEvent::None, InstrFormat::ThumbHiRegOpsBx };
 			mnemonic += "MOV ";
 			break;
 		case(3):
-			if (high_op1) return { pc, instr, "Invalid instruction.", true, 2 };
+			if (high_op1) return { pc, instr, "Invalid instruction.", true, 2, false, ModeEvent::None, InstrFormat::ThumbHiRegOpsBx };
 			mnemonic += "BX ";
 
 			if (high_op2) mnemonic += get_register_name(src_register + 8); // Registers 8-15
 			else mnemonic += get_register_name(src_register);              // Registers 0-7
 			
-			return { pc, instr, mnemonic, true, 2, true, ModeEvent::BX };
+			return { pc, instr, mnemonic, true, 2, true, ModeEvent::BX, InstrFormat::ThumbHiRegOpsBx };
 	}
 
-	if (high_op1) mnemonic += get_register_name(dest_register + 8) + ", "; // Registers 8-15
-	else mnemonic += get_register_name(dest_register) + ", ";              // Registers 0-7
+	if (high_op1) mnemonic.append(get_register_name(dest_register + 8), ", "); // Registers 8-15
+	else mnemonic.append(get_register_name(dest_register), ", ");              // Registers 0-7
 
 	if (high_op2) mnemonic += get_register_name(src_register + 8); // Registers 8-15
 	else mnemonic += get_register_name(src_register);              // Registers 0-7
 
-	return { pc, instr, mnemonic, true, 2 , true, ModeEvent::None };
+	return { pc, instr, mnemonic, true, 2 , true, ModeEvent::None, InstrFormat::ThumbHiRegOpsBx };
 }
 
-td::InstructionData td::ThumbDisasm::dis_pc_rel_load(std::uint32_t pc, const std::uint16_t instr) const {
+template <typename Format>
+td::InstructionData td::BasicThumbDisasm<Format>::dis_pc_rel_load(std::uint32_t pc, const std::uint16_t instr) const {
 	/*
 	|_15|_14|_13|_12|_11|_10|_9_|_8_|_7_|_6_|_5_|_4_|_3_|_2_|_1_|_0_|
 	|_0___1___0___0___1_|_____Rd____|______________Word_____________|
@@ -207,16 +252,17 @@ td::InstructionData td::ThumbDisasm::dis_pc_rel_load(std::uint32_t pc, const std
 	const std::uint8_t dest_register = (instr >> 8) & 0x7; // Bit 10-8
 	const std::uint8_t immediate = instr & 0xFF;           // Bit 7-0
 
-	std::string mnemonic = "LDR ";
+	Mnemonic mnemonic = "LDR ";
 	mnemonic += get_register_name(dest_register);
 	mnemonic += ", [PC, ";
-	mnemonic += print_literal((std::uint16_t)immediate << 2);
+	print_literal(mnemonic, (std::uint16_t)immediate << 2);
 	mnemonic += "]";
 
-	return { pc, instr, mnemonic, true, 2, true, ModeEvent::None };
+	return { pc, instr, mnemonic, true, 2, true, ModeEvent::None, InstrFormat::ThumbPcRelLoad };
 }
 
-td::InstructionData td::ThumbDisasm::dis_load_store_reg_off(std::uint32_t pc, const std::uint16_t instr) const {
+template <typename Format>
+td::InstructionData td::BasicThumbDisasm<Format>::dis_load_store_reg_off(std::uint32_t pc, const std::uint16_t instr) const {
 	/*
 	|_15|_14|_13|_12|_11|_10|_9_|_8_|_7_|_6_|_5_|_4_|_3_|_2_|_1_|_0_|
 	|_0___1___0___1_|_L_|_B_|_0_|_____Ro____|_____Rb____|_____Rd____|
@@ -227,16 +273,17 @@ td::InstructionData td::ThumbDisasm::dis_load_store_reg_off(std::uint32_t pc, co
 	const std::uint8_t base_register = (instr >> 3) & 0x7;   // Bit 5-3
 	const std::uint8_t dest_register = instr & 0x7;          // Bit 2-0
 
-	std::string mnemonic = (is_load ? "LDR" : "STR");
+	Mnemonic mnemonic = (is_load ? "LDR" : "STR");
 	mnemonic += (is_sign_extended ? "B " : " ");
-	mnemonic += get_register_name(dest_register) + " ";
-	mnemonic += "[" + get_register_name(base_register) + ", ";
-	mnemonic += get_register_name(offset_register) + "]";
+	mnemonic.append(get_register_name(dest_register), ", ");
+	mnemonic.append("[", get_register_name(base_register), ", ");
+	mnemonic.append(get_register_name(offset_register), "]");
 
-	return { pc, instr, mnemonic, true, 2, true, ModeEvent::None };
+	return { pc, instr, mnemonic, true, 2, true, ModeEvent::None, InstrFormat::ThumbLoadStoreRegOff };
 }
 
-td::InstructionData td::ThumbDisasm::dis_load_store_sign_ext(std::uint32_t pc, const std::uint16_t instr) const {
+template <typename Format>
+td::InstructionData td::BasicThumbDisasm<Format>::dis_load_store_sign_ext(std::uint32_t pc, const std::uint16_t instr) const {
 	/*
 	|_15|_14|_13|_12|_11|_10|_9_|_8_|_7_|_6_|_5_|_4_|_3_|_2_|_1_|_0_|
 	|_0___1___0___1_|_H_|_S_|_1_|_____Ro____|_____Rb____|_____Rd____|
@@ -246,21 +293,22 @@ td::InstructionData td::ThumbDisasm::dis_load_store_sign_ext(std::uint32_t pc, c
 	const std::uint8_t base_register = (instr >> 3) & 0x7;   // Bit 5-3
 	const std::uint8_t dest_register = instr & 0x7;          // Bit 2-0
 
-	std::string mnemonic;
+	Mnemonic mnemonic;
 	switch (hs) {
 		case 0b00: mnemonic += "STRH "; break;
-		case 0b01: mnemonic += "LDRH "; break;
-		case 0b10: mnemonic += "LDSB "; break;
+		case 0b01: mnemonic += "LDSB "; break;
+		case 0b10: mnemonic += "LDRH "; break;
 		case 0b11: mnemonic += "LDSH "; break;
 	}
-	mnemonic += get_register_name(dest_register) + " ";
-	mnemonic += "[" + get_register_name(base_register) + ", ";
-	mnemonic += get_register_name(offset_register) + "]";
+	mnemonic.append(get_register_name(dest_register), ", ");
+	mnemonic.append("[", get_register_name(base_register), ", ");
+	mnemonic.append(get_register_name(offset_register), "]");
 
-	return { pc, instr, mnemonic, true, 2, true, ModeEvent::None };
+	return { pc, instr, mnemonic, true, 2, true, ModeEvent::None, InstrFormat::ThumbLoadStoreSignExt };
 }
 
-td::InstructionData td::ThumbDisasm::dis_load_store_imm_off(std::uint32_t pc, const std::uint16_t instr) const {
+template <typename Format>
+td::InstructionData td::BasicThumbDisasm<Format>::dis_load_store_imm_off(std::uint32_t pc, const std::uint16_t instr) const {
 	/*
 	|_15|_14|_13|_12|_11|_10|_9_|_8_|_7_|_6_|_5_|_4_|_3_|_2_|_1_|_0_|
 	|_0___1___1_|_B_|_L_|_______Offset______|_____Rb____|_____Rd____|
@@ -271,18 +319,25 @@ td::InstructionData td::ThumbDisasm::dis_load_store_imm_off(std::uint32_t pc, co
 	const std::uint8_t base_register = (instr >> 3) & 0x7; // Bit 5-3
 	const std::uint8_t target_register = instr & 0x7;      // Bit 2-0
 
-	std::string mnemonic = (is_load ? "LDR" : "STR" );
+	Mnemonic mnemonic = (is_load ? "LDR" : "STR" );
 	mnemonic += (is_byte ? "B " : " ");
-	mnemonic += get_register_name(target_register) + " ";
-	mnemonic += "[" + get_register_name(base_register) + ", ";
+	mnemonic.append(get_register_name(target_register), ", ");
+	mnemonic.append("[", get_register_name(base_register), ", ");
 	
-	if (is_byte) mnemonic += print_literal(offset) + "]";
-	else mnemonic += print_literal(offset << 2) + "]";
+	if (is_byte) {
+		print_literal(mnemonic, offset);
+		mnemonic += "]";
+	}
+	else {
+		print_literal(mnemonic, offset << 2);
+		mnemonic += "]";
+	}
 
-	return { pc, instr, mnemonic, true, 2, true, ModeEvent::None };
+	return { pc, instr, mnemonic, true, 2, true, ModeEvent::None, InstrFormat::ThumbLoadStoreImmOff };
 }
 
-td::InstructionData td::ThumbDisasm::dis_load_store_halfword(std::uint32_t pc, const std::uint16_t instr) const {
+template <typename Format>
+td::InstructionData td::BasicThumbDisasm<Format>::dis_load_store_halfword(std::uint32_t pc, const std::uint16_t instr) const {
 	/*
 	|_15|_14|_13|_12|_11|_10|_9_|_8_|_7_|_6_|_5_|_4_|_3_|_2_|_1_|_0_|
 	|_1___0___0___0_|_L_|_______Offset______|_____Rb____|_____Rd____|
@@ -292,15 +347,17 @@ td::InstructionData td::ThumbDisasm::dis_load_store_halfword(std::uint32_t pc, c
 	const std::uint8_t base_register = (instr >> 3) & 0x7; // Bit 5-3
 	const std::uint8_t target_register = instr & 0x7;      // Bit 2-0
 	
-	std::string mnemonic = (is_load ? "LDRH " : "STRH ");
-	mnemonic += get_register_name(target_register) + " ";
-	mnemonic += "[" + get_register_name(base_register) + ", ";
-	mnemonic += print_literal(immediate << 1) + "]";
+	Mnemonic mnemonic = (is_load ? "LDRH " : "STRH ");
+	mnemonic.append(get_register_name(target_register), ", ");
+	mnemonic.append("[", get_register_name(base_register), ", ");
+	print_literal(mnemonic, immediate << 1);
+	mnemonic += "]";
 
-	return { pc, instr, mnemonic, true, 2, true, ModeEvent::None };
+	return { pc, instr, mnemonic, true, 2, true, ModeEvent::None, InstrFormat::ThumbLoadStoreHalfword };
 }
 
-td::InstructionData td::ThumbDisasm::dis_sp_rel_load_store(std::uint32_t pc, const std::uint16_t instr) const {
+template <typename Format>
+td::InstructionData td::BasicThumbDisasm<Format>::dis_sp_rel_load_store(std::uint32_t pc, const std::uint16_t instr) const {
 	/*
 	|_15|_14|_13|_12|_11|_10|_9_|_8_|_7_|_6_|_5_|_4_|_3_|_2_|_1_|_0_|
 	|_1___0___0___1_|_L_|_____Rd____|___________Immediate___________|
@@ -309,14 +366,17 @@ td::InstructionData td::ThumbDisasm::dis_sp_rel_load_store(std::uint32_t pc, con
 	const std::uint8_t dest_register = (instr >> 8) & 0x7; // Bit 10-8
 	const std::uint8_t immediate = instr & 0xFF;           // Bit 7-0
 
-	std::string mnemonic = (is_load ? "LDR " : "STR ");
-	mnemonic += get_register_name(dest_register) + " ";
-	mnemonic += "[SP, " + print_literal((std::uint16_t)immediate << 2) + "]";
+	Mnemonic mnemonic = (is_load ? "LDR " : "STR ");
+	mnemonic.append(get_register_name(dest_register), ", ");
+	mnemonic += "[SP, ";
+	print_literal(mnemonic, (std::uint16_t)immediate << 2);
+	mnemonic += "]";
 
-	return { pc, instr, mnemonic, true, 2, true, ModeEvent::None };
+	return { pc, instr, mnemonic, true, 2, true, ModeEvent::None, InstrFormat::ThumbSpRelLoadStore };
 }
 
-td::InstructionData td::ThumbDisasm::dis_load_address(std::uint32_t pc, const std::uint16_t instr) const {
+template <typename Format>
+td::InstructionData td::BasicThumbDisasm<Format>::dis_load_address(std::uint32_t pc, const std::uint16_t instr) const {
 	/*
 	|_15|_14|_13|_12|_11|_10|_9_|_8_|_7_|_6_|_5_|_4_|_3_|_2_|_1_|_0_|
 	|_1___0___1___0_|_SP|_____Rd____|___________Immediate___________|
@@ -325,19 +385,23 @@ td::InstructionData td::ThumbDisasm::dis_load_address(std::uint32_t pc, const st
 	const std::uint8_t dest_register = (instr >> 8) & 0x7; // Bit 10-8
 	const std::uint8_t immediate = instr & 0xFF;           // Bit 7-0
 
-	std::string mnemonic;
-	if (source) mnemonic = "ADD " + get_register_name(dest_register) + ", SP, ";
-	else mnemonic = "ADR " + get_register_name(dest_register) + ", ";
+	Mnemonic mnemonic;
+	if (source) mnemonic.append("ADD ", get_register_name(dest_register), ", SP, ");
+	else mnemonic.append("ADR ", get_register_name(dest_register), ", ");
 
 	std::uint32_t literal = static_cast<std::uint16_t>(immediate) << 2;
-	if (!source) literal += pc + 4;
+	if (!source) literal += (pc + 4) & ~2u; // PC reads word aligned
+
+	print_literal(mnemonic, literal);
 
-	mnemonic += print_literal(literal);
+	std::optional<std::uint32_t> target;
+	if (!source) target = literal;
 
-	return { pc, instr, mnemonic, true, 2, true, ModeEvent::None };
+	return { pc, instr, mnemonic, true, 2, true, ModeEvent::None, InstrFormat::ThumbLoadAddress, target };
 }
 
-td::InstructionData td::ThumbDisasm::dis_add_off_to_sp(std::uint32_t pc, const std::uint16_t instr) const {
+template <typename Format>
+td::InstructionData td::BasicThumbDisasm<Format>::dis_add_off_to_sp(std::uint32_t pc, const std::uint16_t instr) const {
 	/*
 	|_15|_14|_13|_12|_11|_10|_9_|_8_|_7_|_6_|_5_|_4_|_3_|_2_|_1_|_0_|
 	|_1___0___1___1___0___0___0___0_|_S_|_________Immediate_________|
@@ -345,14 +409,15 @@ td::InstructionData td::ThumbDisasm::dis_add_off_to_sp(std::uint32_t pc, const s
 	const bool sign = (instr >> 7) & 0x1;        // Bit 7
 	const std::uint8_t immediate = instr & 0x7F; // Bit 6-0
 
-	std::string mnemonic = "ADD SP, ";
+	Mnemonic mnemonic = "ADD SP, ";
 	mnemonic += (sign ? "#-" : "#");
-	mnemonic += print_literal((std::uint16_t)immediate << 2, false);
+	print_literal(mnemonic, (std::uint16_t)immediate << 2, false);
 
-	return { pc, instr, mnemonic, true, 2, true, ModeEvent::None };
+	return { pc, instr, mnemonic, true, 2, true, ModeEvent::None, InstrFormat::ThumbAddOffToSp };
 }
 
-td::InstructionData td::ThumbDisasm::dis_push_pop_reg(std::uint32_t pc, const std::uint16_t instr) const {
+template <typename Format>
+td::InstructionData td::BasicThumbDisasm<Format>::dis_push_pop_reg(std::uint32_t pc, const std::uint16_t instr) const {
 	/*
 	|_15|_14|_13|_12|_11|_10|_9_|_8_|_7_|_6_|_5_|_4_|_3_|_2_|_1_|_0_|
 	|_1___0___1___1_|_L_|_1___0_|_R_|_________Register List_________|
@@ -361,18 +426,20 @@ td::InstructionData td::ThumbDisasm::dis_push_pop_reg(std::uint32_t pc, const st
 	const bool store_lr = (instr >> 8) & 0x1;        // Bit 8
 	const std::uint8_t register_list = instr & 0xFF; // Bit 7-0
 
-	std::string mnemonic = (is_load ? "PUSH {" : "POP {");
-	mnemonic += print_register_list(register_list, 8);
+	Mnemonic mnemonic = (is_load ? "POP {" : "PUSH {");
+	print_register_list(mnemonic, register_list, 8);
 
 	if (store_lr) {
-		mnemonic += (is_load ? ", PC" : ", LR");
+		if (register_list) mnemonic += ", ";
+		mnemonic += (is_load ? "PC" : "LR");
 	}
 	mnemonic += "}";
 
-	return { pc, instr, mnemonic, true, 2, true, ModeEvent::None };
+	return { pc, instr, mnemonic, true, 2, true, ModeEvent::None, InstrFormat::ThumbPushPopReg };
 }
 
-td::InstructionData td::ThumbDisasm::dis_multi_load_store(std::uint32_t pc, const std::uint16_t instr) const {
+template <typename Format>
+td::InstructionData td::BasicThumbDisasm<Format>::dis_multi_load_store(std::uint32_t pc, const std::uint16_t instr) const {
 	/*
 	|_15|_14|_13|_12|_11|_10|_9_|_8_|_7_|_6_|_5_|_4_|_3_|_2_|_1_|_0_|
 	|_1___0___1___1_|_L_|_1___0_|_R_|_________Register List_________|
@@ -381,14 +448,16 @@ td::InstructionData td::ThumbDisasm::dis_multi_load_store(std::uint32_t pc, cons
 	const std::uint8_t base_register = (instr >> 8) & 0x7; // Bit 10-8
 	const std::uint8_t register_list = instr & 0xFF;       // Bit 7-0
 
-	std::string mnemonic = (is_load ? "LDMIA " : "STMIA ");
-	mnemonic += get_register_name(base_register) + "!, {";
-	mnemonic += print_register_list(register_list, 8) + "}";
+	Mnemonic mnemonic = (is_load ? "LDMIA " : "STMIA ");
+	mnemonic.append(get_register_name(base_register), "!, {");
+	print_register_list(mnemonic, register_list, 8);
+	mnemonic += "}";
 
-	return { pc, instr, mnemonic, true, 2, true, ModeEvent::None };
+	return { pc, instr, mnemonic, true, 2, true, ModeEvent::None, InstrFormat::ThumbMultiLoadStore };
 }
 
-td::InstructionData td::ThumbDisasm::dis_cond_branch(std::uint32_t pc, const std::uint16_t instr) const {
+template <typename Format>
+td::InstructionData td::BasicThumbDisasm<Format>::dis_cond_branch(std::uint32_t pc, const std::uint16_t instr) const {
 	/*
 	|_15|_14|_13|_12|_11|_10|_9_|_8_|_7_|_6_|_5_|_4_|_3_|_2_|_1_|_0_|
 	|_1___1___0___1_|______Cond_____|_____________Offset____________|
@@ -396,48 +465,53 @@ td::InstructionData td::ThumbDisasm::dis_cond_branch(std::uint32_t pc, const std
 	const std::uint8_t cond = (instr >> 8) & 0xF; // Bit 10-8
 	const std::uint8_t offset = instr & 0xFF;     // Bit 7-0
 
-	if (cond == 0xE) return { pc, instr, "Invalid instruction.", true, 2, false, ModeEvent::None };
+	if (cond == 0xE) return { pc, instr, "Invalid instruction.", true, 2, false, ModeEvent::None, InstrFormat::ThumbCondBranch };
 
-	std::string mnemonic = "B";
-	mnemonic += get_cond_suffix(cond) + " ";
+	Mnemonic mnemonic = "B";
+	mnemonic.append(get_cond_suffix(cond), " ");
 
 	std::int8_t signed_offset = static_cast<std::int8_t>(offset);
-	std::int8_t address = static_cast<std::int8_t>(signed_offset) << 1;
-	mnemonic += print_literal(address + pc + 4);
+	std::int32_t address = static_cast<std::int32_t>(signed_offset) << 1;
+	const std::uint32_t target = address + pc + 4;
+	print_literal(mnemonic, target);
 
-	return { pc, instr, mnemonic, true, 2, true, ModeEvent::None };
+	return { pc, instr, mnemonic, true, 2, true, ModeEvent::None, InstrFormat::ThumbCondBranch, target };
 }
 
-td::InstructionData td::ThumbDisasm::dis_swi(std::uint32_t pc, const std::uint16_t instr) const {
+template <typename Format>
+td::InstructionData td::BasicThumbDisasm<Format>::dis_swi(std::uint32_t pc, const std::uint16_t instr) const {
 	/*
 	|_15|_14|_13|_12|_11|_10|_9_|_8_|_7_|_6_|_5_|_4_|_3_|_2_|_1_|_0_|
 	|_1___1___0___1___1___1___1___1_|____________Comment____________|
 	*/
 	const std::uint8_t comment = instr & 0xFF;     // Bit 7-0
 
-	std::string mnemonic = "SWI ";
-	mnemonic += print_literal(comment);
+	Mnemonic mnemonic = "SWI ";
+	print_literal(mnemonic, comment);
 
-	return { pc, instr, mnemonic, true, 2, true, ModeEvent::None };
+	return { pc, instr, mnemonic, true, 2, true, ModeEvent::None, InstrFormat::ThumbSwi };
 }
 
-td::InstructionData td::ThumbDisasm::dis_uncond_branch(std::uint32_t pc, const std::uint16_t instr) const {
+template <typename Format>
+td::InstructionData td::BasicThumbDisasm<Format>::dis_uncond_branch(std::uint32_t pc, const std::uint16_t instr) const {
 	/*
 	|_15|_14|_13|_12|_11|_10|_9_|_8_|_7_|_6_|_5_|_4_|_3_|_2_|_1_|_0_|
 	|_1___1___1___0___0_|___________________Offset__________________|
 	*/
 	const std::uint16_t offset = instr & 0x7FF; // Bit 10-0
 
-	std::string mnemonic = "B ";
+	Mnemonic mnemonic = "B ";
 
 	std::int16_t signed_offset = static_cast<std::int16_t>(offset << 5);
 	std::int32_t address = static_cast<std::int32_t>(signed_offset) >> 4;
-	mnemonic += print_literal(address + pc + 4);
+	const std::uint32_t target = address + pc + 4;
+	print_literal(mnemonic, target);
 
-	return { pc, instr, mnemonic, true, 2, true, ModeEvent::None };
+	return { pc, instr, mnemonic, true, 2, true, ModeEvent::None, InstrFormat::ThumbUncondBranch, target };
 }
 
-td::InstructionData td::ThumbDisasm::dis_long_branch_link(std::uint32_t pc, const std::uint32_t instr) const {
+template <typename Format>
+td::InstructionData td::BasicThumbDisasm<Format>::dis_long_branch_link(std::uint32_t pc, const std::uint32_t instr) const {
 	/*
 	|..3 ..................2 ..................1 ..................0|
 	|1_0_9_8_7_6_5_4_3_2_1_0_9_8_7_6_5_4_3_2_1_0_9_8_7_6_5_4_3_2_1_0|
@@ -449,13 +523,231 @@ td::InstructionData td::ThumbDisasm::dis_long_branch_link(std::uint32_t pc, cons
 	const std::uint16_t high_offset = instr & 0x7FF;    // Bit 10-0
 
 	const uint8_t next_instr_sig = ((next_instr >> 11) & 0x1F); // Bit 15-11 in next instruction.
-	if (is_high_offset || next_instr_sig != 0x1F) return { pc, instr, "Invalid instruction.", true, 2, false, ModeEvent::None };
+	if (is_high_offset || next_instr_sig != 0x1F) return { pc, instr, "Invalid instruction.", true, 2, false, ModeEvent::None, InstrFormat::ThumbLongBranchLink };
 
 	const uint16_t low_offset = next_instr & 0x7FF; // Bit 10-0 in next instruction.
 	std::int32_t address = static_cast<std::int32_t>((high_offset << 12) | (low_offset << 1));
 	if (high_offset & 0x0400) address |= 0xFF800000; // Sign extend the address
 
-	std::string mnemonic = "BL " + print_literal(address + pc + 4);
+	const std::uint32_t target = address + pc + 4;
+	Mnemonic mnemonic = "BL ";
+	print_literal(mnemonic, target);
 
-	return { pc, instr, mnemonic, true, 4, true, ModeEvent::None };
+	return { pc, instr, mnemonic, true, 4, true, ModeEvent::None, InstrFormat::ThumbLongBranchLink, target };
 }
+
+/* --- Structured Decoding --- */
+
+void td::ThumbFieldDecoder::extract_fields(const std::uint16_t instr, DecodedFields& fields) {
+	// Fixed-position register fields; complete_fields moves or clears them per format.
+	// rs temporarily holds Bit 10-8, the register slot of the 8-bit immediate formats.
+	fields.format = classify(instr);
+	fields.cond = 0xE;               // AL, only conditional branches carry a condition
+	fields.rd = instr & 0x7;         // Bit 2-0
+	fields.rn = (instr >> 3) & 0x7;  // Bit 5-3
+	fields.rm = (instr >> 6) & 0x7;  // Bit 8-6
+	fields.rs = (instr >> 8) & 0x7;  // Bit 10-8
+}
+
+void td::ThumbFieldDecoder::complete_fields(std::uint32_t pc, const std::uint32_t instr, DecodedFields& fields) {
+	constexpr std::uint8_t NONE = 0xFF;
+	constexpr std::uint8_t SP = 13, PC = 15;
+
+	const std::uint8_t high_register = fields.rs;
+	const bool bit11 = (instr >> 11) & 0x1;
+	const std::uint16_t transfer = DecodeFlag::Valid | DecodeFlag::PreIndex | DecodeFlag::AddOffset
+		| (bit11 ? DecodeFlag::Load : 0);
+
+	fields.opcode = 0;
+	fields.flags = DecodeFlag::Valid;
+	fields.imm = 0;
+	fields.rs = NONE;
+
+	switch (fields.format) {
+		case InstrFormat::ThumbMoveShiftedReg:
+			fields.opcode = (instr >> 11) & 0x3;
+			fields.imm = (instr >> 6) & 0x1F;
+			fields.rm = NONE;
+			fields.flags |= DecodeFlag::Immediate | DecodeFlag::SetFlags;
+			break;
+		case InstrFormat::ThumbAddSub:
+			fields.opcode = (instr >> 9) & 0x1;
+			fields.flags |= DecodeFlag::SetFlags;
+			if ((instr >> 10) & 0x1) {
+				fields.imm = fields.rm;
+				fields.rm = NONE;
+				fields.flags |= DecodeFlag::Immediate;
+			}
+			break;
+		case InstrFormat::ThumbMovCmpAddSubImm:
+			fields.opcode = (instr >> 11) & 0x3;
+			fields.rd = high_register;
+			fields.rn = fields.rm = NONE;
+			fields.imm = instr & 0xFF;
+			fields.flags |= DecodeFlag::Immediate | DecodeFlag::SetFlags;
+			break;
+		case InstrFormat::ThumbAluOps:
+			fields.opcode = (instr >> 6) & 0xF;
+			fields.rm = fields.rn; // Rs
+			fields.rn = NONE;
+			fields.flags |= DecodeFlag::SetFlags;
+			break;
+		case InstrFormat::ThumbHiRegOpsBx: {
+			const bool high_op1 = (instr >> 7) & 0x1;
+			const bool high_op2 = (instr >> 6) & 0x1;
+			fields.opcode = (instr >> 8) & 0x3;
+			fields.rm = fields.rn | (high_op2 << 3);
+			fields.rd = fields.rd | (high_op1 << 3);
+			fields.rn = NONE;
+			if (fields.opcode == 3) {
+				fields.rd = NONE;
+				if (high_op1) fields.flags = 0;
+				else fields.flags |= DecodeFlag::BranchExchange;
+			}
+			else if (!high_op1 && !high_op2) fields.flags = 0;
+			break;
+		}
+		case InstrFormat::ThumbPcRelLoad:
+			fields.flags = transfer | DecodeFlag::Load | DecodeFlag::Immediate;
+			fields.rd = high_register;
+			fields.rn = PC;
+			fields.rm = NONE;
+			fields.imm = (instr & 0xFF) << 2;
+			break;
+		case InstrFormat::ThumbLoadStoreRegOff:
+			fields.flags = transfer;
+			if ((instr >> 10) & 0x1) fields.flags |= DecodeFlag::Byte;
+			break;
+		case InstrFormat::ThumbLoadStoreSignExt:
+			fields.opcode = (instr >> 10) & 0x3; // HS
+			fields.flags = transfer & ~DecodeFlag::Load;
+			if (fields.opcode != 0) fields.flags |= DecodeFlag::Load;
+			break;
+		case InstrFormat::ThumbLoadStoreImmOff: {
+			const bool is_byte = (instr >> 12) & 0x1;
+			fields.flags = transfer | DecodeFlag::Immediate;
+			if (is_byte) fields.flags |= DecodeFlag::Byte;
+			fields.imm = ((instr >> 6) & 0x1F) << (is_byte ? 0 : 2);
+			fields.rm = NONE;
+			break;
+		}
+		case InstrFormat::ThumbLoadStoreHalfword:
+			fields.flags = transfer | DecodeFlag::Immediate;
+			fields.imm = ((instr >> 6) & 0x1F) << 1;
+			fields.rm = NONE;
+			break;
+		case InstrFormat::ThumbSpRelLoadStore:
+			fields.flags = transfer | DecodeFlag::Immediate;
+			fields.rd = high_register;
+			fields.rn = SP;
+			fields.rm = NONE;
+			fields.imm = (instr & 0xFF) << 2;
+			break;
+		case InstrFormat::ThumbLoadAddress:
+			fields.flags |= DecodeFlag::Immediate;
+			fields.rd = high_register;
+			fields.rn = bit11 ? SP : PC;
+			fields.rm = NONE;
+			fields.imm = (instr & 0xFF) << 2;
+			break;
+		case InstrFormat::ThumbAddOffToSp:
+			fields.opcode = (instr >> 7) & 0x1; // 1 = subtract
+			fields.flags |= DecodeFlag::Immediate;
+			fields.rd = fields.rn = SP;
+			fields.rm = NONE;
+			fields.imm = (instr & 0x7F) << 2;
+			break;
+		case InstrFormat::ThumbPushPopReg:
+			// POP is the load form and may include PC; PUSH may include LR
+			fields.flags = (transfer & ~(DecodeFlag::PreIndex | DecodeFlag::AddOffset)) | DecodeFlag::WriteBack;
+			if (!bit11) fields.flags |= DecodeFlag::PreIndex;
+			else fields.flags |= DecodeFlag::AddOffset;
+			fields.rd = fields.rm = NONE;
+			fields.rn = SP;
+			fields.imm = instr & 0xFF;
+			if ((instr >> 8) & 0x1) fields.imm |= bit11 ? 0x8000 : 0x4000;
+			break;
+		case InstrFormat::ThumbMultiLoadStore:
+			fields.flags = (transfer & ~DecodeFlag::PreIndex) | DecodeFlag::WriteBack;
+			fields.rd = fields.rm = NONE;
+			fields.rn = high_register;
+			fields.imm = instr & 0xFF;
+			break;
+		case InstrFormat::ThumbCondBranch: {
+			fields.cond = (instr >> 8) & 0xF;
+			fields.rd = fields.rn = fields.rm = NONE;
+			if (fields.cond == 0xE) { fields.flags = 0; break; }
+			const std::int32_t offset = static_cast<std::int32_t>(static_cast<std::int8_t>(instr & 0xFF)) << 1;
+			fields.imm = offset + pc + 4;
+			fields.flags |= DecodeFlag::HasTarget;
+			break;
+		}
+		case InstrFormat::ThumbSwi:
+			fields.rd = fields.rn = fields.rm = NONE;
+			fields.imm = instr & 0xFF;
+			break;
+		case InstrFormat::ThumbUncondBranch: {
+			const std::int32_t offset = static_cast<std::int32_t>(static_cast<std::int16_t>((instr & 0x7FF) << 5)) >> 4;
+			fields.rd = fields.rn = fields.rm = NONE;
+			fields.imm = offset + pc + 4;
+			fields.flags |= DecodeFlag::HasTarget;
+			break;
+		}
+		case InstrFormat::ThumbLongBranchLink: {
+			fields.rd = fields.rn = fields.rm = NONE;
+			const std::uint16_t next_instr = (instr >> 16) & 0xFFFF;
+			if (bit11 || ((next_instr >> 11) & 0x1F) != 0x1F) { fields.flags = 0; break; }
+
+			const std::uint16_t high_offset = instr & 0x7FF;
+			std::int32_t offset = static_cast<std::int32_t>((high_offset << 12) | ((next_instr & 0x7FF) << 1));
+			if (high_offset & 0x0400) offset |= 0xFF800000;
+			fields.imm = offset + pc + 4;
+			fields.flags |= DecodeFlag::HasTarget | DecodeFlag::Link | DecodeFlag::Wide;
+			break;
+		}
+		default:
+			fields.rd = fields.rn = fields.rm = NONE;
+			fields.flags = 0;
+			break;
+	}
+}
+
+td::DecodedFields td::ThumbFieldDecoder::decode_fields(std::uint32_t pc, const std::uint32_t instr) {
+	DecodedFields fields;
+	extract_fields(static_cast<std::uint16_t>(instr), fields);
+	complete_fields(pc, instr, fields);
+	return fields;
+}
+
+void td::ThumbFieldDecoder::decode_batch(std::span<const std::uint16_t> instrs, std::uint32_t base_pc, const DecodedBatch& out) {
+	const std::size_t count = instrs.size();
+
+	// Pass 1: straight-line shifts and masks over contiguous halfwords, which the compiler vectorises.
+	for (std::size_t i = 0; i < count; ++i) {
+		const std::uint16_t instr = instrs[i];
+		out.cond[i] = 0xE;
+		out.rd[i] = instr & 0x7;
+		out.rn[i] = (instr >> 3) & 0x7;
+		out.rm[i] = (instr >> 6) & 0x7;
+		out.rs[i] = (instr >> 8) & 0x7;
+	}
+	for (std::size_t i = 0; i < count; ++i) out.format[i] = classify(instrs[i]);
+
+	// Pass 2: per-format operand semantics. A BL prefix pairs with the following halfword, which
+	// is still decoded in its own row so callers can enter the stream at any halfword.
+	for (std::size_t i = 0; i < count; ++i) {
+		const std::uint32_t next = (i + 1 < count) ? instrs[i + 1] : 0;
+		DecodedFields fields{};
+		fields.format = out.format[i];
+		fields.cond = out.cond[i];
+		fields.rd = out.rd[i];
+		fields.rn = out.rn[i];
+		fields.rs = out.rs[i];
+		fields.rm = out.rm[i];
+		complete_fields(base_pc + static_cast<std::uint32_t>(i * 2), instrs[i] | (next << 16), fields);
+		out.store(i, fields);
+	}
+}
+
+template class td::BasicThumbDisasm<td::HexFormat>;
+template class td::BasicThumbDisasm<td::DecimalFormat>;
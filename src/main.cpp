@@ -1,5 +1,4 @@
 ﻿#include <iostream>
-#include <format>
 #include <string>
 #include <filesystem>
 #include <vector>
@@ -7,21 +6,59 @@
 #include <unordered_map>
 #include <optional>
 #include <fstream>
+#include <algorithm>
+#include <string_view>
+#include <bit>
+#include <csignal>
+#include <cstdio>
+#include <stdexcept>
+#include <thread>
 
 #include <totr/disassembler/Common.hpp>
 #include <totr/disassembler/ArmDisasm.hpp>
+#include <totr/disassembler/AsmWriter.hpp>
+#include <totr/disassembler/DataRenderer.hpp>
+#include <totr/disassembler/DisassemblyServer.hpp>
+#include <totr/disassembler/ExecutionTrace.hpp>
 #include <totr/disassembler/ThumbDisasm.hpp>
 #include <totr/disassembler/FileUtil.hpp>
 #include <totr/disassembler/InstructionProbe.hpp>
+#include <totr/disassembler/MemoryReader.hpp>
+#include <totr/disassembler/ModeSweep.hpp>
+#include <totr/disassembler/RomDiff.hpp>
+#include <totr/disassembler/SignatureMatcher.hpp>
+#include <totr/disassembler/Stats.hpp>
+#include <totr/disassembler/SymbolTable.hpp>
 
 namespace td = totr::Disassembler;
 
-void print_instruction(std::ostream& out, td::InstructionData data, td::ArmMode mode, bool ambiguous, bool mode_switched, bool did_mode_override) {
-    out << std::format("#0x{:08X}", data.pc) << " : ";
+void print_target_symbol(std::ostream& out, const td::SymbolTable& symbols, std::uint32_t target) {
+    // THUMB entry points are often materialised with the low bit set, e.g. ADR R3, func+1
+    auto match = symbols.find_containing(target);
+    if ((!match || match->offset != 0) && (target & 1)) {
+        if (auto even = symbols.find(target & ~1u)) match = td::SymbolMatch{ *even, 0 };
+    }
+    if (!match) return;
+
+    out << " <" << match->name;
+    if (match->offset != 0) {
+        char offset[12];
+        out << '+' << std::string_view(offset, td::format_literal(offset, match->offset, true, false));
+    }
+    out << ">";
+}
+
+void print_instruction(std::ostream& out, td::InstructionData data, td::ArmMode mode, bool ambiguous, bool mode_switched, bool did_mode_override, const td::SymbolTable& symbols) {
+    // "#0x%08X : #0x%08X : " assembled in place
+    char columns[28] = { '#' };
+    td::format_hex_fixed(columns + 1, data.pc, 8);
+    std::copy_n(" : #", 4, columns + 11);
+    td::format_hex_fixed(columns + 15, data.instruction, 8);
+    std::copy_n(" : ", 3, columns + 25);
+    out.write(columns, sizeof(columns));
 
-    out << std::format("#0x{:08X}", data.instruction);
-    
-    out << " : " << data.mnemonic;
+    out << data.mnemonic;
+    if (data.target_address && !symbols.empty()) print_target_symbol(out, symbols, *data.target_address);
     if (ambiguous) {
         if (mode == td::ArmMode::ARM) out << " ; May switch to THUMB.";
         else out << " ; May switch to ARM.";
@@ -38,17 +75,337 @@ void print_instruction(std::ostream& out, td::InstructionData data, td::ArmMode
     out << "\n";
 }
 
+struct ListingContext {
+    std::ostream& out;
+    const td::ArmDisasm& arm;
+    const td::ThumbDisasm& thumb;
+    const std::unordered_map<std::uint32_t, td::ArmMode>& overrides;
+    const std::vector<td::DataRegion>& data_regions;
+    const td::SymbolTable& symbols;
+    std::uint32_t base_address;
+    bool track_registers;
+    bool gnu_as;
+    const td::ExecutionTrace* trace; // Marks executed instructions when set
+    const std::filesystem::path* shard_base; // Listing goes to numbered shards next to it; `out` gets the index
+    unsigned shards;
+};
+
+void print_listing_header(std::ostream& out, bool coverage) {
+    const char* indent = coverage ? "  " : "";
+    out << indent << "    Addr    :    Instr    : Mnemonic\n";
+    out << indent << "--------------------------------------\n";
+}
+
+// labels are visited in address order, so a cursor replaces a per-line search
+void print_label(std::ostream& out, const td::SymbolTable& symbols, std::size_t& next_symbol, std::uint32_t address) {
+    while (next_symbol < symbols.size() && symbols.address(next_symbol) < address) ++next_symbol;
+    if (next_symbol < symbols.size() && symbols.address(next_symbol) == address) {
+        out << "\n" << symbols.name(next_symbol) << ":\n";
+    }
+}
+
+// Renders the data between image offsets `first` and `last` as directive rows with an empty
+// instruction column.
+template <std::endian Order>
+void print_data(std::ostream& out, const td::MemoryReader<Order>& memory, const ListingContext& context,
+    std::size_t& next_symbol, std::uint32_t first, std::uint32_t last) {
+    std::string line;
+    char hex[12];
+    for (const td::DataRow& row : td::split_data(memory, first, last)) {
+        print_label(out, context.symbols, next_symbol, context.base_address + row.offset);
+
+        line.assign(context.trace ? "  #" : "#");
+        line.append(hex, td::format_hex_fixed(hex, context.base_address + row.offset, 8));
+        line += " :             : ";
+        td::append_data_row(line, memory, row);
+        if (row.kind == td::DataKind::Pointers) line += " ; ROM pointers";
+        line += '\n';
+        out.write(line.data(), static_cast<std::streamsize>(line.size()));
+    }
+}
+
+// Renders sweep entries [first, last) as listing lines, with the data regions the sweep skipped
+// after each of them (and before the first one, for the start of the image); returns how many
+// instructions the trace executed. Touches no shared state, so shards render concurrently.
+// Instantiated per literal format, so the decoders in the loop test no output options.
+template <typename Format, std::endian Order>
+std::size_t print_listing(std::ostream& out, const td::MemoryReader<Order>& memory, const td::ModeSweep<Order>& sweep,
+    const ListingContext& context, std::size_t first, std::size_t last) {
+    const std::vector<td::SweepEntry>& entries = sweep.entries();
+    const std::uint32_t image_end = static_cast<std::uint32_t>(memory.size());
+    const td::BasicArmDisasm<Format> arm;
+    const td::BasicThumbDisasm<Format> thumb;
+    td::InstructionData data;
+    std::size_t next_symbol = context.symbols.lower_bound(context.base_address + (first < entries.size() && first > 0 ? entries[first].offset : 0));
+    std::size_t executed = 0;
+
+    if (first == 0) print_data(out, memory, context, next_symbol, 0, entries.empty() ? image_end : entries[0].offset);
+
+    for (std::size_t i = first; i < last; ++i) {
+        const td::SweepEntry& entry = entries[i];
+        const std::uint32_t address = context.base_address + entry.offset;
+
+        print_label(out, context.symbols, next_symbol, address);
+
+        if (entry.mode() == td::ArmMode::ARM) arm.decode(address, memory.fetch_arm(entry.offset), data);
+        else thumb.decode(address, memory.fetch_thumb(entry.offset), data);
+
+        if (data.mode_event == td::ModeEvent::BX) {
+            if (auto target = sweep.tracked_target(entry.offset)) data.target_address = target->address;
+        }
+
+        // Coverage column: `+` for instructions the trace executed in the mode they are listed in
+        if (context.trace) {
+            const bool hit = context.trace->executed(address, entry.mode());
+            executed += hit;
+            out << (hit ? "+ " : "  ");
+        }
+
+        print_instruction(out, data, entry.next_mode(), entry.flags & td::SweepFlag::Ambiguous,
+            entry.flags & td::SweepFlag::ModeSwitched, entry.flags & td::SweepFlag::Override, context.symbols);
+
+        const std::uint32_t end = entry.offset + entry.size;
+        const std::uint32_t next = (i + 1 < entries.size()) ? entries[i + 1].offset : image_end;
+        if (next > end) print_data(out, memory, context, next_symbol, end, next);
+    }
+    return executed;
+}
+
+// Splits the listing into `context.shards` files of about the same number of instructions, named
+// after the index file `context.out` refers to, and renders each on its own thread. Shards start
+// on sweep entries, so a THUMB BL pair is never split; each shard has its own header and opens
+// with the label of its first instruction, if any, so it reads on its own.
+template <typename Format, std::endian Order>
+std::size_t write_shards(const td::MemoryReader<Order>& memory, const td::ModeSweep<Order>& sweep, const ListingContext& context) {
+    constexpr std::size_t WRITE_BUFFER_SIZE = 4 << 20;
+
+    const std::vector<td::SweepEntry>& entries = sweep.entries();
+    const std::size_t shards = std::max<std::size_t>(1, std::min<std::size_t>(context.shards, entries.size()));
+    std::vector<std::size_t> executed(shards, 0);
+    std::vector<std::string> errors(shards);
+
+    const auto shard_path = [&](std::size_t shard) {
+        char suffix[24]; // Room for any size_t, though --shards caps the count at 1000
+        std::snprintf(suffix, sizeof(suffix), ".%03zu", shard);
+        return context.shard_base->string() + suffix;
+    };
+    const auto write_shard = [&](std::size_t shard) {
+        // A large stream buffer turns the many small line writes into few big ones
+        std::vector<char> buffer(WRITE_BUFFER_SIZE);
+        std::ofstream file;
+        file.rdbuf()->pubsetbuf(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        file.open(shard_path(shard), std::ios::out | std::ios::trunc | std::ios::binary);
+        if (!file) { errors[shard] = "Cannot write to " + shard_path(shard); return; }
+
+        print_listing_header(file, context.trace != nullptr);
+        executed[shard] = print_listing<Format>(file, memory, sweep, context, shard * entries.size() / shards, (shard + 1) * entries.size() / shards);
+        file.flush();
+        if (!file) errors[shard] = "Failed while writing " + shard_path(shard);
+    };
+
+    std::vector<std::thread> writers;
+    for (std::size_t shard = 1; shard < shards; ++shard) writers.emplace_back(write_shard, shard);
+    write_shard(0);
+    for (std::thread& writer : writers) writer.join();
+
+    for (const std::string& error : errors) {
+        if (!error.empty()) throw std::runtime_error(error);
+    }
+
+    // Index: one line per shard with the bus address range it covers
+    char hex[12];
+    context.out << "# shard : first address : end address : instructions\n";
+    for (std::size_t shard = 0; shard < shards; ++shard) {
+        const std::size_t first = shard * entries.size() / shards;
+        const std::size_t last = (shard + 1) * entries.size() / shards;
+        const std::uint32_t end = (last < entries.size()) ? entries[last].offset : static_cast<std::uint32_t>(memory.size());
+        context.out << std::filesystem::path(shard_path(shard)).filename().string();
+        const std::uint32_t start = (shard == 0) ? 0 : entries[first].offset; // Shard 0 also has any leading data
+        context.out << " : " << std::string_view(hex, td::format_hex_fixed(hex, context.base_address + start, 8));
+        context.out << " : " << std::string_view(hex, td::format_hex_fixed(hex, context.base_address + end, 8));
+        context.out << " : " << (last - first) << "\n";
+    }
+
+    std::size_t total = 0;
+    for (std::size_t count : executed) total += count;
+    return total;
+}
+
+// Linear sweep over the whole image, instantiated once per byte order. ModeSweep decides the mode
+// of every instruction; this only renders the result.
+template <std::endian Order>
+void disassemble(const td::MemoryReader<Order>& memory, const ListingContext& context) {
+    td::ModeSweep<Order> sweep{ memory, context.symbols, context.base_address, context.overrides, context.track_registers, context.data_regions };
+    sweep.run();
+
+    TOTR_STATS_SCOPE(Print);
+    if (context.gnu_as) {
+        td::write_gnu_as(context.out, sweep, memory, context.arm, context.thumb, context.symbols, context.base_address);
+        return;
+    }
+
+    std::size_t executed;
+    if (context.shard_base) {
+        executed = context.arm.print_literals_hex() ? write_shards<td::HexFormat>(memory, sweep, context)
+            : write_shards<td::DecimalFormat>(memory, sweep, context);
+    }
+    else {
+        print_listing_header(context.out, context.trace != nullptr);
+        executed = context.arm.print_literals_hex() ? print_listing<td::HexFormat>(context.out, memory, sweep, context, 0, sweep.entries().size())
+            : print_listing<td::DecimalFormat>(context.out, memory, sweep, context, 0, sweep.entries().size());
+    }
+
+    if (context.trace) {
+        std::cerr << "Coverage: " << executed << " of " << sweep.entries().size() << " instructions executed\n";
+    }
+}
+
+// Side-by-side listing of the windows where two images differ. Nothing outside the windows is
+// decoded; each side keeps its own cursor so a BL pair on one side does not shift the other.
+template <std::endian Order>
+void print_diff(const td::MemoryReader<Order>& old_memory, const td::MemoryReader<Order>& new_memory, const ListingContext& context) {
+    constexpr std::size_t COLUMN = 40; // Mnemonic width of the old side
+
+    const std::vector<td::ByteRange> changes = td::find_changes(old_memory.bytes(), new_memory.bytes());
+    const std::vector<td::DiffWindow> windows = td::diff_windows(old_memory, new_memory, std::span<const td::ByteRange>{ changes });
+
+    // Decodes the side at `offset` and moves it on; false past the end of its image
+    const auto decode = [&](const td::MemoryReader<Order>& memory, std::uint32_t& offset, td::ArmMode& mode, td::InstructionData& data) {
+        if (offset >= memory.size()) return false;
+        const std::uint32_t address = context.base_address + offset;
+        if (mode == td::ArmMode::ARM) context.arm.decode(address, memory.fetch_arm(offset), data);
+        else context.thumb.decode(address, memory.fetch_thumb(offset), data);
+        offset += data.size;
+        if (auto it = context.overrides.find(context.base_address + offset); it != context.overrides.end()) mode = it->second;
+        return true;
+    };
+
+    char hex[12];
+    td::InstructionData old_data;
+    td::InstructionData new_data;
+
+    for (const td::DiffWindow& window : windows) {
+        TOTR_STATS_SCOPE(Print);
+        context.out << "\n@@ " << std::string_view(hex, td::format_hex_fixed(hex, context.base_address + window.start, 8));
+        context.out << "-" << std::string_view(hex, td::format_hex_fixed(hex, context.base_address + window.end, 8));
+        context.out << (window.mode == td::ArmMode::ARM ? " ARM" : " THUMB") << " @@\n";
+
+        std::uint32_t old_offset = window.start;
+        std::uint32_t new_offset = window.start;
+        td::ArmMode old_mode = window.mode;
+        td::ArmMode new_mode = window.mode;
+        std::size_t next_symbol = context.symbols.lower_bound(context.base_address + window.start);
+
+        while (old_offset < window.end || new_offset < window.end) {
+            const std::uint32_t offset = std::min(old_offset, new_offset);
+            const std::uint32_t address = context.base_address + offset;
+
+            while (next_symbol < context.symbols.size() && context.symbols.address(next_symbol) < address) ++next_symbol;
+            if (next_symbol < context.symbols.size() && context.symbols.address(next_symbol) == address) {
+                context.out << context.symbols.name(next_symbol) << ":\n";
+            }
+
+            const bool has_old = old_offset == offset && decode(old_memory, old_offset, old_mode, old_data);
+            const bool has_new = new_offset == offset && decode(new_memory, new_offset, new_mode, new_data);
+            if (!has_old && old_offset == offset) old_offset = window.end;
+            if (!has_new && new_offset == offset) new_offset = window.end;
+            if (!has_old && !has_new) continue;
+
+            const bool same = has_old && has_new && old_data.size == new_data.size && old_data.instruction == new_data.instruction;
+            context.out << (same ? "  #" : "* #") << std::string_view(hex, td::format_hex_fixed(hex, address, 8)) << " : ";
+
+            if (has_old) {
+                context.out << "#" << std::string_view(hex, td::format_hex_fixed(hex, old_data.instruction, 8)) << " : ";
+                const std::string_view mnemonic = old_data.mnemonic.view();
+                context.out << mnemonic << std::string(mnemonic.size() < COLUMN ? COLUMN - mnemonic.size() : 0, ' ');
+            }
+            else {
+                context.out << std::string(COLUMN + 14, ' ');
+            }
+            context.out << " | ";
+            if (has_new) {
+                context.out << "#" << std::string_view(hex, td::format_hex_fixed(hex, new_data.instruction, 8)) << " : " << new_data.mnemonic.view();
+            }
+            context.out << "\n";
+        }
+    }
+}
+
+// One line per signature hit: image, bus address of the first instruction, signature name.
+template <std::endian Order>
+void print_hits(std::ostream& out, const std::string& rom_name, const td::MemoryReader<Order>& memory, const td::SignatureMatcher& matcher, std::uint32_t base_address) {
+    char address[12];
+    for (const td::SignatureHit& hit : matcher.scan(memory)) {
+        out << rom_name << " : #" << std::string_view(address, td::format_hex_fixed(address, base_address + hit.offset, 8))
+            << " : " << matcher.signatures()[hit.signature].name << "\n";
+    }
+}
+
+#ifdef TOTR_HAVE_UNIX_SOCKETS
+// SIGINT / SIGTERM end --serve; the handler only flips the running server's stop flag
+void (*stop_server)() = nullptr;
+
+extern "C" void on_stop_signal(int) {
+    if (stop_server) stop_server();
+}
+
+template <std::endian Order>
+int serve(const std::string& socket_path, std::vector<td::ServerImage> images, td::SymbolTable symbols,
+    const std::unordered_map<std::uint32_t, td::ArmMode>& overrides, const td::ServerOptions& options) {
+    static td::DisassemblyServer<Order>* running = nullptr;
+    td::DisassemblyServer<Order> server{ std::move(images), std::move(symbols), overrides, options };
+
+    running = &server;
+    stop_server = [] { running->stop(); };
+    std::signal(SIGINT, on_stop_signal);
+    std::signal(SIGTERM, on_stop_signal);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    int result = 0;
+    try {
+        std::cerr << "Listening on " << socket_path << "\n";
+        server.serve(socket_path);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << '\n';
+        result = 3;
+    }
+
+    // `server` is about to go; a late signal must not reach it
+    std::signal(SIGINT, SIG_DFL);
+    std::signal(SIGTERM, SIG_DFL);
+    stop_server = nullptr;
+    running = nullptr;
+    return result;
+}
+#endif
+
 void usage(const char* exe) {
     std::cout
-        << "Usage: " << exe << " <rom file> [options]\n\n"
+        << "Usage: " << exe << " <rom file> [options]\n"
+        << "       " << exe << " --diff <old rom> <new rom> [options]\n"
+        << "       " << exe << " --search <signature file> <rom>... [options]\n"
+        << "       " << exe << " --serve <socket path> <rom>... [options]\n\n"
         << "Options:\n"
-        << "  -r, --override <file>  Path to mode-override table\n"
+        << "  -r, --override <file>  Path to mode-override table (`<address> ARM|THUMB|DATA` lines)\n"
         << "  -o, --out <file>       Write disassembly to <file> instead of stdout\n"
         << "  -d, --dec              Print immediates in decimal (default: hex)\n"
+        << "  -s, --symbols <file>   Label and annotate output from an `address name` symbol file\n"
+        << "  -t, --trace <file>     Seed modes from an emulator trace and mark executed instructions\n"
+        << "  -b, --base <addr>      Address the ROM is mapped at (default: 0, GBA: 0x08000000)\n"
+        << "      --big-endian       Treat the image as big-endian (default: little-endian)\n"
+        << "      --no-track         Resolve BX mode switches with the validity probe only\n"
+        << "      --shards <n>       Split the listing into <n> files written in parallel; -o names the index\n"
+        << "      --asm              Emit GNU as source instead of the listing\n"
+        << "      --stats            Print per-phase timings and decode counters to stderr\n"
+        << "      --stats-json <file> Write the same statistics as JSON to <file>\n"
         << "\nExamples:\n"
         << "  " << exe << " demos/example/example.rom\n"
         << "  " << exe << " demos/example/example.rom --dec\n"
-        << "  " << exe << " demos/example/example.rom -r demos/example/overrides.txt -o demos/example/dump.txt\n";
+        << "  " << exe << " demos/example/example.rom -r demos/example/overrides.txt -o demos/example/dump.txt\n"
+        << "  " << exe << " --diff old.gba patched.gba -b 0x08000000\n"
+        << "  " << exe << " --search signatures.txt roms/*.gba -b 0x08000000\n"
+        << "  " << exe << " --serve /tmp/disasm.sock game.gba -b 0x08000000\n";
 }
 
 int main(int argc, char* argv[]) {
@@ -57,10 +414,43 @@ int main(int argc, char* argv[]) {
 
     bool print_literals_hex = true;
     std::filesystem::path rom_path = argv[1];
+    std::optional<std::filesystem::path> diff_path;
+    std::optional<std::filesystem::path> signatures_path;
+    std::vector<std::filesystem::path> search_paths;
+    std::optional<std::string> socket_path;
     std::optional<std::filesystem::path> out_path;
     std::optional<std::filesystem::path> override_path;
+    std::optional<std::filesystem::path> symbols_path;
+    std::optional<std::filesystem::path> trace_path;
+    std::uint32_t base_address = 0;
+    bool big_endian = false;
+    bool print_stats = false;
+    bool track_registers = true;
+    bool gnu_as = false;
+    unsigned shards = 1;
+    std::optional<std::filesystem::path> stats_json_path;
 
-    for (int i = 2; i < argc; ++i) {
+    int first_option = 2;
+    if (std::string_view(argv[1]) == "--diff") {
+        if (argc < 4) { usage(argv[0]); return 1; }
+        rom_path = argv[2];
+        diff_path = argv[3];
+        first_option = 4;
+    }
+    else if (std::string_view(argv[1]) == "--search") {
+        if (argc < 4) { usage(argv[0]); return 1; }
+        signatures_path = argv[2];
+        for (first_option = 3; first_option < argc && argv[first_option][0] != '-'; ++first_option) search_paths.push_back(argv[first_option]);
+        if (search_paths.empty()) { usage(argv[0]); return 1; }
+    }
+    else if (std::string_view(argv[1]) == "--serve") {
+        if (argc < 4) { usage(argv[0]); return 1; }
+        socket_path = argv[2];
+        for (first_option = 3; first_option < argc && argv[first_option][0] != '-'; ++first_option) search_paths.push_back(argv[first_option]);
+        if (search_paths.empty()) { usage(argv[0]); return 1; }
+    }
+
+    for (int i = first_option; i < argc; ++i) {
         std::string_view arg = argv[i];
 
         if (arg == "-d" || arg == "--dec") {
@@ -74,12 +464,64 @@ int main(int argc, char* argv[]) {
             if (++i == argc) { usage(argv[0]); return 1; }
             override_path = argv[i];
         }
+        else if (arg == "-s" || arg == "--symbols") {
+            if (++i == argc) { usage(argv[0]); return 1; }
+            symbols_path = argv[i];
+        }
+        else if (arg == "-t" || arg == "--trace") {
+            if (++i == argc) { usage(argv[0]); return 1; }
+            trace_path = argv[i];
+        }
+        else if (arg == "-b" || arg == "--base") {
+            if (++i == argc) { usage(argv[0]); return 1; }
+            try {
+                base_address = static_cast<std::uint32_t>(std::stoul(argv[i], nullptr, 0));
+            }
+            catch (const std::exception&) {
+                std::cerr << "Invalid base address: " << argv[i] << '\n';
+                usage(argv[0]); return 1;
+            }
+        }
+        else if (arg == "--big-endian") {
+            big_endian = true;
+        }
+        else if (arg == "--no-track") {
+            track_registers = false;
+        }
+        else if (arg == "--shards") {
+            if (++i == argc) { usage(argv[0]); return 1; }
+            try {
+                shards = static_cast<unsigned>(std::stoul(argv[i], nullptr, 0));
+            }
+            catch (const std::exception&) {
+                shards = 0;
+            }
+            if (shards == 0 || shards > 1000) {
+                std::cerr << "Invalid shard count: " << argv[i] << '\n';
+                usage(argv[0]); return 1;
+            }
+        }
+        else if (arg == "--asm") {
+            gnu_as = true;
+        }
+        else if (arg == "--stats") {
+            print_stats = true;
+        }
+        else if (arg == "--stats-json") {
+            if (++i == argc) { usage(argv[0]); return 1; }
+            stats_json_path = argv[i];
+        }
         else {
             std::cerr << "Unknown option: " << arg << '\n';
             usage(argv[0]); return 1;
         }
     }
 
+    if (shards > 1 && (!out_path || gnu_as || diff_path || signatures_path || socket_path)) {
+        std::cerr << "--shards needs -o and works with the plain listing only\n";
+        usage(argv[0]); return 1;
+    }
+
     std::ofstream outfile;
     std::ostream* out = &std::cout;
     if (out_path) {
@@ -93,10 +535,85 @@ int main(int argc, char* argv[]) {
     }
 
     std::vector<std::uint8_t> opcodes;
+    std::vector<std::uint8_t> new_opcodes;
     std::unordered_map<std::uint32_t, td::ArmMode> mode_override_table;
+    std::vector<td::DataRegion> data_regions;
+    td::SymbolTable symbols;
+    std::optional<td::ExecutionTrace> trace;
+    if ((print_stats || stats_json_path) && !td::stats_enabled()) {
+        std::cerr << "Warning: statistics were not compiled in; reconfigure with -DTOTR_ENABLE_STATS=ON.\n";
+    }
+
+    if (signatures_path) {
+        std::optional<td::SignatureMatcher> matcher;
+        try {
+            matcher.emplace(td::load_signatures(signatures_path->string()));
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << '\n';
+            return 3;
+        }
+
+        // An archive scan reports unreadable images and carries on with the rest
+        int status = 0;
+        for (const std::filesystem::path& path : search_paths) {
+            try {
+                TOTR_STATS_SCOPE(LoadRom);
+                opcodes = td::load_rom(path.string());
+            }
+            catch (const std::exception& e) {
+                std::cerr << "Error: " << path.string() << ": " << e.what() << '\n';
+                status = 3;
+                continue;
+            }
+
+            std::span<const uint8_t> rom{ opcodes };
+            if (big_endian) print_hits(*out, path.string(), td::BigEndianReader{ rom }, *matcher, base_address);
+            else print_hits(*out, path.string(), td::LittleEndianReader{ rom }, *matcher, base_address);
+        }
+        return status;
+    }
+
+    if (socket_path) {
+#ifdef TOTR_HAVE_UNIX_SOCKETS
+        std::vector<td::ServerImage> images;
+        try {
+            for (const std::filesystem::path& path : search_paths) images.push_back({ path.string(), td::load_rom(path.string()) });
+            if (override_path) mode_override_table = td::load_overrides(override_path->string()).modes;
+            if (symbols_path) symbols = td::load_symbols(symbols_path->string());
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << '\n';
+            return 3;
+        }
+
+        const td::ServerOptions options{ base_address, print_literals_hex, track_registers };
+        if (big_endian) return serve<std::endian::big>(*socket_path, std::move(images), std::move(symbols), mode_override_table, options);
+        return serve<std::endian::little>(*socket_path, std::move(images), std::move(symbols), mode_override_table, options);
+#else
+        std::cerr << "Error: --serve needs Unix domain sockets, which this build does not have\n";
+        return 1;
+#endif
+    }
+
     try {
-        opcodes = td::load_rom(rom_path.string());
-        if (override_path) mode_override_table = td::load_overrides(override_path->string());
+        {
+            TOTR_STATS_SCOPE(LoadRom);
+            opcodes = td::load_rom(rom_path.string());
+            if (diff_path) new_opcodes = td::load_rom(diff_path->string());
+        }
+        if (override_path) {
+            TOTR_STATS_SCOPE(LoadOverrides);
+            td::OverrideFile overrides = td::load_overrides(override_path->string());
+            mode_override_table = std::move(overrides.modes);
+            data_regions = std::move(overrides.data_regions);
+        }
+        if (symbols_path) symbols = td::load_symbols(symbols_path->string());
+        if (trace_path) {
+            trace = td::load_trace(trace_path->string());
+            // The trace's modes are facts, but an explicit override still wins
+            mode_override_table.merge(trace->mode_overrides());
+        }
     }
     catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << '\n';
@@ -104,64 +621,38 @@ int main(int argc, char* argv[]) {
     }
 
     // Main loop
-    std::span<const uint8_t> rom{ opcodes };
     td::ArmDisasm d_arm{ print_literals_hex };
     td::ThumbDisasm d_thumb{ print_literals_hex };
+    ListingContext context{ *out, d_arm, d_thumb, mode_override_table, data_regions, symbols, base_address, track_registers, gnu_as, trace ? &*trace : nullptr, shards > 1 ? &*out_path : nullptr, shards };
 
-    std::uint32_t pc = 0;
-    td::ArmMode mode = td::ArmMode::ARM;
-    bool did_mode_override = false;
-    bool mode_switched = false;
-    bool ambiguous = false;
-
-    std::uint32_t instr = 0;
-    td::InstructionData data;
-
-    *out << "    Addr    :    Instr    : Mnemonic\n";
-    *out << "--------------------------------------\n";
-    
-    while (pc < rom.size()) {
-        ambiguous = false;
-        mode_switched = false;
-        did_mode_override = false;
-
-        instr = td::read_word32_at(rom, pc);
-
-        if (mode == td::ArmMode::ARM) data = d_arm.decode(pc, instr);
-        else data = d_thumb.decode(pc, instr);
-
-        pc += data.size;
+    std::span<const uint8_t> rom{ opcodes };
+    if (diff_path) {
+        *out << "--- " << rom_path.string() << "\n+++ " << diff_path->string() << "\n";
 
-        if (data.mode_event == td::ModeEvent::BX) {
-            ambiguous = true;
-
-            td::ModeGuess guess = probe_mode(rom, pc, d_arm, d_thumb);
-
-            switch (guess) {
-                case td::ModeGuess::ARM:
-                    mode = td::ArmMode::ARM;
-                    mode_switched = true;
-                    ambiguous = false;
-                    break;
-                case td::ModeGuess::THUMB:
-                    mode = td::ArmMode::THUMB;
-                    mode_switched = true;
-                    ambiguous = false;
-                    break;
-                default: break;
-            }
-        }
-        else if (data.mode_event == td::ModeEvent::ExceptionReturn) {
-            mode = td::ArmMode::ARM;
+        std::span<const uint8_t> new_rom{ new_opcodes };
+        if (big_endian) print_diff(td::BigEndianReader{ rom }, td::BigEndianReader{ new_rom }, context);
+        else print_diff(td::LittleEndianReader{ rom }, td::LittleEndianReader{ new_rom }, context);
+    }
+    else {
+        try {
+            if (big_endian) disassemble(td::BigEndianReader{ rom }, context);
+            else disassemble(td::LittleEndianReader{ rom }, context);
         }
-        
-        if (auto it = mode_override_table.find(pc); it != mode_override_table.end()) {
-            mode = it->second;
-            did_mode_override = true;
-            ambiguous = false;
+        catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << '\n';
+            return 2;
         }
+    }
 
-        print_instruction(*out, data, mode, ambiguous, mode_switched, did_mode_override);
+    const td::RunStats stats = td::collect_stats();
+    if (print_stats && td::stats_enabled()) td::write_stats_text(std::cerr, stats);
+    if (stats_json_path && td::stats_enabled()) {
+        std::ofstream json_file(*stats_json_path, std::ios::out | std::ios::trunc);
+        if (!json_file) {
+            std::cerr << "Cannot write to " << *stats_json_path << "\n";
+            return 2;
+        }
+        td::write_stats_json(json_file, stats);
     }
 
     return 0;